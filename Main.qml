@@ -23,7 +23,7 @@ Window {
         }
     }
 
-    visible: true
+    // 由 main.cpp 在配置好图形参数后 show()
     title: "仿shadertoy工具"
     color: "black"
 
@@ -38,9 +38,24 @@ Window {
     property var textureLabels: ["底噪(Ch1)", "背景(Ch2)", "其他(Ch3)"]
     property int currentTextureIndex: -1
 
-    function changeShaderList(row,index)
+    function changeShaderChannel(row, channel, type, index)
     {
-        shaderList[row].inputId=index
+        var old = shaderList[row].channels[channel]
+        shaderList[row].channels[channel] = { type: type, index: index,
+                                              filter: old ? old.filter : "linear",
+                                              wrap: old ? old.wrap : "clamp" }
+    }
+
+    function changeShaderSampler(row, channel, filter, wrap)
+    {
+        shaderList[row].channels[channel].filter = filter
+        shaderList[row].channels[channel].wrap = wrap
+    }
+
+    function changeShaderTarget(row, scale, format)
+    {
+        shaderList[row].scale = scale
+        shaderList[row].format = format
     }
 
     FileHelper
@@ -60,11 +75,19 @@ Window {
 
         width: parent.height
 
-        FrameAnimation {
-            id: anim
-            running: true
+        onShaderError: (passIndex, path, message) => {
+            console.log("❌ 编译失败 Pass", passIndex, path, "\n" + message)
+            compileStatus.text = "❌ Pass " + passIndex + ": " + path.split("/").pop()
         }
-        t: anim.elapsedTime
+        onShadersCompiled: (success) => {
+            if (success)
+                compileStatus.text = "✅ 编译完成 (缓存命中 " + shaderCacheHits + " / 未命中 " + shaderCacheMisses + ")"
+        }
+        onReplayFinished: (complete, summary) => {
+            console.log(complete ? "✅ 回放完成" : "⏹ 回放已停止", summary)
+        }
+
+        // t 由 Item 自己的时钟推进，出帧节奏见 renderMode
 
         MouseArea {
             anchors.fill: parent
@@ -165,6 +188,91 @@ Window {
                 palette.windowText: "white"
             }
 
+            RowLayout {
+                Layout.fillWidth: true
+                spacing: 6
+
+                ComboBox {
+                    id: renderModeBox
+                    Layout.fillWidth: true
+                    model: ["连续渲染", "限制帧率", "按需渲染"]
+                    currentIndex: renderer.renderMode
+                    onActivated: (i) => renderer.renderMode = i
+                }
+
+                SpinBox {
+                    enabled: renderer.renderMode === RhiPingPongItem.CappedFps
+                    from: 1
+                    to: 240
+                    value: renderer.maxFps
+                    onValueModified: renderer.maxFps = value
+                }
+            }
+
+            RowLayout {
+                Layout.fillWidth: true
+                spacing: 6
+
+                CheckBox {
+                    id: fixedStepBox
+                    text: "固定步长"
+                    checked: renderer.fixedStep
+                    onToggled: renderer.fixedStep = checked
+                    palette.windowText: "white"
+                }
+
+                SpinBox {
+                    enabled: renderer.fixedStep
+                    from: 1
+                    to: 1000
+                    value: renderer.stepRate
+                    onValueModified: renderer.stepRate = value
+                }
+            }
+
+            RowLayout {
+                Layout.fillWidth: true
+                spacing: 6
+
+                CheckBox {
+                    text: "累积采样"
+                    checked: renderer.accumulate
+                    onToggled: renderer.accumulate = checked
+                    palette.windowText: "white"
+                }
+
+                SpinBox {
+                    enabled: renderer.accumulate
+                    from: 0
+                    to: 65536
+                    stepSize: 256
+                    value: renderer.sampleBudget
+                    onValueModified: renderer.sampleBudget = value
+                }
+            }
+
+            Text {
+                visible: renderer.accumulate
+                text: (renderer.accumulationDone ? "✔ 已完成，" : "⏳ 累积中，") + renderer.sampleCount + " 个样本"
+                color: "white"
+                font.pixelSize: 12
+            }
+
+            Text {
+                visible: renderer.fixedStep && renderer.droppedSteps > 0
+                text: "⚠ 已丢弃 " + renderer.droppedSteps + " 步 (渲染跟不上步频)"
+                color: "white"
+                font.pixelSize: 12
+            }
+
+            Text {
+                visible: renderer.renderMode === RhiPingPongItem.OnDemand
+                text: renderer.throttled ? "⏸ 已隐藏，暂停渲染"
+                                         : (renderer.animated ? "▶ 画面随时间变化，逐帧渲染" : "⏸ 静态画面，仅在变化时重绘")
+                color: "white"
+                font.pixelSize: 12
+            }
+
             Button {
                 text: "➕ 添加shader文件"
                 Layout.fillWidth: true
@@ -180,9 +288,17 @@ Window {
                 Layout.fillWidth: true
 
 
-                onChangeInputId:(row,index)=>
+                onChangeChannel: (row, channel, type, index) =>
+                                {
+                                    windwo.changeShaderChannel(row, channel, type, index)
+                                }
+                onChangeTarget: (row, scale, format) =>
                                 {
-                                    windwo.changeShaderList(row,index)
+                                    windwo.changeShaderTarget(row, scale, format)
+                                }
+                onChangeSampler: (row, channel, filter, wrap) =>
+                                {
+                                    windwo.changeShaderSampler(row, channel, filter, wrap)
                                 }
 
                 onRemoveShader: (row)=>
@@ -218,19 +334,36 @@ Window {
                     console.log("Starting Pipeline Build...")
                     renderer.running=false
                     var paths = []
-                    var bindIds = []
+                    var channels = []
+                    var targets = []
                     for(var i = 0; i < shaderList.length; i++) {
                         paths.push(shaderList[i].path)
-                        bindIds.push(shaderList[i].inputId)
+                        channels.push(shaderList[i].channels)
+                        targets.push({ scale: shaderList[i].scale, format: shaderList[i].format })
                     }
                     console.log("Paths:", paths)
-                    console.log("Bindings:", bindIds)
+                    console.log("Channels:", JSON.stringify(channels))
                     renderer.getFile(paths)
-                    renderer.getArr(bindIds)
+                    renderer.getChannels(channels)
+                    renderer.getTargets(targets)
                     renderer.running=true
                 }
             }
 
+            Text {
+                id: compileStatus
+                Layout.fillWidth: true
+                color: "#AAAAAA"
+                font.pixelSize: 12
+                elide: Text.ElideMiddle
+                text: ""
+            }
+            BusyIndicator {
+                running: renderer.compiling
+                visible: running
+                Layout.alignment: Qt.AlignHCenter
+            }
+
             Rectangle { Layout.fillWidth: true; height: 1; color: "gray" }
             Text {
                 Layout.fillWidth: true
@@ -268,6 +401,71 @@ Window {
                 text: "Time: " + renderer.t.toFixed(2)
                 color: "white"
             }
+
+            // 每个 Pass 的耗时 (ms)
+            Repeater {
+                model: renderer.passTimings
+                delegate: Text {
+                    Layout.fillWidth: true
+                    color: kind === "gpu" ? "#DCDCAA" : "#AAAAAA"
+                    font.pixelSize: 11
+                    elide: Text.ElideMiddle
+                    text: name + "  avg " + avgMs.toFixed(3) + "  p95 " + p95Ms.toFixed(3) + "  max " + maxMs.toFixed(3)
+                }
+            }
+            Button {
+                text: "导出耗时 CSV"
+                Layout.fillWidth: true
+                onClicked: timingCsvDialog.open()
+            }
+
+            RowLayout {
+                Layout.fillWidth: true
+                spacing: 6
+
+                Button {
+                    text: renderer.recording ? "⏹ 停止录制" : "⏺ 录制输入"
+                    Layout.fillWidth: true
+                    enabled: !renderer.replaying
+                    onClicked: renderer.recording ? renderer.stopRecording() : recordDialog.open()
+                }
+                Button {
+                    text: renderer.replaying ? "⏹ 停止回放" : "▶ 回放录制"
+                    Layout.fillWidth: true
+                    onClicked: renderer.replaying ? renderer.stopReplay() : replayDialog.open()
+                }
+            }
+        }
+    }
+
+    FileDialog {
+        id: timingCsvDialog
+        title: "Save Pass Timings"
+        nameFilters: ["CSV (*.csv)"]
+        fileMode: FileDialog.SaveFile
+        onAccepted: {
+            var ok = renderer.dumpTimingsCsv(selectedFile.toString())
+            console.log(ok ? "✅ 耗时已导出" : "❌ 导出失败")
+        }
+    }
+
+    FileDialog {
+        id: recordDialog
+        title: "Record Input"
+        nameFilters: ["Input Recording (*.srec)"]
+        fileMode: FileDialog.SaveFile
+        onAccepted: renderer.startRecording(selectedFile.toString())
+    }
+
+    // 回放的逐帧耗时写到录制文件旁的 <名称>_replay.csv
+    FileDialog {
+        id: replayDialog
+        title: "Replay Input"
+        nameFilters: ["Input Recording (*.srec)"]
+        fileMode: FileDialog.OpenFile
+        onAccepted: {
+            var path = selectedFile.toString()
+            renderer.startReplay(path, path.replace(/\.srec$/, "") + "_replay.csv")
         }
     }
 
@@ -284,9 +482,17 @@ Window {
                 path = path.slice(7)
             }
             var temp = shaderList
+            // 默认: ch0 读上一个 Pass 本帧的输出，ch1-3 为三张纹理 (纹理按 Mipmap + 重复采样，同 Shadertoy)
+            var ch0 = temp.length > 0 ? { type: "pass", index: temp.length - 1, filter: "linear", wrap: "clamp" }
+                                      : { type: "texture", index: 0, filter: "mipmap", wrap: "repeat" }
             temp.push({
                           path: path,
-                          inputId: (temp.length > 0 ? temp.length - 1 : 0)
+                          scale: 1.0,
+                          format: "rgba16f",
+                          channels: [ch0,
+                                     { type: "texture", index: 0, filter: "mipmap", wrap: "repeat" },
+                                     { type: "texture", index: 1, filter: "mipmap", wrap: "repeat" },
+                                     { type: "texture", index: 2, filter: "mipmap", wrap: "repeat" }]
                       })
             shaderList = temp
         }
@@ -295,7 +501,7 @@ Window {
     FileDialog {
         id: textureFileDialog
         title: "Select Texture Image"
-        nameFilters: ["Images (*.png *.jpg *.jpeg *.bmp)", "All files (*)"]
+        nameFilters: ["Images (*.png *.jpg *.jpeg *.bmp *.ktx *.ktx2 *.dds)", "All files (*)"]
         fileMode: FileDialog.OpenFile
         onAccepted: {
             var path = selectedFile.toString()
@@ -0,0 +1,344 @@
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QTemporaryDir>
+#include <QTextDocument>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+#include "HeadlessRunner.h"
+#include "HighlighterShader.h"
+#include "ImageCache.h"
+
+// ================================================================
+// rendererBench: 渲染器 CPU 热点与 Pass 链规模的基准测试
+// 默认使用 QRhi Null 后端，只统计 CPU 开销；结果以 JSON 输出，便于跨版本对比
+// ================================================================
+
+static const char *kPassShader = R"(#version 440
+layout(location = 0) in vec2 v_texCoord;
+layout(location = 0) out vec4 fragColor;
+layout(std140, binding = 0) uniform UniformBlock {
+    vec2 iResolution;
+    float iTime;
+    float iTimeDelta;
+    vec4 iMouse;
+    vec4 iDate;
+    float iSampleRate;
+    int iFrame;
+    vec2 padding0;
+    vec4 iChannelResolution[4];
+};
+layout(binding = 1) uniform sampler2D iChannel0;
+layout(binding = 2) uniform sampler2D iChannel1;
+layout(binding = 3) uniform sampler2D iChannel2;
+layout(binding = 4) uniform sampler2D iChannel3;
+
+void main() {
+    vec2 uv = gl_FragCoord.xy / iResolution;
+    vec4 prev = texture(iChannel0, v_texCoord);
+    vec4 noise = texture(iChannel1, uv);
+    fragColor = mix(prev, noise, 0.5 + 0.5 * sin(iTime + float(iFrame)));
+}
+)";
+
+// 不读时间的预计算 Pass (噪声 / LUT 一类)，输入不变时跨帧复用输出
+static const char *kStaticPassShader = R"(#version 440
+layout(location = 0) in vec2 v_texCoord;
+layout(location = 0) out vec4 fragColor;
+layout(std140, binding = 0) uniform UniformBlock {
+    vec2 iResolution;
+    float iTime;
+    float iTimeDelta;
+    vec4 iMouse;
+    vec4 iDate;
+    float iSampleRate;
+    int iFrame;
+    vec2 padding0;
+    vec4 iChannelResolution[4];
+};
+layout(binding = 1) uniform sampler2D iChannel0;
+layout(binding = 2) uniform sampler2D iChannel1;
+layout(binding = 3) uniform sampler2D iChannel2;
+layout(binding = 4) uniform sampler2D iChannel3;
+
+void main() {
+    vec2 uv = gl_FragCoord.xy / iResolution;
+    vec4 prev = texture(iChannel0, v_texCoord);
+    vec4 noise = texture(iChannel1, uv * 4.0);
+    fragColor = mix(prev, noise, 0.5);
+}
+)";
+
+struct Result {
+    QString name;
+    int passes = 0;
+    int resolution = 0;
+    int iterations = 0;
+    qint64 medianNs = 0;
+    qint64 minNs = 0;
+    qint64 targetBytes = -1;   // 离屏渲染目标显存 (仅重建类测试)
+};
+
+// 计时期间屏蔽渲染器的 qDebug/qInfo ([Init]、[Shared]、[ShaderCache] ...)，控制台 I/O 不计入结果；
+// 警告与错误仍交给原来的处理器
+static QtMessageHandler s_previousHandler = nullptr;
+
+static void quietMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    if (type == QtDebugMsg || type == QtInfoMsg) return;
+    if (s_previousHandler) s_previousHandler(type, context, message);
+}
+
+struct QuietLogging {
+    QuietLogging() { s_previousHandler = qInstallMessageHandler(quietMessageHandler); }
+    ~QuietLogging() { qInstallMessageHandler(s_previousHandler); }
+};
+
+// 运行 iterations 次，返回中位数与最小值
+static Result measure(const QString &name, int iterations, const std::function<void()> &fn)
+{
+    QuietLogging quiet;
+    std::vector<qint64> samples;
+    samples.reserve(iterations);
+    QElapsedTimer timer;
+    for (int i = 0; i < iterations; ++i) {
+        timer.start();
+        fn();
+        samples.push_back(timer.nsecsElapsed());
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result r;
+    r.name = name;
+    r.iterations = iterations;
+    r.medianNs = samples[samples.size() / 2];
+    r.minNs = samples.front();
+    return r;
+}
+
+static QJsonObject toJson(const Result &r)
+{
+    QJsonObject o;
+    o["name"] = r.name;
+    o["passes"] = r.passes;
+    o["resolution"] = r.resolution;
+    o["iterations"] = r.iterations;
+    o["median_ns"] = double(r.medianNs);
+    o["min_ns"] = double(r.minNs);
+    if (r.targetBytes >= 0) o["target_bytes"] = double(r.targetBytes);
+    return o;
+}
+
+static bool writeFile(const QString &path, const QByteArray &data)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) return false;
+    return f.write(data) == data.size();
+}
+
+// 在一个离屏帧内执行 fn (createPipelines 等需要当前帧的命令缓冲)
+static void inFrame(HeadlessRunner &runner, const std::function<void(const FrameContext &)> &fn)
+{
+    QRhiCommandBuffer *cb = nullptr;
+    if (runner.rhi()->beginOffscreenFrame(&cb) != QRhi::FrameOpSuccess) return;
+    FrameContext ctx;
+    ctx.rhi = runner.rhi();
+    ctx.cb = cb;
+    ctx.screenRpDesc = runner.screenRenderPassDescriptor();
+    fn(ctx);
+    runner.rhi()->endOffscreenFrame();
+}
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("rendererBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark the renderer CPU hot paths.");
+    parser.addHelpOption();
+    QCommandLineOption backendOpt("backend", "QRhi backend: null or gl.", "name", "null");
+    QCommandLineOption framesOpt("frames", "Frames per steady-state measurement.", "count", "60");
+    QCommandLineOption outputOpt("output", "Write JSON results to this file instead of stdout.", "file");
+    QCommandLineOption quickOpt("quick", "Only sweep up to 16 passes and 2048 pixels.");
+    parser.addOptions({ backendOpt, framesOpt, outputOpt, quickOpt });
+    parser.process(app);
+
+    const QString backend = parser.value(backendOpt);
+    const int frames = std::max(1, parser.value(framesOpt).toInt());
+
+    // 1. 准备测试资源: Pass Shader 与一张 2048² 的底图
+    QTemporaryDir tmp;
+    const QString shaderPath = tmp.filePath("pass.frag");
+    writeFile(shaderPath, kPassShader);
+    const QString staticShaderPath = tmp.filePath("static.frag");
+    writeFile(staticShaderPath, kStaticPassShader);
+
+    const QString texPath = tmp.filePath("tex.png");
+    {
+        QImage img(2048, 2048, QImage::Format_RGBA8888);
+        QPainter p(&img);
+        QLinearGradient g(0, 0, 2048, 2048);
+        g.setColorAt(0, Qt::red);
+        g.setColorAt(1, Qt::blue);
+        p.fillRect(img.rect(), g);
+        p.end();
+        img.save(texPath);
+    }
+    const QStringList textures = { texPath, texPath, texPath };
+
+    QJsonArray results;
+    auto add = [&results](Result r, int passes, int resolution) {
+        r.passes = passes;
+        r.resolution = resolution;
+        results.append(toJson(r));
+    };
+
+    // 2. 单项热点 (8 Pass, 1024²)
+    {
+        HeadlessRunner runner;
+        if (!runner.create(backend)) return 2;
+        const QSize size(1024, 1024);
+        runner.setOutputSize(size);
+        QStringList shaders;
+        for (int i = 0; i < 8; ++i) shaders << shaderPath;
+        if (!runner.loadProject(shaders, {}, textures)) return 3;
+        runner.renderFrame(RenderParams());
+
+        SquircleRenderer &r = runner.renderer();
+
+        // 完整重建: 先丢弃全部 Pass
+        add(measure("init", 20, [&]() {
+            r.releasePasses();
+            r.init(runner.rhi(), size);
+        }), 8, 1024);
+
+        add(measure("createPipelines", 20, [&]() {
+            inFrame(runner, [&](const FrameContext &ctx) {
+                r.releasePasses();
+                r.createPipelines(ctx);
+            });
+        }), 8, 1024);
+
+        add(measure("createPipelines+backgroundTextures", 10, [&]() {
+            inFrame(runner, [&](const FrameContext &ctx) {
+                r.releasePasses();
+                r.picIsReset = true;
+                ImageCache::instance().clear();   // 测量的是解码 + 填充 + 上传
+                r.createPipelines(ctx);
+            });
+        }), 8, 1024);
+
+        // 增量重建: 配置未变时只做对比
+        add(measure("createPipelines(incremental)", 20, [&]() {
+            inFrame(runner, [&](const FrameContext &ctx) {
+                r.isReset = true;
+                r.createPipelines(ctx);
+            });
+        }), 8, 1024);
+
+        RenderParams params;
+        add(measure("updateUniformLogic", 10000, [&]() {
+            params.time += 0.016f;
+            params.frame++;
+            r.setParams(params);
+            r.updateUniformLogic();
+        }), 8, 1024);
+    }
+
+    // 2b. 静态预计算链: 前 7 个 Pass 不读时间，只有上屏 Pass 随时间变化 (稳定后每帧只渲染上屏 Pass)
+    {
+        HeadlessRunner runner;
+        if (!runner.create(backend)) return 2;
+        runner.setOutputSize(QSize(1024, 1024));
+        QStringList shaders;
+        for (int i = 0; i < 7; ++i) shaders << staticShaderPath;
+        shaders << shaderPath;
+        if (!runner.loadProject(shaders, {}, textures)) return 3;
+        runner.renderFrame(RenderParams());
+
+        RenderParams params;
+        Result r = measure("frame(static-precompute)", frames, [&]() {
+            params.time += 1.0f / 60.0f;
+            params.frame++;
+            runner.renderFrame(params);
+        });
+        r.passes = 8;
+        r.resolution = 1024;
+        QJsonObject o = toJson(r);
+        o["skipped_passes"] = runner.renderer().skippedPassCount();
+        results.append(o);
+    }
+
+    // 3. HighlighterShader::highlightBlock (通过 rehighlight 驱动，约 5000 行 GLSL)
+    {
+        QString text;
+        for (int i = 0; i < 200; ++i) text += QString::fromLatin1(kPassShader);
+        QTextDocument doc;
+        doc.setPlainText(text);
+        HighlighterShader highlighter(&doc);
+        Result r = measure("highlightBlock(document)", 10, [&]() { highlighter.rehighlight(); });
+        QJsonObject o = toJson(r);
+        o["blocks"] = doc.blockCount();
+        o["ns_per_block"] = double(r.medianNs) / std::max(1, doc.blockCount());
+        results.append(o);
+    }
+
+    // 4. Pass 链长度 × 分辨率扫描: 每帧 CPU 开销与重建延迟
+    const std::vector<int> passCounts = parser.isSet(quickOpt)
+        ? std::vector<int>{ 1, 2, 4, 8, 16 }
+        : std::vector<int>{ 1, 2, 4, 8, 16, 32, 64 };
+    const std::vector<int> resolutions = parser.isSet(quickOpt)
+        ? std::vector<int>{ 512, 1024, 2048 }
+        : std::vector<int>{ 512, 1024, 2048, 4096 };
+
+    for (int passes : passCounts) {
+        HeadlessRunner runner;
+        if (!runner.create(backend)) return 2;
+        QStringList shaders;
+        for (int i = 0; i < passes; ++i) shaders << shaderPath;
+
+        for (int res : resolutions) {
+            runner.setOutputSize(QSize(res, res));
+            if (!runner.loadProject(shaders, {}, textures)) return 3;
+
+            Result rebuild = measure("rebuild", 5, [&]() {
+                runner.renderer().releasePasses();
+                runner.renderFrame(RenderParams());
+            });
+            rebuild.targetBytes = runner.renderer().m_targetPool.totalBytes();
+            add(rebuild, passes, res);
+
+            RenderParams params;
+            add(measure("frame", frames, [&]() {
+                params.time += 1.0f / 60.0f;
+                params.frame++;
+                runner.renderFrame(params);
+            }), passes, res);
+        }
+    }
+
+    QJsonObject root;
+    root["benchmark"] = "rendererBench";
+    root["qt"] = QString::fromLatin1(qVersion());
+    root["backend"] = backend;
+    root["results"] = results;
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outputOpt)) {
+        if (!writeFile(parser.value(outputOpt), json)) return 4;
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
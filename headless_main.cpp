@@ -0,0 +1,328 @@
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include "FrameExporter.h"
+#include "HeadlessRunner.h"
+#include "InputRecording.h"
+#include "TiledRenderer.h"
+
+// ================================================================
+// shaderToyHeadless: 无显示环境下渲染多 Pass 工程
+// 例: shaderToyHeadless --backend gl --size 1920x1080 --frames 120 --out frames/ a.frag b.frag main.frag
+// 海报: shaderToyHeadless --poster 16384x16384 --tile 2048 --poster-out poster.pam main.frag
+// 导出: shaderToyHeadless --size 3840x2160 --frames 3600 --export - --format y4m main.frag | ffmpeg -i - out.mp4
+// 回放: shaderToyHeadless --replay session.srec --timings replay.csv
+// 无显示服务器时默认使用 offscreen 平台插件；软件 GL 可配合 LIBGL_ALWAYS_SOFTWARE=1
+// ================================================================
+
+static QSize parseSize(const QString &text)
+{
+    const QStringList parts = text.toLower().split('x');
+    if (parts.size() != 2) return QSize();
+    return QSize(parts[0].toInt(), parts[1].toInt());
+}
+
+// "0.5:rgba8" / "256x256:r16f" / "1"
+static bool parseTarget(const QString &text, PassTarget *target)
+{
+    const QStringList parts = text.trimmed().split(':');
+    const QString sizePart = parts.value(0);
+    if (sizePart.contains('x', Qt::CaseInsensitive)) {
+        target->fixedSize = parseSize(sizePart);
+        if (target->fixedSize.isEmpty()) return false;
+    } else {
+        bool ok = false;
+        target->scale = sizePart.toFloat(&ok);
+        if (!ok || target->scale <= 0.0f) return false;
+    }
+    return parts.size() < 2 || PassTarget::parseFormat(parts[1], &target->format);
+}
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("shaderToyHeadless");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Render a multi-pass shader project without a window.");
+    parser.addHelpOption();
+    QCommandLineOption backendOpt("backend", "QRhi backend: null or gl.", "name", "gl");
+    QCommandLineOption sizeOpt("size", "Output resolution, e.g. 1920x1080.", "WxH", "1280x720");
+    QCommandLineOption framesOpt("frames", "Number of frames to render.", "count", "60");
+    QCommandLineOption fpsOpt("fps", "Simulated frame rate (iTime = frame / fps).", "fps", "60");
+    QCommandLineOption stepsOpt("steps", "Fixed simulation steps per output frame (step rate = fps x steps).", "count", "1");
+    QCommandLineOption accumulateOpt("accumulate", "Accumulate samples of one still frame until converged or --samples/--frames is reached, then write the result.");
+    QCommandLineOption samplesOpt("samples", "Sample budget for --accumulate (0: unlimited).", "count", "1024");
+    QCommandLineOption convergeOpt("converge", "Stop --accumulate when the mean change per sample drops below this value (0: off).", "delta", "0.00001");
+    QCommandLineOption bindOpt("bind", "Comma separated input pass per pass (default: previous pass).", "list");
+    QCommandLineOption texOpt("textures", "Comma separated iChannel1-3 images.", "list");
+    QCommandLineOption targetsOpt("targets", "Comma separated per-pass target, scale or WxH with optional :format (rgba8, r16f, rg16f, rgba16f, rgba32f), e.g. 0.5:rgba8,1.", "list");
+    QCommandLineOption outOpt("out", "Directory to write PNG frames into.", "dir");
+    QCommandLineOption exportOpt("export", "Export frames with asynchronous readback: a directory for png, a file or - (stdout) for y4m/rgba.", "path");
+    QCommandLineOption formatOpt("format", "Export format: png, y4m or rgba.", "name", "png");
+    QCommandLineOption queueOpt("queue", "Maximum frames read back but not yet written (bounds export memory).", "count", "6");
+    QCommandLineOption posterOpt("poster", "Render one frame as a tiled image of this size, e.g. 16384x16384.", "WxH");
+    QCommandLineOption tileOpt("tile", "Tile edge length for --poster.", "pixels", "2048");
+    QCommandLineOption posterOutOpt("poster-out", "Output for --poster: a .pam file or a directory of PNG tiles.", "path", "poster.pam");
+    QCommandLineOption replayOpt("replay", "Replay an input recording (.srec) frame by frame; shaders, sizes and parameters come from the recording.", "file");
+    QCommandLineOption timingsOpt("timings", "Write per-frame recorded and replayed timings of --replay to this CSV file.", "file");
+    parser.addOptions({ backendOpt, sizeOpt, framesOpt, fpsOpt, stepsOpt, accumulateOpt, samplesOpt, convergeOpt, bindOpt, texOpt, targetsOpt, outOpt,
+                        exportOpt, formatOpt, queueOpt, posterOpt, tileOpt, posterOutOpt, replayOpt, timingsOpt });
+    parser.addPositionalArgument("shaders", "Fragment shaders in pass order, the last one is the screen pass.", "<shader>...");
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList shaders = parser.positionalArguments();
+    const QSize size = parseSize(parser.value(sizeOpt));
+    const int frames = parser.value(framesOpt).toInt();
+    const double fps = parser.value(fpsOpt).toDouble();
+    const int steps = parser.value(stepsOpt).toInt();
+    if ((shaders.isEmpty() && !parser.isSet(replayOpt)) || size.isEmpty() || frames <= 0 || fps <= 0.0 || steps <= 0) {
+        parser.showHelp(1);
+    }
+
+    // 第 f 帧执行第 f*steps .. f*steps+steps-1 步: iFrame 为步序号，iTime = 步序号 / 步频，
+    // 与交互模式的固定步长一致，相同参数的输出逐位可复现
+    const double stepRate = fps * steps;
+    auto frameParams = [&](int f) {
+        RenderParams params;
+        params.frame = f * steps;
+        params.time = float(params.frame / stepRate);
+        params.timeDelta = float(1.0 / stepRate);
+        params.simulationSteps = steps;
+        params.screenSize = size;
+        return params;
+    };
+
+    std::vector<int> binds;
+    if (parser.isSet(bindOpt)) {
+        for (const QString &v : parser.value(bindOpt).split(',', Qt::SkipEmptyParts))
+            binds.push_back(v.trimmed().toInt());
+    }
+    QStringList textures;
+    if (parser.isSet(texOpt)) textures = parser.value(texOpt).split(',', Qt::SkipEmptyParts);
+
+    std::vector<PassTarget> targets;
+    if (parser.isSet(targetsOpt)) {
+        for (const QString &v : parser.value(targetsOpt).split(',', Qt::SkipEmptyParts)) {
+            PassTarget target;
+            if (!parseTarget(v, &target)) {
+                err << "Invalid target: " << v << "\n";
+                return 1;
+            }
+            targets.push_back(target);
+        }
+    }
+
+    QString outDir;
+    if (parser.isSet(outOpt)) {
+        outDir = parser.value(outOpt);
+        QDir().mkpath(outDir);
+    }
+
+    HeadlessRunner runner;
+    if (!runner.create(parser.value(backendOpt), QRhi::EnableTimestamps)) return 2;
+
+    // 回放模式: 配置、视口尺寸与每帧参数全部取自录制文件，逐帧读回计算校验和；
+    // 同一录制在不同构建上的 replay_render_readback_ms 可直接对比，校验和一致说明输出相同
+    if (parser.isSet(replayOpt)) {
+        InputReplayer replayer;
+        replayer.setReplayMetric(QStringLiteral("render_readback"));
+        QString error;
+        if (!replayer.open(parser.value(replayOpt), &error)) {
+            err << "Replay failed: " << error << "\n";
+            return 3;
+        }
+
+        QCryptographicHash checksum(QCryptographicHash::Sha256);
+        QElapsedTimer replayTimer;
+        replayTimer.start();
+        while (!replayer.atEnd()) {
+            const int f = replayer.position();
+            const PassConfigSnapshot *config = nullptr;
+            const RecordedFrame &recorded = replayer.next(&config);
+            if (config) runner.applyConfig(*config);
+            const QSize frameSize = recorded.frame.viewport.size().toSize();
+            if (frameSize != runner.outputSize() && !runner.setOutputSize(frameSize)) return 2;
+
+            QElapsedTimer frameTimer;
+            frameTimer.start();
+            QImage image;
+            if (!runner.renderFrame(recorded.frame.params, &image)) {
+                err << "Frame " << f << " failed\n";
+                return 4;
+            }
+            replayer.recordTiming(f, { frameTimer.nsecsElapsed() / 1e6, runner.renderer().m_timing.lastGpuFrameMs() });
+            checksum.addData(QByteArrayView(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes()));
+            if (!outDir.isEmpty())
+                image.save(QDir(outDir).filePath(QString("frame_%1.png").arg(f, 5, 10, QChar('0'))));
+        }
+        const double totalMs = replayTimer.nsecsElapsed() / 1e6;
+
+        if (parser.isSet(timingsOpt) && !replayer.dumpTimingsCsv(parser.value(timingsOpt))) {
+            err << "Cannot write timings to " << parser.value(timingsOpt) << "\n";
+            return 5;
+        }
+        out << "backend: " << runner.rhi()->backendName() << "\n"
+            << "replay: " << replayer.summary() << "\n"
+            << "total_ms: " << totalMs << "\n"
+            << "checksum: " << checksum.result().toHex() << "\n";
+        return 0;
+    }
+
+    if (!runner.setOutputSize(size)) return 2;
+    if (!runner.loadProject(shaders, binds, textures)) return 3;
+    runner.renderer().targetSpecs = targets;
+
+    // 海报模式: 第 0 帧按整幅尺寸分块渲染，逐块写出
+    if (parser.isSet(posterOpt)) {
+        TiledRenderSettings settings;
+        settings.imageSize = parseSize(parser.value(posterOpt));
+        settings.tileSize = parser.value(tileOpt).toInt();
+        settings.output = parser.value(posterOutOpt);
+        if (settings.imageSize.isEmpty()) parser.showHelp(1);
+
+        RenderParams params;
+        params.timeDelta = float(1.0 / fps);
+        params.screenSize = settings.imageSize;
+
+        TiledRenderer tiled(runner);
+        QString error;
+        if (!tiled.render(params, settings, &error)) {
+            err << "Poster failed: " << error << "\n";
+            return 4;
+        }
+        out << "backend: " << runner.rhi()->backendName() << "\n"
+            << "poster: " << settings.imageSize.width() << "x" << settings.imageSize.height()
+            << " in " << tiled.tileCount() << " tiles\n"
+            << "total_ms: " << tiled.elapsedMs() << "\n"
+            << "bytes_written: " << tiled.bytesWritten() << "\n";
+        return 0;
+    }
+
+    // 导出模式: 固定步长逐帧渲染，读回与编码交给 FrameExporter，GPU 不等待磁盘
+    if (parser.isSet(exportOpt)) {
+        ExportSettings settings;
+        settings.output = parser.value(exportOpt);
+        settings.size = size;
+        settings.fps = fps;
+        settings.maxQueuedFrames = parser.value(queueOpt).toInt();
+        if (!ExportSettings::parseFormat(parser.value(formatOpt), &settings.format)) {
+            err << "Unknown export format: " << parser.value(formatOpt) << "\n";
+            return 1;
+        }
+
+        FrameExporter exporter;
+        QString error;
+        if (!exporter.open(settings, &error)) {
+            err << "Export failed: " << error << "\n";
+            return 5;
+        }
+
+        QElapsedTimer exportTimer;
+        exportTimer.start();
+        for (int f = 0; f < frames; ++f) {
+            if (!runner.exportFrame(frameParams(f), exporter)) {
+                err << "Frame " << f << " failed\n";
+                exporter.finish();
+                return 4;
+            }
+        }
+        const double renderMs = exportTimer.nsecsElapsed() / 1e6;
+        const bool ok = exporter.finish();
+        const double totalMs = exportTimer.nsecsElapsed() / 1e6;
+
+        // 输出到标准输出时统计信息改写到标准错误
+        QTextStream &report = settings.output == "-" ? err : out;
+        report << "backend: " << runner.rhi()->backendName() << "\n"
+               << "frames: " << exporter.framesWritten() << "/" << frames << " @ " << size.width() << "x" << size.height() << "\n"
+               << "render_ms: " << renderMs << "\n"
+               << "total_ms: " << totalMs << "\n"
+               << "stall_ms: " << exporter.stallMs() << "\n"
+               << "peak_queued_frames: " << exporter.peakQueuedFrames() << "\n"
+               << "bytes_written: " << exporter.bytesWritten() << "\n";
+        return ok ? 0 : 4;
+    }
+
+    // 累积模式: iTime 固定为 0，iFrame 逐帧递增作为随机数种子；收敛或达到样本上限 (最多 --frames 帧)
+    // 后再渲染一帧读回最终画面 (此时只画累积结果，不再增加样本)
+    if (parser.isSet(accumulateOpt)) {
+        auto sampleParams = [&](int f) {
+            RenderParams params;
+            params.frame = f;
+            params.timeDelta = float(1.0 / fps);
+            params.screenSize = size;
+            params.accumulate = true;
+            params.sampleBudget = parser.value(samplesOpt).toInt();
+            params.convergenceThreshold = parser.value(convergeOpt).toFloat();
+            return params;
+        };
+
+        QElapsedTimer accumTimer;
+        accumTimer.start();
+        int f = 0;
+        for (; f < frames - 1 && !runner.renderer().accumulationFinished(); ++f) {
+            if (!runner.renderFrame(sampleParams(f))) {
+                err << "Frame " << f << " failed\n";
+                return 4;
+            }
+        }
+        QImage image;
+        if (!runner.renderFrame(sampleParams(f), &image)) {
+            err << "Frame " << f << " failed\n";
+            return 4;
+        }
+        const double totalMs = accumTimer.nsecsElapsed() / 1e6;
+        if (!outDir.isEmpty()) image.save(QDir(outDir).filePath("accumulated.png"));
+
+        const SquircleRenderer &renderer = runner.renderer();
+        out << "backend: " << runner.rhi()->backendName() << "\n"
+            << "frames: " << f + 1 << " @ " << size.width() << "x" << size.height() << "\n"
+            << "samples: " << renderer.accumulatedSamples() << "\n"
+            << "finished: " << (renderer.accumulationFinished() ? "yes" : "no") << "\n"
+            << "delta_per_sample: " << renderer.convergenceDelta() << "\n"
+            << "total_ms: " << totalMs << "\n"
+            << "checksum: " << QCryptographicHash::hash(QByteArrayView(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes()),
+                                                         QCryptographicHash::Sha256).toHex() << "\n";
+        return 0;
+    }
+
+    QCryptographicHash checksum(QCryptographicHash::Sha256);
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int f = 0; f < frames; ++f) {
+        QImage image;
+        if (!runner.renderFrame(frameParams(f), &image)) {
+            err << "Frame " << f << " failed\n";
+            return 4;
+        }
+        checksum.addData(QByteArrayView(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes()));
+        if (!outDir.isEmpty())
+            image.save(QDir(outDir).filePath(QString("frame_%1.png").arg(f, 5, 10, QChar('0'))));
+    }
+
+    const double totalMs = timer.nsecsElapsed() / 1e6;
+    out << "backend: " << runner.rhi()->backendName() << "\n"
+        << "frames: " << frames << " @ " << size.width() << "x" << size.height() << "\n"
+        << "steps_per_frame: " << steps << "\n"
+        << "total_ms: " << totalMs << "\n"
+        << "avg_frame_ms: " << totalMs / frames << "\n"
+        << "checksum: " << checksum.result().toHex() << "\n";
+
+    // 每个 Pass 的录制耗时 (离屏帧在 endOffscreenFrame 时等待 GPU，GPU 行为整帧时间)
+    for (const PassTimingRow &row : runner.renderer().m_timing.snapshot()) {
+        if (row.samples == 0) continue;
+        out << (row.passIndex < 0 ? QString("gpu_frame") : QString("pass%1_cpu").arg(row.passIndex))
+            << ": avg " << row.avgMs << " ms, p95 " << row.p95Ms << " ms, max " << row.maxMs << " ms\n";
+    }
+    return 0;
+}
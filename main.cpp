@@ -1,6 +1,8 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQuickWindow>
+#include <QQuickGraphicsConfiguration>
+#include "PipelineCacheStore.h"
 
 int main(int argc, char *argv[])
 {
@@ -12,6 +14,30 @@ int main(int argc, char *argv[])
     QObject::connect(&engine, &QQmlApplicationEngine::objectCreationFailed,
                      &app, []() { QCoreApplication::exit(-1); },
                      Qt::QueuedConnection);
+
+    // 管线缓存、时间戳: 必须在窗口第一次显示 (QRhi 创建) 之前配置
+    QObject::connect(&engine, &QQmlApplicationEngine::objectCreated,
+                     &app, [](QObject *obj, const QUrl &) {
+        auto *window = qobject_cast<QQuickWindow *>(obj);
+        if (!window) return;
+
+        QQuickGraphicsConfiguration config = window->graphicsConfiguration();
+        config.setAutomaticPipelineCache(false);
+        config.setPipelineCacheSaveFile(PipelineCacheStore::qtDumpFilePath());
+        // 打开 GPU 时间戳，供每帧 GPU 耗时统计使用
+        config.setTimestamps(true);
+        window->setGraphicsConfiguration(config);
+
+        // 渲染线程: QRhi 创建后、任何管线创建前加载；场景图销毁前保存
+        QObject::connect(window, &QQuickWindow::sceneGraphInitialized, window, [window]() {
+            PipelineCacheStore::instance().load(window->rhi());
+        }, Qt::DirectConnection);
+        QObject::connect(window, &QQuickWindow::sceneGraphInvalidated, window, [window]() {
+            PipelineCacheStore::instance().save(window->rhi());
+        }, Qt::DirectConnection);
+
+        window->show();
+    });
     engine.load(url);
 
     return app.exec();
@@ -0,0 +1,11 @@
+#version 440
+// 累积模式: 把累积纹理 (iChannel0) 原样画到上屏视口
+layout(location = 0) in vec2 v_texCoord;
+layout(location = 0) out vec4 fragColor;
+
+layout(binding = 1) uniform sampler2D iChannel0;
+
+void main() {
+    // common.vert 为 ShaderToy 坐标系翻转了 v；写入与读取同为纹理坐标，这里翻回来保持方向不变
+    fragColor = texture(iChannel0, vec2(v_texCoord.x, 1.0 - v_texCoord.y));
+}
@@ -0,0 +1,30 @@
+#version 440
+// 累积模式的收敛检测: 把累积纹理 (iChannel0) 缩减为 32x32 个块的平均值
+// 每块最多采 8x8 个点，只用于估计整体变化幅度，不需要精确
+layout(location = 0) in vec2 v_texCoord;
+layout(location = 0) out vec4 fragColor;
+
+layout(binding = 1) uniform sampler2D iChannel0;
+
+const int kGrid = 32;
+const int kSamples = 8;
+
+void main() {
+    ivec2 srcSize = textureSize(iChannel0, 0);
+    ivec2 block = max((srcSize + kGrid - 1) / kGrid, ivec2(1));
+    ivec2 origin = ivec2(gl_FragCoord.xy) * block;
+    ivec2 blockEnd = min(origin + block, srcSize);
+    ivec2 stride = max(block / kSamples, ivec2(1));
+
+    vec4 sum = vec4(0.0);
+    float count = 0.0;
+    for (int y = 0; y < kSamples; ++y) {
+        for (int x = 0; x < kSamples; ++x) {
+            ivec2 p = origin + ivec2(x, y) * stride;
+            if (p.x >= blockEnd.x || p.y >= blockEnd.y) continue;
+            sum += texelFetch(iChannel0, p, 0);
+            count += 1.0;
+        }
+    }
+    fragColor = count > 0.0 ? sum / count : vec4(0.0);
+}
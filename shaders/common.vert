@@ -1,10 +1,21 @@
 #version 440
 layout(location = 0) in vec2 position;
 layout(location = 0) out vec2 v_texCoord;
+// 分块渲染: 片元 Shader 中的 gl_FragCoord 由编译器改写为 gl_FragCoord + v_tileFragOffset
+layout(location = 7) flat out vec2 v_tileFragOffset;
+
+// 与 ShaderToyUniforms 同一个 Uniform Buffer，只声明分块渲染组 (Offset 128)
+layout(std140, binding = 0) uniform TileBlock {
+    layout(offset = 128) vec4 iTileOffset;  // xy: gl_FragCoord 偏移 (像素)
+    layout(offset = 144) vec4 iTileUV;      // 整幅画面中的 uv 范围: xy 起点, zw 大小
+} tile;
 
 void main() {
     v_texCoord = (position + 1.0) * 0.5;
     // 翻转 Y 轴适配 Shadertoy 坐标系 (Shadertoy 原点在左下角)
     v_texCoord.y = 1.0 - v_texCoord.y;
+    // 不分块时 iTileUV = (0, 0, 1, 1)，iTileOffset = 0
+    v_texCoord = tile.iTileUV.xy + v_texCoord * tile.iTileUV.zw;
+    v_tileFragOffset = tile.iTileOffset.xy;
     gl_Position = vec4(position, 0.0, 1.0);
 }
@@ -11,7 +11,38 @@ Item {
 
     signal editoShader(string theShader)
     signal removeShader(int rowIndex)
-    signal changeInputId(int rowIndex,int newValue)
+    signal changeChannel(int rowIndex, int channel, string type, int index)
+    signal changeTarget(int rowIndex, real scale, string format)
+    signal changeSampler(int rowIndex, int channel, string filter, string wrap)
+
+    // 离屏 Pass 的分辨率缩放与格式 (上屏 Pass 忽略)
+    readonly property var scaleOptions: [
+        { text: "1", value: 1.0 }, { text: "1/2", value: 0.5 }, { text: "1/4", value: 0.25 }, { text: "1/8", value: 0.125 }
+    ]
+    readonly property var formatOptions: ["rgba16f", "rgba8", "r16f", "rg16f", "rgba32f"]
+
+    // iChannel 采样方式 (同 Shadertoy)
+    readonly property var filterOptions: ["linear", "nearest", "mipmap"]
+    readonly property var wrapOptions: ["clamp", "repeat", "mirror"]
+
+    // iChannel 可选输入: 无 / 本帧 Pass 输出 / 上一帧 Pass 输出 / 静态纹理
+    function channelOptions(count)
+    {
+        var opts = [{ text: "无", type: "none", index: -1 }]
+        for (var i = 0; i < count; i++) opts.push({ text: "Pass " + i, type: "pass", index: i })
+        for (var j = 0; j < count; j++) opts.push({ text: "上一帧 " + j, type: "prev", index: j })
+        for (var t = 0; t < 3; t++) opts.push({ text: "纹理 " + t, type: "texture", index: t })
+        return opts
+    }
+
+    function optionIndex(opts, ch)
+    {
+        if (!ch) return 0
+        for (var k = 0; k < opts.length; k++) {
+            if (opts[k].type === ch.type && opts[k].index === ch.index) return k
+        }
+        return 0
+    }
 
 
 
@@ -66,56 +97,108 @@ Item {
 
             width: ListView.view.width
 
-            height: 40
+            height: 92
 
-            RowLayout {
+            property var options: root.channelOptions(view.count)
+            property int rowIndex: index
+            property var channels: modelData.channels
+
+            ColumnLayout {
                 anchors.fill: parent
                 anchors.leftMargin: 10
                 anchors.rightMargin: 10
-                spacing: 10
-
-                Text {
-                    text: index+"."+modelData.path.toString().split("/").pop()
-
-                    font.pixelSize: 14
-                    color: "white"
+                spacing: 2
 
+                RowLayout {
                     Layout.fillWidth: true
+                    spacing: 4
 
-                    Layout.alignment: Qt.AlignVCenter
-                    elide: Text.ElideMiddle
-                }
-
+                    Text {
+                        text: index+"."+modelData.path.toString().split("/").pop()
 
+                        font.pixelSize: 14
+                        color: "white"
 
-                Text {
-                    text: "输入源:"
-                    font.pixelSize: 12
-                    color: "#AAA"
-                    Layout.alignment: Qt.AlignVCenter
-                }
-
-                ComboBox {
+                        Layout.fillWidth: true
+                        elide: Text.ElideMiddle
+                    }
 
-                    Layout.preferredWidth: 60
-                    Layout.preferredHeight: 28
-                    Layout.alignment: Qt.AlignVCenter
-                    model: {
-                        var arr = []
-                        for(var i=0; i<view.count; i++) arr.push(i)
-                        arr.push(-1)
-                        return arr
+                    ComboBox {
+                        Layout.preferredWidth: 64
+                        Layout.preferredHeight: 24
+                        font.pixelSize: 11
+                        model: root.scaleOptions
+                        textRole: "text"
+                        currentIndex: Math.max(0, root.scaleOptions.findIndex(o => o.value === modelData.scale))
+                        onActivated: (i) => root.changeTarget(rowIndex, root.scaleOptions[i].value, modelData.format)
                     }
 
-                    currentIndex:modelData.inputId
+                    ComboBox {
+                        Layout.preferredWidth: 84
+                        Layout.preferredHeight: 24
+                        font.pixelSize: 11
+                        model: root.formatOptions
+                        currentIndex: Math.max(0, root.formatOptions.indexOf(modelData.format))
+                        onActivated: (i) => root.changeTarget(rowIndex, modelData.scale, root.formatOptions[i])
+                    }
+                }
 
-                    onActivated:(selectionIndex)=>
-                                {
-                                    root.changeInputId(index,selectionIndex)
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 4
+
+                    Repeater {
+                        model: 4
+                        delegate: ColumnLayout {
+                            property int channel: index
+                            property var ch: channels ? channels[channel] : null
+
+                            Layout.fillWidth: true
+                            spacing: 2
+
+                            ComboBox {
+                                id: channelBox
+                                Layout.fillWidth: true
+                                Layout.preferredHeight: 28
+                                font.pixelSize: 11
+
+                                model: options
+                                textRole: "text"
+                                displayText: "ch" + channel + ": " + currentText
+                                currentIndex: root.optionIndex(options, ch)
+
+                                onActivated: (selectionIndex) => {
+                                    var opt = options[selectionIndex]
+                                    root.changeChannel(rowIndex, channel, opt.type, opt.index)
+                                }
+                            }
+
+                            RowLayout {
+                                Layout.fillWidth: true
+                                spacing: 2
+
+                                ComboBox {
+                                    id: filterBox
+                                    Layout.fillWidth: true
+                                    Layout.preferredHeight: 22
+                                    font.pixelSize: 10
+                                    model: root.filterOptions
+                                    currentIndex: Math.max(0, root.filterOptions.indexOf(ch && ch.filter ? ch.filter : "linear"))
+                                    onActivated: (i) => root.changeSampler(rowIndex, channel, root.filterOptions[i], root.wrapOptions[wrapBox.currentIndex])
                                 }
 
-
-                    font.pixelSize: 12
+                                ComboBox {
+                                    id: wrapBox
+                                    Layout.fillWidth: true
+                                    Layout.preferredHeight: 22
+                                    font.pixelSize: 10
+                                    model: root.wrapOptions
+                                    currentIndex: Math.max(0, root.wrapOptions.indexOf(ch && ch.wrap ? ch.wrap : "clamp"))
+                                    onActivated: (i) => root.changeSampler(rowIndex, channel, root.filterOptions[filterBox.currentIndex], root.wrapOptions[i])
+                                }
+                            }
+                        }
+                    }
                 }
             }
         }
@@ -0,0 +1,227 @@
+#include "Accumulator.h"
+#include "RhiSharedContext.h"
+#include "StructModel.h"
+#include <QDebug>
+#include <QFloat16>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr int kReduceGrid = 32;   // 与 accumulate_reduce.frag 的 kGrid 一致
+
+// 32 位浮点渲染目标的混合是可选能力 (Vulkan 的 COLOR_ATTACHMENT_BLEND、GLES 的 EXT_float_blend、
+// iOS 的 Metal)，QRhi 没有对应的查询；只在规范保证支持的后端使用，其余用 RGBA16F
+// (半精度在样本数上千后 1/n 权重会丢失有效位，收敛检测会更早判定收敛)
+bool supportsFloat32Blending(QRhi *rhi)
+{
+    if (!rhi->isTextureFormatSupported(QRhiTexture::RGBA32F, QRhiTexture::RenderTarget)) return false;
+    switch (rhi->backend()) {
+    case QRhi::D3D11:
+    case QRhi::D3D12:
+        return true;
+    case QRhi::Metal:
+#if defined(Q_OS_MACOS)
+        return true;
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+}
+
+Accumulator::~Accumulator() { release(); }
+
+bool Accumulator::ensureTarget(QRhi *rhi, const QSize &size)
+{
+    if (m_rhi == rhi && m_texture && m_texture->pixelSize() == size) return false;
+    release();
+    m_rhi = rhi;
+    if (!rhi || size.isEmpty()) return true;
+
+    const QRhiTexture::Format format = supportsFloat32Blending(rhi) ? QRhiTexture::RGBA32F : QRhiTexture::RGBA16F;
+    m_texture.reset(rhi->newTexture(format, size, 1, QRhiTexture::RenderTarget));
+    if (!m_texture->create()) {
+        qWarning() << "[Accumulate] Failed to create accumulation texture" << size;
+        m_texture.reset();
+        return true;
+    }
+    m_rt.reset(rhi->newTextureRenderTarget({ m_texture.get() }, QRhiTextureRenderTarget::PreserveColorContents));
+    m_rpDesc.reset(m_rt->newCompatibleRenderPassDescriptor());
+    m_rt->setRenderPassDescriptor(m_rpDesc.get());
+    m_rt->create();
+
+    m_reduceTexture.reset(rhi->newTexture(format, QSize(kReduceGrid, kReduceGrid), 1,
+                                          QRhiTexture::RenderTarget | QRhiTexture::UsedAsTransferSource));
+    m_reduceTexture->create();
+    m_reduceRt.reset(rhi->newTextureRenderTarget({ m_reduceTexture.get() }));
+    m_reduceRpDesc.reset(m_reduceRt->newCompatibleRenderPassDescriptor());
+    m_reduceRt->setRenderPassDescriptor(m_reduceRpDesc.get());
+    m_reduceRt->create();
+
+    qDebug() << "[Accumulate] Target" << size << (format == QRhiTexture::RGBA32F ? "RGBA32F" : "RGBA16F");
+    return true;
+}
+
+void Accumulator::release()
+{
+    m_presentSrb = Bindings();
+    m_presentPipeline.reset();
+    m_presentFormat.clear();
+    m_reduceSrb = Bindings();
+    m_reducePipeline.reset();
+    m_reduceRt.reset();
+    m_reduceRpDesc.reset();
+    m_reduceTexture.reset();
+    m_rt.reset();
+    m_rpDesc.reset();
+    m_texture.reset();
+    reset();
+    // 缩减纹理已释放，在途的读回要等 QRhi 写完结果才能销毁
+    const bool inFlight = std::any_of(m_retired.begin(), m_retired.end(),
+                                      [](const std::unique_ptr<PendingReduction> &p) { return !p->ready; });
+    if (inFlight && m_rhi) m_rhi->finish();
+    m_retired.clear();
+}
+
+void Accumulator::reset()
+{
+    // 在途的读回无法取消: 移到待回收列表，完成后丢弃 (代数已过期，结果不会被采用)
+    if (m_pending) m_retired.push_back(std::move(m_pending));
+    m_samples = 0;
+    m_generation++;
+    m_previous.clear();
+    m_previousSamples = 0;
+    m_converged = false;
+    m_delta = -1.0;
+}
+
+QColor Accumulator::blendConstant() const
+{
+    const float w = 1.0f / float(m_samples + 1);
+    return QColor::fromRgbF(w, w, w, w);
+}
+
+void Accumulator::ensureBindings(RhiSharedContext &shared, Bindings &bindings, QRhiBuffer *uniforms, QRhiTexture *source)
+{
+    if (bindings.srb && bindings.uniforms == uniforms && bindings.uniformBytes == uniforms->size() && bindings.source == source)
+        return;
+
+    QRhiTexture *dummy = shared.dummyTexture(nullptr);
+    QRhiSampler *sampler = shared.samplers().get(m_rhi, ChannelFilter::Nearest, ChannelWrap::Clamp);
+
+    QVector<QRhiShaderResourceBinding> list;
+    list.append(QRhiShaderResourceBinding::uniformBufferWithDynamicOffset(0, QRhiShaderResourceBinding::VertexStage | QRhiShaderResourceBinding::FragmentStage,
+                                                                          uniforms, sizeof(ShaderToyUniforms)));
+    list.append(QRhiShaderResourceBinding::sampledTexture(1, QRhiShaderResourceBinding::FragmentStage, source, sampler));
+    for (int c = 1; c < kMaxChannels; ++c)
+        list.append(QRhiShaderResourceBinding::sampledTexture(1 + c, QRhiShaderResourceBinding::FragmentStage, dummy, sampler));
+
+    if (bindings.srb) {
+        // 布局不变，只替换资源
+        bindings.srb->setBindings(list.cbegin(), list.cend());
+        bindings.srb->updateResources();
+    } else {
+        bindings.srb.reset(m_rhi->newShaderResourceBindings());
+        bindings.srb->setBindings(list.cbegin(), list.cend());
+        bindings.srb->create();
+    }
+    bindings.uniforms = uniforms;
+    bindings.uniformBytes = uniforms->size();
+    bindings.source = source;
+}
+
+void Accumulator::recordConvergenceCheck(QRhi *rhi, QRhiCommandBuffer *cb, RhiSharedContext &shared,
+                                         QRhiBuffer *uniforms, quint32 uniformSlice, QRhiBuffer *quad)
+{
+    if (convergenceThreshold <= 0.0 || !m_reduceRt || m_converged) return;
+    if (m_samples == 0 || m_samples % std::max(1, checkInterval) != 0) return;
+    if (m_pending && !m_pending->ready) return;   // 上一次还在途，跳过本次
+
+    if (!m_reducePipeline) {
+        m_reducePipeline = shared.pipeline(QStringLiteral(":/myfile/accumulate_reduce.frag.qsb"), PipelineBlend::Opaque, m_reduceRpDesc.get());
+        if (!m_reducePipeline) return;
+    }
+    ensureBindings(shared, m_reduceSrb, uniforms, m_texture.get());
+
+    cb->beginPass(m_reduceRt.get(), Qt::transparent, { 1.0f, 0 });
+    cb->setGraphicsPipeline(m_reducePipeline.get());
+    cb->setViewport({ 0, 0, float(kReduceGrid), float(kReduceGrid) });
+    const QRhiCommandBuffer::DynamicOffset slice(0, uniformSlice);
+    cb->setShaderResources(m_reduceSrb.srb.get(), 1, &slice);
+    const QRhiCommandBuffer::VertexInput vbuf(quad, 0);
+    cb->setVertexInput(0, 1, &vbuf);
+    cb->draw(4);
+
+    // 读回只有 32x32 个像素，随本帧提交，完成后 (通常晚一两帧) 在 poll() 中比较
+    auto pending = std::make_unique<PendingReduction>();
+    pending->samples = m_samples;
+    pending->generation = m_generation;
+    PendingReduction *raw = pending.get();
+    pending->result.completed = [raw]() { raw->ready = true; };
+    QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
+    rub->readBackTexture({ m_reduceTexture.get() }, &raw->result);
+    cb->endPass(rub);
+    m_pending = std::move(pending);
+}
+
+void Accumulator::poll()
+{
+    m_retired.erase(std::remove_if(m_retired.begin(), m_retired.end(),
+                                   [](const std::unique_ptr<PendingReduction> &p) { return p->ready; }),
+                    m_retired.end());
+
+    if (!m_pending || !m_pending->ready) return;
+    std::unique_ptr<PendingReduction> done = std::move(m_pending);
+    if (done->generation != m_generation) return;   // reset() 之前发出的读回
+
+    // 读回数据按格式转换为 float
+    const QByteArray &data = done->result.data;
+    const int count = kReduceGrid * kReduceGrid * 4;
+    QVector<float> current(count);
+    if (done->result.format == QRhiTexture::RGBA32F && data.size() >= count * 4) {
+        std::memcpy(current.data(), data.constData(), size_t(count) * 4);
+    } else if (done->result.format == QRhiTexture::RGBA16F && data.size() >= count * 2) {
+        const qfloat16 *half = reinterpret_cast<const qfloat16 *>(data.constData());
+        for (int i = 0; i < count; ++i) current[i] = float(half[i]);
+    } else {
+        return;
+    }
+
+    if (!m_previous.isEmpty() && done->samples > m_previousSamples) {
+        double sum = 0.0;
+        for (int i = 0; i < count; ++i) sum += std::abs(double(current[i]) - double(m_previous[i]));
+        // 两次检测之间平均值的总变化分摊到其间的每个样本
+        m_delta = sum / count / double(done->samples - m_previousSamples);
+        if (m_delta < convergenceThreshold) {
+            m_converged = true;
+            qDebug() << "[Accumulate] Converged after" << done->samples << "samples, delta per sample" << m_delta;
+        }
+    }
+    m_previous = std::move(current);
+    m_previousSamples = done->samples;
+}
+
+void Accumulator::present(QRhiCommandBuffer *cb, RhiSharedContext &shared, QRhiRenderPassDescriptor *rpDesc,
+                          const QRhiViewport &viewport, QRhiBuffer *uniforms, quint32 uniformSlice, QRhiBuffer *quad)
+{
+    if (!m_texture || !rpDesc) return;
+
+    const QVector<quint32> format = rpDesc->serializedFormat();
+    if (!m_presentPipeline || m_presentFormat != format) {
+        m_presentPipeline = shared.pipeline(QStringLiteral(":/myfile/accumulate_present.frag.qsb"), PipelineBlend::Alpha, rpDesc);
+        m_presentFormat = format;
+        if (!m_presentPipeline) return;
+    }
+    ensureBindings(shared, m_presentSrb, uniforms, m_texture.get());
+
+    cb->setGraphicsPipeline(m_presentPipeline.get());
+    cb->setViewport(viewport);
+    const QRhiCommandBuffer::DynamicOffset slice(0, uniformSlice);
+    cb->setShaderResources(m_presentSrb.srb.get(), 1, &slice);
+    const QRhiCommandBuffer::VertexInput vbuf(quad, 0);
+    cb->setVertexInput(0, 1, &vbuf);
+    cb->draw(4);
+}
@@ -0,0 +1,101 @@
+#ifndef ACCUMULATOR_H
+#define ACCUMULATOR_H
+
+#include <QColor>
+#include <QSize>
+#include <QVector>
+#include <rhi/qrhi.h>
+#include <memory>
+#include <vector>
+
+class RhiSharedContext;
+
+// ----------------------------------------------------------------
+// Accumulator: 累积模式 (渐进式路径追踪) 的 GPU 资源与收敛检测
+// - 累积纹理默认为 RGBA16F (确定支持 32 位浮点混合的后端用 RGBA32F)，上屏 Shader 每帧渲染一个样本，
+//   以常量混合 1/(n+1) 写入，纹理中始终是前 n+1 个样本的平均值
+// - 每 checkInterval 个样本把累积纹理缩减为 32x32 并异步读回，与上一次的缩减结果比较，
+//   得到平均每个样本带来的变化 (perSampleDelta)，低于阈值即视为收敛
+// - 上屏时把累积纹理画到视口，与直接上屏一样按 Alpha 叠加
+// 仅在渲染线程使用；由 SquircleRenderer 持有
+// ----------------------------------------------------------------
+class Accumulator {
+public:
+    ~Accumulator();
+
+    // 按 size 准备累积纹理；尺寸变化时重新分配并 reset()，返回是否重新分配
+    bool ensureTarget(QRhi *rhi, const QSize &size);
+    void release();
+    bool isReady() const { return m_rt != nullptr; }
+
+    // 丢弃已累积的样本，下一个样本直接覆盖
+    void reset();
+    int sampleCount() const { return m_samples; }
+    bool converged() const { return m_converged; }
+    double perSampleDelta() const { return m_delta; }
+
+    QRhiTextureRenderTarget *renderTarget() const { return m_rt.get(); }
+    QRhiRenderPassDescriptor *renderPassDescriptor() const { return m_rpDesc.get(); }
+    // 下一个样本的混合权重 (第一个样本用不混合的管线直接覆盖)
+    QColor blendConstant() const;
+    void sampleAdded() { m_samples++; }
+
+    // 每 checkInterval 个样本录制一次缩减 Pass 并登记读回 (需在渲染通道外调用)
+    // uniforms/uniformSlice 为 common.vert 所需的 Uniform (取上屏 Pass 的一段)
+    void recordConvergenceCheck(QRhi *rhi, QRhiCommandBuffer *cb, RhiSharedContext &shared,
+                                QRhiBuffer *uniforms, quint32 uniformSlice, QRhiBuffer *quad);
+
+    // 之前登记的读回已完成时更新收敛状态 (每帧开始时调用)
+    void poll();
+
+    // 在调用方已经开始的渲染通道中把累积结果画到 viewport
+    void present(QRhiCommandBuffer *cb, RhiSharedContext &shared, QRhiRenderPassDescriptor *rpDesc,
+                 const QRhiViewport &viewport, QRhiBuffer *uniforms, quint32 uniformSlice, QRhiBuffer *quad);
+
+    int checkInterval = 16;             // 两次收敛检测之间的样本数
+    double convergenceThreshold = 0.0;  // 每个样本的平均变化低于此值视为收敛 (0: 不检测)
+
+private:
+    struct Bindings {
+        std::unique_ptr<QRhiShaderResourceBindings> srb;
+        QRhiBuffer *uniforms = nullptr;
+        quint32 uniformBytes = 0;       // Uniform Buffer 扩容后原生缓冲会更换，需要刷新
+        QRhiTexture *source = nullptr;
+    };
+    // binding 0 为动态偏移的 Uniform，binding 1 为 source，其余为黑色占位 (与 Pass 的 SRB 布局一致)
+    void ensureBindings(RhiSharedContext &shared, Bindings &bindings, QRhiBuffer *uniforms, QRhiTexture *source);
+
+    QRhi *m_rhi = nullptr;
+    std::unique_ptr<QRhiTexture> m_texture;
+    std::unique_ptr<QRhiTextureRenderTarget> m_rt;          // 保留原内容 (PreserveColorContents)
+    std::unique_ptr<QRhiRenderPassDescriptor> m_rpDesc;
+    int m_samples = 0;
+
+    // 上屏
+    Bindings m_presentSrb;
+    std::shared_ptr<QRhiGraphicsPipeline> m_presentPipeline;
+    QVector<quint32> m_presentFormat;
+
+    // 收敛检测: 32x32 缩减目标与一份在途读回
+    std::unique_ptr<QRhiTexture> m_reduceTexture;
+    std::unique_ptr<QRhiTextureRenderTarget> m_reduceRt;
+    std::unique_ptr<QRhiRenderPassDescriptor> m_reduceRpDesc;
+    Bindings m_reduceSrb;
+    std::shared_ptr<QRhiGraphicsPipeline> m_reducePipeline;
+    // 在途读回: QRhi 持有结果的裸指针，完成之前必须一直有效
+    struct PendingReduction {
+        QRhiReadbackResult result;
+        bool ready = false;
+        int samples = 0;                // 读回对应的样本数
+        quint64 generation = 0;         // 发出时的代数，与当前不同则丢弃
+    };
+    std::unique_ptr<PendingReduction> m_pending;
+    std::vector<std::unique_ptr<PendingReduction>> m_retired;   // reset() 时仍在途的读回，完成后回收
+    quint64 m_generation = 0;           // reset() 时递增，丢弃旧的读回
+    QVector<float> m_previous;          // 上一次的缩减结果
+    int m_previousSamples = 0;
+    bool m_converged = false;
+    double m_delta = -1.0;              // < 0: 尚未估计
+};
+
+#endif // ACCUMULATOR_H
@@ -0,0 +1,479 @@
+#include "CompressedTexture.h"
+#include <QFileInfo>
+#include <QUrl>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+struct FormatInfo {
+    quint32 code;
+    QRhiTexture::Format format;
+    bool srgb;
+};
+
+// KTX1: glInternalFormat
+const FormatInfo kGlFormats[] = {
+    { 0x83F0, QRhiTexture::BC1, false }, { 0x83F1, QRhiTexture::BC1, false },
+    { 0x8C4C, QRhiTexture::BC1, true },  { 0x8C4D, QRhiTexture::BC1, true },
+    { 0x83F2, QRhiTexture::BC2, false }, { 0x8C4E, QRhiTexture::BC2, true },
+    { 0x83F3, QRhiTexture::BC3, false }, { 0x8C4F, QRhiTexture::BC3, true },
+    { 0x8DBB, QRhiTexture::BC4, false }, { 0x8DBD, QRhiTexture::BC5, false },
+    { 0x8E8F, QRhiTexture::BC6H, false },
+    { 0x8E8C, QRhiTexture::BC7, false }, { 0x8E8D, QRhiTexture::BC7, true },
+    { 0x8D64, QRhiTexture::ETC2_RGB8, false },   // ETC1 是 ETC2 RGB8 的子集
+    { 0x9274, QRhiTexture::ETC2_RGB8, false }, { 0x9275, QRhiTexture::ETC2_RGB8, true },
+    { 0x9276, QRhiTexture::ETC2_RGB8A1, false }, { 0x9277, QRhiTexture::ETC2_RGB8A1, true },
+    { 0x9278, QRhiTexture::ETC2_RGBA8, false }, { 0x9279, QRhiTexture::ETC2_RGBA8, true },
+    { 0x93B0, QRhiTexture::ASTC_4x4, false },   { 0x93D0, QRhiTexture::ASTC_4x4, true },
+    { 0x93B1, QRhiTexture::ASTC_5x4, false },   { 0x93D1, QRhiTexture::ASTC_5x4, true },
+    { 0x93B2, QRhiTexture::ASTC_5x5, false },   { 0x93D2, QRhiTexture::ASTC_5x5, true },
+    { 0x93B3, QRhiTexture::ASTC_6x5, false },   { 0x93D3, QRhiTexture::ASTC_6x5, true },
+    { 0x93B4, QRhiTexture::ASTC_6x6, false },   { 0x93D4, QRhiTexture::ASTC_6x6, true },
+    { 0x93B5, QRhiTexture::ASTC_8x5, false },   { 0x93D5, QRhiTexture::ASTC_8x5, true },
+    { 0x93B6, QRhiTexture::ASTC_8x6, false },   { 0x93D6, QRhiTexture::ASTC_8x6, true },
+    { 0x93B7, QRhiTexture::ASTC_8x8, false },   { 0x93D7, QRhiTexture::ASTC_8x8, true },
+    { 0x93B8, QRhiTexture::ASTC_10x5, false },  { 0x93D8, QRhiTexture::ASTC_10x5, true },
+    { 0x93B9, QRhiTexture::ASTC_10x6, false },  { 0x93D9, QRhiTexture::ASTC_10x6, true },
+    { 0x93BA, QRhiTexture::ASTC_10x8, false },  { 0x93DA, QRhiTexture::ASTC_10x8, true },
+    { 0x93BB, QRhiTexture::ASTC_10x10, false }, { 0x93DB, QRhiTexture::ASTC_10x10, true },
+    { 0x93BC, QRhiTexture::ASTC_12x10, false }, { 0x93DC, QRhiTexture::ASTC_12x10, true },
+    { 0x93BD, QRhiTexture::ASTC_12x12, false }, { 0x93DD, QRhiTexture::ASTC_12x12, true },
+    { 0x8058, QRhiTexture::RGBA8, false },   { 0x8C43, QRhiTexture::RGBA8, true },
+    { 0x881A, QRhiTexture::RGBA16F, false }, { 0x8814, QRhiTexture::RGBA32F, false },
+};
+
+// KTX2: VkFormat
+const FormatInfo kVkFormats[] = {
+    { 131, QRhiTexture::BC1, false }, { 132, QRhiTexture::BC1, true },
+    { 133, QRhiTexture::BC1, false }, { 134, QRhiTexture::BC1, true },
+    { 135, QRhiTexture::BC2, false }, { 136, QRhiTexture::BC2, true },
+    { 137, QRhiTexture::BC3, false }, { 138, QRhiTexture::BC3, true },
+    { 139, QRhiTexture::BC4, false }, { 141, QRhiTexture::BC5, false },
+    { 143, QRhiTexture::BC6H, false },
+    { 145, QRhiTexture::BC7, false }, { 146, QRhiTexture::BC7, true },
+    { 147, QRhiTexture::ETC2_RGB8, false },   { 148, QRhiTexture::ETC2_RGB8, true },
+    { 149, QRhiTexture::ETC2_RGB8A1, false }, { 150, QRhiTexture::ETC2_RGB8A1, true },
+    { 151, QRhiTexture::ETC2_RGBA8, false },  { 152, QRhiTexture::ETC2_RGBA8, true },
+    { 157, QRhiTexture::ASTC_4x4, false },   { 158, QRhiTexture::ASTC_4x4, true },
+    { 159, QRhiTexture::ASTC_5x4, false },   { 160, QRhiTexture::ASTC_5x4, true },
+    { 161, QRhiTexture::ASTC_5x5, false },   { 162, QRhiTexture::ASTC_5x5, true },
+    { 163, QRhiTexture::ASTC_6x5, false },   { 164, QRhiTexture::ASTC_6x5, true },
+    { 165, QRhiTexture::ASTC_6x6, false },   { 166, QRhiTexture::ASTC_6x6, true },
+    { 167, QRhiTexture::ASTC_8x5, false },   { 168, QRhiTexture::ASTC_8x5, true },
+    { 169, QRhiTexture::ASTC_8x6, false },   { 170, QRhiTexture::ASTC_8x6, true },
+    { 171, QRhiTexture::ASTC_8x8, false },   { 172, QRhiTexture::ASTC_8x8, true },
+    { 173, QRhiTexture::ASTC_10x5, false },  { 174, QRhiTexture::ASTC_10x5, true },
+    { 175, QRhiTexture::ASTC_10x6, false },  { 176, QRhiTexture::ASTC_10x6, true },
+    { 177, QRhiTexture::ASTC_10x8, false },  { 178, QRhiTexture::ASTC_10x8, true },
+    { 179, QRhiTexture::ASTC_10x10, false }, { 180, QRhiTexture::ASTC_10x10, true },
+    { 181, QRhiTexture::ASTC_12x10, false }, { 182, QRhiTexture::ASTC_12x10, true },
+    { 183, QRhiTexture::ASTC_12x12, false }, { 184, QRhiTexture::ASTC_12x12, true },
+    { 37, QRhiTexture::RGBA8, false }, { 43, QRhiTexture::RGBA8, true },
+    { 44, QRhiTexture::BGRA8, false },
+    { 97, QRhiTexture::RGBA16F, false }, { 109, QRhiTexture::RGBA32F, false },
+};
+
+// DDS: DX10 扩展头中的 DXGI_FORMAT
+const FormatInfo kDxgiFormats[] = {
+    { 71, QRhiTexture::BC1, false }, { 72, QRhiTexture::BC1, true },
+    { 74, QRhiTexture::BC2, false }, { 75, QRhiTexture::BC2, true },
+    { 77, QRhiTexture::BC3, false }, { 78, QRhiTexture::BC3, true },
+    { 80, QRhiTexture::BC4, false }, { 83, QRhiTexture::BC5, false },
+    { 95, QRhiTexture::BC6H, false },
+    { 98, QRhiTexture::BC7, false }, { 99, QRhiTexture::BC7, true },
+    { 28, QRhiTexture::RGBA8, false }, { 29, QRhiTexture::RGBA8, true },
+    { 87, QRhiTexture::BGRA8, false },
+    { 10, QRhiTexture::RGBA16F, false }, { 2, QRhiTexture::RGBA32F, false },
+};
+
+template <size_t N>
+const FormatInfo *findFormat(const FormatInfo (&table)[N], quint32 code)
+{
+    for (const FormatInfo &f : table) {
+        if (f.code == code) return &f;
+    }
+    return nullptr;
+}
+
+constexpr quint32 fourCC(char a, char b, char c, char d)
+{
+    return quint32(uchar(a)) | (quint32(uchar(b)) << 8) | (quint32(uchar(c)) << 16) | (quint32(uchar(d)) << 24);
+}
+
+// 块压缩格式的块尺寸与每块字节数；非压缩格式返回 false
+bool blockInfo(QRhiTexture::Format format, QSize *blockSize, int *blockBytes)
+{
+    int w = 4, h = 4, bytes = 16;
+    switch (format) {
+    case QRhiTexture::BC1:
+    case QRhiTexture::BC4:
+    case QRhiTexture::ETC2_RGB8:
+    case QRhiTexture::ETC2_RGB8A1:
+        bytes = 8;
+        break;
+    case QRhiTexture::BC2:
+    case QRhiTexture::BC3:
+    case QRhiTexture::BC5:
+    case QRhiTexture::BC6H:
+    case QRhiTexture::BC7:
+    case QRhiTexture::ETC2_RGBA8:
+    case QRhiTexture::ASTC_4x4:
+        break;
+    case QRhiTexture::ASTC_5x4:   w = 5;  h = 4;  break;
+    case QRhiTexture::ASTC_5x5:   w = 5;  h = 5;  break;
+    case QRhiTexture::ASTC_6x5:   w = 6;  h = 5;  break;
+    case QRhiTexture::ASTC_6x6:   w = 6;  h = 6;  break;
+    case QRhiTexture::ASTC_8x5:   w = 8;  h = 5;  break;
+    case QRhiTexture::ASTC_8x6:   w = 8;  h = 6;  break;
+    case QRhiTexture::ASTC_8x8:   w = 8;  h = 8;  break;
+    case QRhiTexture::ASTC_10x5:  w = 10; h = 5;  break;
+    case QRhiTexture::ASTC_10x6:  w = 10; h = 6;  break;
+    case QRhiTexture::ASTC_10x8:  w = 10; h = 8;  break;
+    case QRhiTexture::ASTC_10x10: w = 10; h = 10; break;
+    case QRhiTexture::ASTC_12x10: w = 12; h = 10; break;
+    case QRhiTexture::ASTC_12x12: w = 12; h = 12; break;
+    default:
+        return false;
+    }
+    if (blockSize) *blockSize = QSize(w, h);
+    if (blockBytes) *blockBytes = bytes;
+    return true;
+}
+
+int bytesPerPixel(QRhiTexture::Format format)
+{
+    switch (format) {
+    case QRhiTexture::RGBA8:
+    case QRhiTexture::BGRA8:
+        return 4;
+    case QRhiTexture::RGBA16F:
+        return 8;
+    case QRhiTexture::RGBA32F:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+QSize mipSize(const QSize &base, int level)
+{
+    return QSize(std::max(1, base.width() >> level), std::max(1, base.height() >> level));
+}
+
+// 一级 Mip 的数据量 (不足一块的边按整块计)
+qint64 levelBytes(QRhiTexture::Format format, const QSize &size)
+{
+    QSize block;
+    int bytes = 0;
+    if (blockInfo(format, &block, &bytes)) {
+        return qint64((size.width() + block.width() - 1) / block.width())
+             * ((size.height() + block.height() - 1) / block.height()) * bytes;
+    }
+    return qint64(size.width()) * size.height() * bytesPerPixel(format);
+}
+
+int fullMipChain(const QSize &size)
+{
+    int levels = 1;
+    for (int s = std::max(size.width(), size.height()); s > 1; s >>= 1) levels++;
+    return levels;
+}
+
+} // namespace
+
+CompressedTexture::~CompressedTexture()
+{
+    if (m_data) m_file.unmap(const_cast<uchar *>(m_data));
+}
+
+bool CompressedTexture::isTextureFile(const QString &path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    return suffix == "ktx" || suffix == "ktx2" || suffix == "dds";
+}
+
+std::shared_ptr<CompressedTexture> CompressedTexture::open(const QString &path, QString *error)
+{
+    std::shared_ptr<CompressedTexture> tex(new CompressedTexture);
+    const QString localPath = path.startsWith("file:") ? QUrl(path).toLocalFile() : path;
+
+    tex->m_file.setFileName(localPath);
+    if (!tex->m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QStringLiteral("Cannot open %1").arg(localPath);
+        return nullptr;
+    }
+    tex->m_length = tex->m_file.size();
+    tex->m_data = tex->m_file.map(0, tex->m_length);
+    if (!tex->m_data) {
+        if (error) *error = QStringLiteral("Cannot map %1").arg(localPath);
+        return nullptr;
+    }
+
+    static const uchar ktx1Id[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    static const uchar ktx2Id[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    bool ok = false;
+    if (tex->m_length >= 12 && std::memcmp(tex->m_data, ktx1Id, 12) == 0) ok = tex->parseKtx(error);
+    else if (tex->m_length >= 12 && std::memcmp(tex->m_data, ktx2Id, 12) == 0) ok = tex->parseKtx2(error);
+    else if (tex->m_length >= 4 && qFromLittleEndian<quint32>(tex->m_data) == fourCC('D', 'D', 'S', ' ')) ok = tex->parseDds(error);
+    else if (error) *error = QStringLiteral("Unrecognized texture container");
+
+    if (!ok || !tex->validateLevels(error)) return nullptr;
+
+    // QRhi 的 MipMapped 纹理按完整 Mip 链分配，文件只带部分级别时其余级别内容未定义:
+    // 这种情况只用第 0 级，不开 Mip
+    if (tex->m_levels.size() > 1 && (int)tex->m_levels.size() != fullMipChain(tex->m_size)) {
+        qDebug() << "[Texture]" << localPath << "has" << tex->m_levels.size() << "of"
+                 << fullMipChain(tex->m_size) << "mip levels, using level 0 only.";
+        tex->m_levels.resize(1);
+    }
+    return tex;
+}
+
+QRhiTexture::Flags CompressedTexture::flags() const
+{
+    QRhiTexture::Flags f;
+    if (m_levels.size() > 1) f |= QRhiTexture::MipMapped;
+    if (m_srgb) f |= QRhiTexture::sRGB;
+    return f;
+}
+
+QByteArray CompressedTexture::levelData(int i) const
+{
+    const Level &l = m_levels[i];
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(m_data + l.offset), l.size);
+}
+
+qint64 CompressedTexture::totalBytes() const
+{
+    qint64 total = 0;
+    for (const Level &l : m_levels) total += l.size;
+    return total;
+}
+
+bool CompressedTexture::validateLevels(QString *error) const
+{
+    if (m_size.isEmpty() || m_levels.empty()) {
+        if (error) *error = QStringLiteral("Empty texture");
+        return false;
+    }
+    // 块压缩格式的第 0 级必须是整块 (更小的 Mip 级别允许不足一块)
+    QSize block;
+    if (blockInfo(m_format, &block, nullptr)
+        && (m_size.width() % block.width() != 0 || m_size.height() % block.height() != 0)) {
+        if (error) *error = QStringLiteral("Block-compressed size %1x%2 is not a multiple of the %3x%4 block")
+                                .arg(m_size.width()).arg(m_size.height()).arg(block.width()).arg(block.height());
+        return false;
+    }
+    for (int i = 0; i < (int)m_levels.size(); ++i) {
+        const Level &l = m_levels[i];
+        if (l.offset < 0 || l.size <= 0 || l.offset + l.size > m_length) {
+            if (error) *error = QStringLiteral("Truncated texture data");
+            return false;
+        }
+        if (l.size < levelBytes(m_format, l.pixelSize)) {
+            if (error) *error = QStringLiteral("Mip level %1 is smaller than its %2x%3 size requires")
+                                    .arg(i).arg(l.pixelSize.width()).arg(l.pixelSize.height());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CompressedTexture::parseKtx(QString *error)
+{
+    // 12 字节标识 + 13 个 uint32 头字段
+    if (m_length < 64) {
+        if (error) *error = QStringLiteral("Truncated KTX header");
+        return false;
+    }
+    const uchar *h = m_data + 12;
+    const bool swap = qFromLittleEndian<quint32>(h) != 0x04030201;
+    auto field = [h, swap](int index) {
+        const quint32 v = qFromLittleEndian<quint32>(h + 4 * index);
+        return swap ? qbswap(v) : v;
+    };
+
+    const quint32 glInternalFormat = field(4);
+    const quint32 width = field(6);
+    const quint32 height = field(7);
+    const quint32 depth = field(8);
+    const quint32 arrayElements = field(9);
+    const quint32 faces = field(10);
+    const quint32 mipLevels = std::max<quint32>(1, field(11));
+    const quint32 kvBytes = field(12);
+
+    if (depth > 1 || arrayElements > 0 || faces != 1) {
+        if (error) *error = QStringLiteral("Only 2D KTX textures are supported");
+        return false;
+    }
+    const FormatInfo *info = findFormat(kGlFormats, glInternalFormat);
+    if (!info) {
+        if (error) *error = QStringLiteral("Unsupported KTX internal format 0x%1").arg(glInternalFormat, 0, 16);
+        return false;
+    }
+    m_format = info->format;
+    m_srgb = info->srgb;
+    m_size = QSize(int(width), int(std::max<quint32>(1, height)));
+
+    qint64 offset = 64 + kvBytes;
+    for (quint32 i = 0; i < mipLevels; ++i) {
+        if (offset + 4 > m_length) {
+            // 声明的 Mip 级数与数据不符: 整个文件视为损坏，不静默丢掉后面的级别
+            if (error) *error = QStringLiteral("Truncated KTX mip chain (%1 of %2 levels)").arg(i).arg(mipLevels);
+            return false;
+        }
+        quint32 imageSize = qFromLittleEndian<quint32>(m_data + offset);
+        if (swap) imageSize = qbswap(imageSize);
+        offset += 4;
+        m_levels.push_back({ offset, imageSize, mipSize(m_size, int(i)) });
+        offset += (imageSize + 3) & ~quint32(3);    // mipPadding
+    }
+    return true;
+}
+
+bool CompressedTexture::parseKtx2(QString *error)
+{
+    // 12 字节标识 + 9 个 uint32 + 索引 (4 个 uint32 + 2 个 uint64) = 80 字节
+    if (m_length < 80) {
+        if (error) *error = QStringLiteral("Truncated KTX2 header");
+        return false;
+    }
+    const uchar *h = m_data + 12;
+    auto u32 = [h](int byteOffset) { return qFromLittleEndian<quint32>(h + byteOffset); };
+
+    const quint32 vkFormat = u32(0);
+    const quint32 width = u32(8);
+    const quint32 height = u32(12);
+    const quint32 depth = u32(16);
+    const quint32 layers = u32(20);
+    const quint32 faces = u32(24);
+    const quint32 levelCount = std::max<quint32>(1, u32(28));
+    const quint32 supercompression = u32(32);
+
+    if (supercompression != 0) {
+        if (error) *error = QStringLiteral("Supercompressed KTX2 (Basis/Zstd) is not supported");
+        return false;
+    }
+    if (depth > 1 || layers > 1 || faces != 1) {
+        if (error) *error = QStringLiteral("Only 2D KTX2 textures are supported");
+        return false;
+    }
+    const FormatInfo *info = findFormat(kVkFormats, vkFormat);
+    if (!info) {
+        if (error) *error = QStringLiteral("Unsupported KTX2 vkFormat %1").arg(vkFormat);
+        return false;
+    }
+    m_format = info->format;
+    m_srgb = info->srgb;
+    m_size = QSize(int(width), int(std::max<quint32>(1, height)));
+
+    // 级别索引紧随头部: 每级 { byteOffset, byteLength, uncompressedByteLength } (uint64)
+    const qint64 indexStart = 80;
+    if (indexStart + qint64(levelCount) * 24 > m_length) {
+        if (error) *error = QStringLiteral("Truncated KTX2 level index");
+        return false;
+    }
+    for (quint32 i = 0; i < levelCount; ++i) {
+        const uchar *entry = m_data + indexStart + i * 24;
+        const qint64 offset = qint64(qFromLittleEndian<quint64>(entry));
+        const qint64 length = qint64(qFromLittleEndian<quint64>(entry + 8));
+        m_levels.push_back({ offset, length, mipSize(m_size, int(i)) });
+    }
+    return true;
+}
+
+bool CompressedTexture::parseDds(QString *error)
+{
+    // "DDS " + 124 字节 DDS_HEADER
+    if (m_length < 128) {
+        if (error) *error = QStringLiteral("Truncated DDS header");
+        return false;
+    }
+    const uchar *h = m_data + 4;
+    auto u32 = [h](int byteOffset) { return qFromLittleEndian<quint32>(h + byteOffset); };
+
+    const quint32 height = u32(8);
+    const quint32 width = u32(12);
+    const quint32 mipCount = std::max<quint32>(1, u32(24));
+    const quint32 pfFlags = u32(76);
+    const quint32 pfFourCC = u32(80);
+    const quint32 pfBitCount = u32(84);
+    const quint32 pfRMask = u32(88);
+    const quint32 caps2 = u32(108);
+
+    if (caps2 & 0x200) {    // DDSCAPS2_CUBEMAP
+        if (error) *error = QStringLiteral("DDS cube maps are not supported");
+        return false;
+    }
+    if (u32(20) > 1 && (caps2 & 0x200000)) {   // dwDepth + DDSCAPS2_VOLUME
+        if (error) *error = QStringLiteral("DDS volume textures are not supported");
+        return false;
+    }
+
+    qint64 dataOffset = 128;
+    const FormatInfo *info = nullptr;
+    FormatInfo legacy { 0, QRhiTexture::UnknownFormat, false };
+
+    if (pfFlags & 0x4) {    // DDPF_FOURCC
+        if (pfFourCC == fourCC('D', 'X', '1', '0')) {
+            if (m_length < 148) {
+                if (error) *error = QStringLiteral("Truncated DDS DX10 header");
+                return false;
+            }
+            // DDS_HEADER_DXT10: dxgiFormat, resourceDimension, miscFlag, arraySize, miscFlags2
+            const quint32 dxgiFormat = qFromLittleEndian<quint32>(m_data + 128);
+            const quint32 dimension = qFromLittleEndian<quint32>(m_data + 132);
+            const quint32 miscFlag = qFromLittleEndian<quint32>(m_data + 136);
+            const quint32 arraySize = qFromLittleEndian<quint32>(m_data + 140);
+            if (miscFlag & 0x4) {   // D3D10_RESOURCE_MISC_TEXTURECUBE: DX10 文件在这里标记立方体贴图
+                if (error) *error = QStringLiteral("DDS cube maps are not supported");
+                return false;
+            }
+            if (dimension != 3) {   // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+                if (error) *error = QStringLiteral("Only 2D DDS textures are supported");
+                return false;
+            }
+            if (arraySize > 1) {
+                if (error) *error = QStringLiteral("DDS texture arrays are not supported");
+                return false;
+            }
+            info = findFormat(kDxgiFormats, dxgiFormat);
+            dataOffset = 148;
+        } else if (pfFourCC == fourCC('D', 'X', 'T', '1')) {
+            legacy.format = QRhiTexture::BC1;
+        } else if (pfFourCC == fourCC('D', 'X', 'T', '3')) {
+            legacy.format = QRhiTexture::BC2;
+        } else if (pfFourCC == fourCC('D', 'X', 'T', '5')) {
+            legacy.format = QRhiTexture::BC3;
+        } else if (pfFourCC == fourCC('A', 'T', 'I', '1') || pfFourCC == fourCC('B', 'C', '4', 'U')) {
+            legacy.format = QRhiTexture::BC4;
+        } else if (pfFourCC == fourCC('A', 'T', 'I', '2') || pfFourCC == fourCC('B', 'C', '5', 'U')) {
+            legacy.format = QRhiTexture::BC5;
+        }
+    } else if ((pfFlags & 0x40) && pfBitCount == 32) {  // DDPF_RGB，32 位
+        legacy.format = pfRMask == 0x000000ff ? QRhiTexture::RGBA8 : QRhiTexture::BGRA8;
+    }
+    if (!info && legacy.format != QRhiTexture::UnknownFormat) info = &legacy;
+    if (!info) {
+        if (error) *error = QStringLiteral("Unsupported DDS pixel format");
+        return false;
+    }
+
+    m_format = info->format;
+    m_srgb = info->srgb;
+    m_size = QSize(int(width), int(std::max<quint32>(1, height)));
+
+    // DDS 不记录每级大小，按格式计算 (块对齐在 validateLevels 中检查)
+    qint64 offset = dataOffset;
+    for (quint32 i = 0; i < mipCount; ++i) {
+        const QSize s = mipSize(m_size, int(i));
+        const qint64 bytes = levelBytes(m_format, s);
+        m_levels.push_back({ offset, bytes, s });
+        offset += bytes;
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef COMPRESSEDTEXTURE_H
+#define COMPRESSEDTEXTURE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QSize>
+#include <QString>
+#include <rhi/qrhi.h>
+#include <memory>
+#include <vector>
+
+// ----------------------------------------------------------------
+// CompressedTexture: KTX / KTX2 / DDS 纹理文件 (内存映射，零拷贝)
+// 只解析文件头与各级 Mip 的位置，数据保持在映射内存中直接交给 QRhi 上传。
+// 支持 BC1-BC7、ETC2、ASTC 以及 RGBA8 / BGRA8 / RGBA16F / RGBA32F 非压缩格式；
+// 仅限 2D 纹理 (无数组、无立方体贴图)，KTX2 不支持超压缩 (Basis / Zstd)。
+// 块压缩格式的尺寸须为块的整数倍；Mip 链不完整时只使用第 0 级；数据不足 (截断) 时打开失败。
+// ----------------------------------------------------------------
+class CompressedTexture {
+public:
+    struct Level {
+        qint64 offset = 0;
+        qint64 size = 0;
+        QSize pixelSize;
+    };
+
+    ~CompressedTexture();
+
+    // 按扩展名判断 (.ktx / .ktx2 / .dds)
+    static bool isTextureFile(const QString &path);
+    // 失败返回 nullptr，error 中给出原因
+    static std::shared_ptr<CompressedTexture> open(const QString &path, QString *error = nullptr);
+
+    QRhiTexture::Format format() const { return m_format; }
+    QRhiTexture::Flags flags() const;
+    QSize size() const { return m_size; }
+    int levelCount() const { return (int)m_levels.size(); }
+    const Level &level(int i) const { return m_levels[i]; }
+
+    // 指向映射内存的只读数据 (不拷贝)，对象存活期间有效
+    QByteArray levelData(int i) const;
+
+    // 各级数据的总字节数
+    qint64 totalBytes() const;
+
+private:
+    CompressedTexture() = default;
+    bool parseKtx(QString *error);
+    bool parseKtx2(QString *error);
+    bool parseDds(QString *error);
+    bool validateLevels(QString *error) const;
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_length = 0;
+
+    QRhiTexture::Format m_format = QRhiTexture::UnknownFormat;
+    bool m_srgb = false;
+    QSize m_size;
+    std::vector<Level> m_levels;
+};
+
+#endif // COMPRESSEDTEXTURE_H
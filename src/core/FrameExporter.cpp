@@ -0,0 +1,328 @@
+#include "FrameExporter.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImage>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+bool ExportSettings::parseFormat(const QString &text, ExportFormat *format)
+{
+    const QString t = text.trimmed().toLower();
+    if (t == "png") *format = ExportFormat::PngSequence;
+    else if (t == "y4m") *format = ExportFormat::Y4m;
+    else if (t == "rgba" || t == "raw") *format = ExportFormat::RawRgba;
+    else return false;
+    return true;
+}
+
+FrameExporter::FrameExporter() = default;
+
+FrameExporter::~FrameExporter()
+{
+    if (m_open) finish();
+}
+
+bool FrameExporter::open(const ExportSettings &settings, QString *error)
+{
+    auto fail = [error](const QString &message) {
+        if (error) *error = message;
+        qWarning() << "[Export]" << message;
+        return false;
+    };
+
+    if (m_open) return fail("Exporter is already open");
+    if (settings.size.isEmpty()) return fail("Export size is empty");
+
+    m_settings = settings;
+    m_settings.ringSize = std::max(1, settings.ringSize);
+    // 在途读回同样占用队列名额，队列至少要能容纳整个环
+    m_settings.maxQueuedFrames = std::max(m_settings.ringSize, settings.maxQueuedFrames);
+    m_nextSequence = 0;
+    m_nextWrite = 0;
+    m_reorder.clear();
+    m_framesWritten = 0;
+    m_bytesWritten = 0;
+    m_peakQueued = 0;
+    m_queued = 0;
+    m_stallNs = 0;
+    m_failed = false;
+
+    if (m_settings.format == ExportFormat::PngSequence) {
+        if (m_settings.output.isEmpty() || m_settings.output == "-")
+            return fail("PNG sequences need an output directory");
+        if (!QDir().mkpath(m_settings.output)) return fail("Cannot create " + m_settings.output);
+    } else {
+        const bool ok = m_settings.output == "-"
+            ? m_stream.open(stdout, QIODevice::WriteOnly)
+            : (m_stream.setFileName(m_settings.output), m_stream.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        if (!ok) return fail("Cannot open " + m_settings.output + ": " + m_stream.errorString());
+
+        if (m_settings.format == ExportFormat::Y4m) {
+            // 帧率写成有理数: 29.97 → 29970:1000
+            const double fps = m_settings.fps > 0.0 ? m_settings.fps : 60.0;
+            const bool integral = std::abs(fps - std::round(fps)) < 1e-6;
+            const QString rate = integral ? QString("%1:1").arg(qint64(std::round(fps)))
+                                          : QString("%1:1000").arg(qint64(std::round(fps * 1000.0)));
+            const QByteArray header = QString("YUV4MPEG2 W%1 H%2 F%3 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n")
+                .arg(m_settings.size.width()).arg(m_settings.size.height()).arg(rate).toLatin1();
+            m_stream.write(header);
+            m_bytesWritten += header.size();
+        }
+    }
+
+    m_pool.setMaxThreadCount(m_settings.encoderThreads > 0 ? m_settings.encoderThreads
+                                                           : std::max(1, QThread::idealThreadCount() - 1));
+    m_queueSlots.acquire(m_queueSlots.available());
+    m_queueSlots.release(m_settings.maxQueuedFrames);
+
+    m_ring.clear();
+    for (int i = 0; i < m_settings.ringSize; ++i) m_ring.push_back(std::make_unique<ReadbackSlot>());
+    m_open = true;
+
+    const qint64 frameBytes = qint64(m_settings.size.width()) * m_settings.size.height() * 4;
+    qDebug() << "[Export] Writing" << m_settings.output << m_settings.size << "ring" << m_settings.ringSize
+             << "queue" << m_settings.maxQueuedFrames << "(" << frameBytes * m_settings.maxQueuedFrames / (1024 * 1024)
+             << "MB max )," << m_pool.maxThreadCount() << "encoder threads";
+    return true;
+}
+
+// ========================================================================
+// 渲染线程: 登记读回
+// ========================================================================
+bool FrameExporter::enqueueReadback(QRhi *rhi, QRhiResourceUpdateBatch *rub, QRhiTexture *texture)
+{
+    if (!m_open || !rhi || !rub || !texture) return false;
+
+    auto anyInFlight = [this]() {
+        return std::any_of(m_ring.begin(), m_ring.end(), [](const auto &s) { return s->inFlight; });
+    };
+
+    // 背压: 编码线程跟不上时在这里等待，而不是无限堆积已读回的帧
+    if (!m_queueSlots.tryAcquire()) {
+        QElapsedTimer stall;
+        stall.start();
+        // 在途的读回也占着名额；流格式按帧序写出，必须先让它们完成，否则可能永远等不到前一帧
+        if (anyInFlight()) rhi->finish();
+        m_queueSlots.acquire();
+        m_stallNs += stall.nsecsElapsed();
+    }
+    const int queued = ++m_queued;
+    int peak = m_peakQueued.load();
+    while (queued > peak && !m_peakQueued.compare_exchange_weak(peak, queued)) {}
+
+    auto findFree = [this]() -> ReadbackSlot * {
+        for (auto &s : m_ring) {
+            if (!s->inFlight) return s.get();
+        }
+        return nullptr;
+    };
+    ReadbackSlot *slot = findFree();
+    if (!slot) {
+        // 环满 (交换链模式下多帧在途): 等 GPU 完成，回调随之触发
+        rhi->finish();
+        slot = findFree();
+    }
+    if (!slot) {
+        qWarning() << "[Export] No free readback slot, frame dropped.";
+        releaseQueued();
+        return false;
+    }
+
+    slot->inFlight = true;
+    slot->sequence = m_nextSequence++;
+    slot->result = QRhiReadbackResult();
+    const bool flipY = rhi->isYUpInFramebuffer();
+    slot->result.completed = [this, slot, flipY]() { handleReadback(slot, flipY); };
+    rub->readBackTexture({ texture }, &slot->result);
+    return true;
+}
+
+void FrameExporter::handleReadback(ReadbackSlot *slot, bool flipY)
+{
+    // 在完成读回的线程 (渲染线程) 上调用: 只转交数据，编码在线程池中进行
+    const QSize size = m_settings.size;
+    QByteArray data = std::move(slot->result.data);
+    const int sequence = slot->sequence;
+    const QSize readSize = slot->result.pixelSize;
+    slot->result.data.clear();
+    slot->inFlight = false;
+
+    int stride = size.width() * 4;
+    if (data.isEmpty()) {
+        // Null 后端等不产生像素数据的情况，写黑帧保持帧数与时间轴一致
+        QImage black(size, QImage::Format_RGBA8888);
+        black.fill(Qt::black);
+        data = QByteArray(reinterpret_cast<const char *>(black.constBits()), black.sizeInBytes());
+        stride = (int)black.bytesPerLine();
+        flipY = false;
+    } else if (readSize != size) {
+        qWarning() << "[Export] Frame" << sequence << "has size" << readSize << ", expected" << size;
+        m_failed = true;
+        if (m_settings.format == ExportFormat::PngSequence) {
+            releaseQueued();
+        } else {
+            writeInOrder(sequence, QByteArray());   // 占位，保持后续帧能按序写出
+        }
+        return;
+    } else {
+        stride = int(data.size() / size.height());
+    }
+
+    m_pool.start([this, sequence, data, stride, flipY]() { encode(sequence, data, stride, flipY); });
+}
+
+// ========================================================================
+// 工作线程: 转换与写出
+// ========================================================================
+void FrameExporter::encode(int sequence, QByteArray rgba, int stride, bool flipY)
+{
+    switch (m_settings.format) {
+    case ExportFormat::PngSequence: {
+        QImage image(reinterpret_cast<const uchar *>(rgba.constData()), m_settings.size.width(),
+                     m_settings.size.height(), stride, QImage::Format_RGBA8888);
+        if (flipY) image = image.mirrored();
+        const QString path = QDir(m_settings.output).filePath(QString("frame_%1.png").arg(sequence, 5, 10, QChar('0')));
+        if (image.save(path, "PNG")) {
+            m_framesWritten++;
+            m_bytesWritten += QFileInfo(path).size();
+        } else {
+            qWarning() << "[Export] Failed to write" << path;
+            m_failed = true;
+        }
+        releaseQueued();
+        break;
+    }
+    case ExportFormat::Y4m:
+        writeInOrder(sequence, toY4mFrame(rgba, m_settings.size, stride, flipY));
+        break;
+    case ExportFormat::RawRgba:
+        writeInOrder(sequence, toRawFrame(rgba, stride, flipY));
+        break;
+    }
+}
+
+void FrameExporter::writeInOrder(int sequence, const QByteArray &payload)
+{
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    m_reorder.emplace(sequence, payload);
+    while (!m_reorder.empty() && m_reorder.begin()->first == m_nextWrite) {
+        const QByteArray &frame = m_reorder.begin()->second;
+        if (!frame.isEmpty()) {
+            if (m_stream.write(frame) != frame.size()) {
+                if (!m_failed) qWarning() << "[Export] Write failed:" << m_stream.errorString();
+                m_failed = true;
+            } else {
+                m_framesWritten++;
+                m_bytesWritten += frame.size();
+            }
+        }
+        m_reorder.erase(m_reorder.begin());
+        m_nextWrite++;
+        releaseQueued();
+    }
+}
+
+QByteArray FrameExporter::toRawFrame(const QByteArray &rgba, int stride, bool flipY) const
+{
+    const int w = m_settings.size.width();
+    const int h = m_settings.size.height();
+    const int rowBytes = w * 4;
+    if (!flipY && stride == rowBytes) return rgba;   // 已是紧密排列，直接写出 (隐式共享，无拷贝)
+
+    QByteArray out(qsizetype(rowBytes) * h, Qt::Uninitialized);
+    for (int y = 0; y < h; ++y) {
+        const int src = flipY ? h - 1 - y : y;
+        std::memcpy(out.data() + qsizetype(y) * rowBytes, rgba.constData() + qsizetype(src) * stride, rowBytes);
+    }
+    return out;
+}
+
+QByteArray FrameExporter::toY4mFrame(const QByteArray &rgba, const QSize &size, int stride, bool flipY)
+{
+    // BT.709 有限范围; 色度按 2x2 取平均 (4:2:0)，奇数尺寸时边缘复制
+    const int w = size.width();
+    const int h = size.height();
+    const int cw = (w + 1) / 2;
+    const int ch = (h + 1) / 2;
+    static const char kFrameTag[] = "FRAME\n";
+    const qsizetype tagSize = sizeof(kFrameTag) - 1;
+
+    QByteArray out(tagSize + qsizetype(w) * h + 2 * qsizetype(cw) * ch, Qt::Uninitialized);
+    std::memcpy(out.data(), kFrameTag, tagSize);
+    uchar *yPlane = reinterpret_cast<uchar *>(out.data()) + tagSize;
+    uchar *uPlane = yPlane + qsizetype(w) * h;
+    uchar *vPlane = uPlane + qsizetype(cw) * ch;
+
+    auto row = [&](int y) {
+        const int src = flipY ? h - 1 - y : y;
+        return reinterpret_cast<const uchar *>(rgba.constData()) + qsizetype(src) * stride;
+    };
+    auto clampByte = [](float v) { return uchar(std::clamp(int(v + 0.5f), 0, 255)); };
+
+    for (int y = 0; y < h; ++y) {
+        const uchar *p = row(y);
+        uchar *dst = yPlane + qsizetype(y) * w;
+        for (int x = 0; x < w; ++x, p += 4)
+            dst[x] = clampByte(16.0f + (219.0f / 255.0f) * (0.2126f * p[0] + 0.7152f * p[1] + 0.0722f * p[2]));
+    }
+
+    for (int cy = 0; cy < ch; ++cy) {
+        const uchar *r0 = row(2 * cy);
+        const uchar *r1 = row(std::min(2 * cy + 1, h - 1));
+        for (int cx = 0; cx < cw; ++cx) {
+            const int x0 = 2 * cx * 4;
+            const int x1 = std::min(2 * cx + 1, w - 1) * 4;
+            float rgb[3];
+            for (int c = 0; c < 3; ++c)
+                rgb[c] = 0.25f * (r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c]);
+            const float k = 224.0f / 255.0f;
+            uPlane[qsizetype(cy) * cw + cx] = clampByte(128.0f + k * (-0.1146f * rgb[0] - 0.3854f * rgb[1] + 0.5f * rgb[2]));
+            vPlane[qsizetype(cy) * cw + cx] = clampByte(128.0f + k * (0.5f * rgb[0] - 0.4542f * rgb[1] - 0.0458f * rgb[2]));
+        }
+    }
+    return out;
+}
+
+void FrameExporter::releaseQueued()
+{
+    m_queued--;
+    m_queueSlots.release();
+}
+
+bool FrameExporter::finish()
+{
+    if (!m_open) return false;
+
+    // 调用方须已结束全部帧 (在途读回都已完成)，这里只等编码线程
+    for (const auto &slot : m_ring) {
+        if (slot->inFlight) {
+            qWarning() << "[Export] Frame" << slot->sequence << "was never read back.";
+            m_failed = true;
+        }
+    }
+    m_pool.waitForDone();
+
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        if (!m_reorder.empty()) {
+            qWarning() << "[Export]" << m_reorder.size() << "frames could not be written in order.";
+            m_failed = true;
+            m_reorder.clear();
+        }
+        if (m_stream.isOpen()) {
+            m_stream.flush();
+            m_stream.close();
+        }
+    }
+    m_ring.clear();
+    m_open = false;
+
+    qDebug() << "[Export] Finished:" << m_framesWritten.load() << "frames," << m_bytesWritten.load() / (1024 * 1024)
+             << "MB, peak queue" << m_peakQueued.load() << ", render thread stalled" << stallMs() << "ms";
+    return !m_failed;
+}
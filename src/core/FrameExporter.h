@@ -0,0 +1,102 @@
+#ifndef FRAMEEXPORTER_H
+#define FRAMEEXPORTER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QSemaphore>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+#include <rhi/qrhi.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// ----------------------------------------------------------------
+// 导出格式
+// - PngSequence: 目录下的 frame_00000.png ...，各帧独立编码，并行写盘
+// - Y4m:         YUV4MPEG2 流 (4:2:0，BT.709 有限范围)，可直接管道给 ffmpeg
+// - RawRgba:     逐帧紧密排列的 RGBA8 (左上角为原点)，无文件头
+// ----------------------------------------------------------------
+enum class ExportFormat { PngSequence, Y4m, RawRgba };
+
+struct ExportSettings {
+    ExportFormat format = ExportFormat::PngSequence;
+    QString output;             // 目录 (PngSequence) 或文件；"-" 为标准输出 (仅流格式)
+    QSize size;
+    double fps = 60.0;          // 写入 Y4M 头
+    int ringSize = 3;           // 同时在途的 GPU 读回数
+    int maxQueuedFrames = 6;    // 已读回、尚未写盘的帧数上限 (内存上限 = 此值 x 每帧字节数)
+    int encoderThreads = 0;     // 0: 自动
+
+    static bool parseFormat(const QString &text, ExportFormat *format);
+};
+
+// ----------------------------------------------------------------
+// FrameExporter: 异步读回 + 工作线程编码的帧导出
+// - 读回请求挂在调用方的资源更新批次上，结果写入一个固定大小的 QRhiReadbackResult 环；
+//   completed 回调 (渲染线程) 只把隐式共享的像素数据交给编码线程，不拷贝、不写盘
+// - 翻转、颜色转换与编码都在线程池中完成；流格式按帧序重排后顺序写出
+// - 队列满时 enqueueReadback 阻塞等待编码线程 (背压)，内存占用有上限
+// ----------------------------------------------------------------
+class FrameExporter {
+public:
+    FrameExporter();
+    ~FrameExporter();
+
+    bool open(const ExportSettings &settings, QString *error = nullptr);
+
+    // 在 rub 中登记 texture 的读回 (RGBA8，尺寸须与设置一致)，随 rub 所在的帧提交
+    // 环中没有空闲槽位时先 QRhi::finish() 让在途读回完成
+    bool enqueueReadback(QRhi *rhi, QRhiResourceUpdateBatch *rub, QRhiTexture *texture);
+
+    // 等待全部帧写出并关闭输出；返回是否全部成功
+    bool finish();
+
+    bool isOpen() const { return m_open; }
+    int framesWritten() const { return m_framesWritten.load(); }
+    int peakQueuedFrames() const { return m_peakQueued.load(); }
+    double stallMs() const { return m_stallNs / 1e6; }   // 渲染线程等待编码队列的累计时间
+    qint64 bytesWritten() const { return m_bytesWritten.load(); }
+
+    // RGBA8 (每行 stride 字节) 转为一帧 Y4M: "FRAME\n" + Y/U/V 三个平面 (4:2:0，BT.709 有限范围)
+    static QByteArray toY4mFrame(const QByteArray &rgba, const QSize &size, int stride, bool flipY);
+
+private:
+    struct ReadbackSlot {
+        QRhiReadbackResult result;
+        bool inFlight = false;
+        int sequence = -1;
+    };
+
+    void handleReadback(ReadbackSlot *slot, bool flipY);
+    void encode(int sequence, QByteArray rgba, int stride, bool flipY);
+    void writeInOrder(int sequence, const QByteArray &payload);
+    QByteArray toRawFrame(const QByteArray &rgba, int stride, bool flipY) const;
+    void releaseQueued();
+
+    ExportSettings m_settings;
+    bool m_open = false;
+    std::vector<std::unique_ptr<ReadbackSlot>> m_ring;
+    int m_nextSequence = 0;
+
+    QThreadPool m_pool;
+    QSemaphore m_queueSlots;            // 剩余可排队的帧数
+    std::atomic<int> m_queued { 0 };
+    std::atomic<int> m_peakQueued { 0 };
+    qint64 m_stallNs = 0;
+
+    // 流输出: 乱序完成的帧按序号暂存，连续时写出
+    std::mutex m_writeMutex;
+    QFile m_stream;
+    std::map<int, QByteArray> m_reorder;
+    int m_nextWrite = 0;
+
+    std::atomic<int> m_framesWritten { 0 };
+    std::atomic<qint64> m_bytesWritten { 0 };
+    std::atomic<bool> m_failed { false };
+};
+
+#endif // FRAMEEXPORTER_H
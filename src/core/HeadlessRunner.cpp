@@ -0,0 +1,216 @@
+#include "HeadlessRunner.h"
+#include "FrameExporter.h"
+#include "ShaderCache.h"
+#include "ShaderCompiler.h"
+#include <QEventLoop>
+#include <QOffscreenSurface>
+#include <QDebug>
+
+HeadlessRunner::HeadlessRunner()
+{
+    // 逐帧输出要求确定性，底图在第一帧之前必须就绪
+    m_renderer.asyncTextureLoads = false;
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+    // 所有 QRhi 资源必须先于 QRhi 释放
+    m_rt.reset();
+    m_rpDesc.reset();
+    m_target.reset();
+    m_renderer.releaseResources();
+    m_rhi.reset();
+    ShaderCache::instance().unpin(m_pinnedShaders);
+}
+
+bool HeadlessRunner::create(const QString &backend, QRhi::Flags flags)
+{
+    if (backend == "null") {
+        QRhiNullInitParams params;
+        m_rhi.reset(QRhi::create(QRhi::Null, &params, flags));
+    } else if (backend == "gl") {
+        m_fallbackSurface.reset(QRhiGles2InitParams::newFallbackSurface());
+        QRhiGles2InitParams params;
+        params.fallbackSurface = m_fallbackSurface.get();
+        m_rhi.reset(QRhi::create(QRhi::OpenGLES2, &params, flags));
+    } else {
+        qWarning() << "[Headless] Unknown backend:" << backend;
+        return false;
+    }
+
+    if (!m_rhi) {
+        qWarning() << "[Headless] Failed to create QRhi for backend" << backend;
+        return false;
+    }
+    qDebug() << "[Headless] QRhi created:" << m_rhi->backendName() << m_rhi->driverInfo().deviceName;
+    return true;
+}
+
+bool HeadlessRunner::setOutputSize(const QSize &size)
+{
+    if (!m_rhi || size.isEmpty()) return false;
+    if (m_target && m_size == size) return true;
+
+    m_rt.reset();
+    m_rpDesc.reset();
+    m_target.reset(m_rhi->newTexture(QRhiTexture::RGBA8, size, 1,
+                                     QRhiTexture::RenderTarget | QRhiTexture::UsedAsTransferSource));
+    if (!m_target->create()) return false;
+
+    m_rt.reset(m_rhi->newTextureRenderTarget({ QRhiColorAttachment(m_target.get()) }));
+    m_rpDesc.reset(m_rt->newCompatibleRenderPassDescriptor());
+    m_rt->setRenderPassDescriptor(m_rpDesc.get());
+    if (!m_rt->create()) return false;
+
+    m_size = size;
+    m_renderer.m_viewportX = 0.0f;
+    m_renderer.m_viewportY = 0.0f;
+    m_renderer.m_viewportW = (float)size.width();
+    m_renderer.m_viewportH = (float)size.height();
+    m_renderer.resizeSettleMs = 0;   // 离屏输出尺寸是显式设置的，不需要等待稳定
+
+    // 上屏 Pass 的渲染通道描述变了，管线需要重建
+    m_renderer.isReset = true;
+    return true;
+}
+
+bool HeadlessRunner::loadProject(const QStringList &shaders, const std::vector<int> &bindOrder,
+                                 const QStringList &textures)
+{
+    if (shaders.isEmpty()) return false;
+
+    // 复用异步编译器，在本地事件循环中等待整批完成
+    ShaderCompiler compiler;
+    QList<ShaderCompileResult> results;
+    QEventLoop loop;
+    QObject::connect(&compiler, &ShaderCompiler::batchFinished, &loop,
+                     [&](int, const QList<ShaderCompileResult> &r) {
+        results = r;
+        // 在批次释放之前 pin 住本次的产物 (失败时下面再 unpin)
+        QStringList produced;
+        for (const ShaderCompileResult &c : r) produced.append(c.qsbPath);
+        ShaderCache::instance().pin(produced);
+        loop.quit();
+    });
+    compiler.compileAll(shaders);
+    loop.exec();
+
+    QStringList qsbPaths;
+    for (const ShaderCompileResult &r : results) qsbPaths.append(r.qsbPath);
+    for (const ShaderCompileResult &r : results) {
+        if (!r.ok()) {
+            qWarning().noquote() << "[Headless] Pass" << r.passIndex << "failed:" << r.sourcePath << "\n" << r.errorMessage;
+            ShaderCache::instance().unpin(qsbPaths);
+            return false;
+        }
+    }
+    ShaderCache::instance().unpin(m_pinnedShaders);
+    m_pinnedShaders = qsbPaths;
+
+    std::vector<int> binds = bindOrder;
+    if (binds.empty()) {
+        for (int i = 0; i < shaders.count(); ++i) binds.push_back(i - 1);
+    }
+
+    m_renderer.loopNum = qsbPaths.count();
+    m_renderer.MyShader = qsbPaths;
+    m_renderer.inputBindOrder = binds;
+    m_renderer.passUsage.clear();
+    for (const ShaderCompileResult &r : results) m_renderer.passUsage.push_back(r.uniformUsage);
+    if (textures.count() >= 3) m_renderer.texUrl = textures;
+    m_renderer.isReset = true;
+    return true;
+}
+
+void HeadlessRunner::applyConfig(const PassConfigSnapshot &config)
+{
+    m_renderer.loopNum = config.loopNum;
+    m_renderer.MyShader = config.shaders;
+    m_renderer.inputBindOrder = config.bindOrder;
+    m_renderer.channelBindings = config.channels;
+    m_renderer.targetSpecs = config.targets;
+    m_renderer.passUsage = config.uniformUsage;
+    m_renderer.texUrl = config.texUrls;
+    m_renderer.isReset = true;
+}
+
+bool HeadlessRunner::renderFrame(const RenderParams &params, QImage *readback)
+{
+    return recordFrame(params, readback, nullptr);
+}
+
+bool HeadlessRunner::exportFrame(const RenderParams &params, FrameExporter &exporter)
+{
+    return recordFrame(params, nullptr, &exporter);
+}
+
+bool HeadlessRunner::renderTile(const RenderParams &params, const QRect &tile, bool renderOffscreen, QImage *readback)
+{
+    if (!m_rhi) return false;
+    m_renderer.setScreenTile(tile, m_rhi->isYUpInFramebuffer());
+    const bool ok = recordFrame(params, readback, nullptr, !renderOffscreen);
+    m_renderer.clearScreenTile();
+    return ok;
+}
+
+bool HeadlessRunner::recordFrame(const RenderParams &params, QImage *readback, FrameExporter *exporter, bool screenOnly)
+{
+    if (!m_rhi || !m_target) return false;
+
+    QRhiCommandBuffer *cb = nullptr;
+    if (m_rhi->beginOffscreenFrame(&cb) != QRhi::FrameOpSuccess) {
+        qWarning() << "[Headless] beginOffscreenFrame failed";
+        return false;
+    }
+
+    m_renderer.setParams(params);
+
+    FrameContext ctx;
+    ctx.rhi = m_rhi.get();
+    ctx.cb = cb;
+    ctx.screenRpDesc = m_rpDesc.get();
+    ctx.dpr = 1.0f;
+    if (screenOnly) {
+        auto *uniforms = m_rhi->nextResourceUpdateBatch();
+        m_renderer.uploadScreenUniforms(uniforms);
+        cb->resourceUpdate(uniforms);
+    } else {
+        m_renderer.executeOffscreen(ctx);
+    }
+
+    QRhiReadbackResult rb;
+    QRhiResourceUpdateBatch *rub = nullptr;
+    bool exportQueued = true;
+    if (readback) {
+        rub = m_rhi->nextResourceUpdateBatch();
+        rub->readBackTexture({ m_target.get() }, &rb);
+    } else if (exporter) {
+        // 读回结果在帧结束时交给导出器，像素转换与编码在其工作线程中完成
+        rub = m_rhi->nextResourceUpdateBatch();
+        if (!exporter->enqueueReadback(m_rhi.get(), rub, m_target.get())) {
+            rub->release();
+            rub = nullptr;
+            exportQueued = false;
+        }
+    }
+
+    cb->beginPass(m_rt.get(), Qt::black, { 1.0f, 0 });
+    m_renderer.executeScreen(cb, { 0, 0, (float)m_size.width(), (float)m_size.height() });
+    cb->endPass(rub);
+
+    // 离屏帧在 endOffscreenFrame 返回时已经执行完毕，读回数据可直接使用
+    m_rhi->endOffscreenFrame();
+
+    if (readback) {
+        if (rb.data.isEmpty()) {
+            // Null 后端等不产生像素数据的情况
+            *readback = QImage(m_size, QImage::Format_RGBA8888);
+            readback->fill(Qt::black);
+            return true;
+        }
+        QImage image(reinterpret_cast<const uchar *>(rb.data.constData()),
+                     rb.pixelSize.width(), rb.pixelSize.height(), QImage::Format_RGBA8888);
+        *readback = m_rhi->isYUpInFramebuffer() ? image.mirrored() : image.copy();
+    }
+    return exportQueued;
+}
@@ -0,0 +1,67 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QSize>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+#include "myrhiitem.h"
+#include "RenderState.h"
+
+class QOffscreenSurface;
+class FrameExporter;
+
+// ----------------------------------------------------------------
+// HeadlessRunner: 不依赖 QQuickWindow 的离屏渲染
+// 自己创建 QRhi (Null 或基于 QOffscreenSurface 的 OpenGL)，
+// 上屏 Pass 画到一张 RGBA8 纹理上并读回，用于批量渲染与 CI。
+// ----------------------------------------------------------------
+class HeadlessRunner {
+public:
+    HeadlessRunner();
+    ~HeadlessRunner();
+
+    // backend: "null" | "gl"
+    bool create(const QString &backend, QRhi::Flags flags = {});
+    bool setOutputSize(const QSize &size);
+
+    // 同步编译并装载工程 (bindOrder 为空时按链式 i-1 绑定)
+    bool loadProject(const QStringList &shaders, const std::vector<int> &bindOrder,
+                     const QStringList &textures = {});
+
+    // 装载一份完整的配置快照 (录制回放: Shader 为已编译的 .qsb，不再编译)
+    void applyConfig(const PassConfigSnapshot &config);
+
+    // 渲染一帧；readback 非空时读回最终画面 (RGBA8，左上角为原点)
+    bool renderFrame(const RenderParams &params, QImage *readback = nullptr);
+
+    // 渲染一帧并把最终画面交给导出器异步读回与编码 (不在渲染线程上转换或写盘)
+    bool exportFrame(const RenderParams &params, FrameExporter &exporter);
+
+    // 分块渲染的一块: 视口为整幅画面，输出目标为一块 (setOutputSize 设为块尺寸)
+    // renderOffscreen 为 false 时沿用本帧已渲染的离屏 Pass，只重画上屏 Pass
+    bool renderTile(const RenderParams &params, const QRect &tile, bool renderOffscreen, QImage *readback);
+
+    QRhi *rhi() const { return m_rhi.get(); }
+    SquircleRenderer &renderer() { return m_renderer; }
+    QSize outputSize() const { return m_size; }
+    QRhiRenderPassDescriptor *screenRenderPassDescriptor() const { return m_rpDesc.get(); }
+
+private:
+    bool recordFrame(const RenderParams &params, QImage *readback, FrameExporter *exporter, bool screenOnly = false);
+
+    std::unique_ptr<QOffscreenSurface> m_fallbackSurface;
+    std::unique_ptr<QRhi> m_rhi;
+    SquircleRenderer m_renderer;
+    QStringList m_pinnedShaders;    // loadProject 编译出的 .qsb，在 ShaderCache 中保持 pin
+
+    QSize m_size;
+    std::unique_ptr<QRhiTexture> m_target;
+    std::unique_ptr<QRhiTextureRenderTarget> m_rt;
+    std::unique_ptr<QRhiRenderPassDescriptor> m_rpDesc;
+};
+
+#endif // HEADLESSRUNNER_H
@@ -0,0 +1,114 @@
+#include "ImageCache.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <QUrl>
+#include <QDebug>
+#include <algorithm>
+
+ImageCache &ImageCache::instance()
+{
+    static ImageCache cache;
+    return cache;
+}
+
+ImageCache::ImageCache()
+{
+    bool ok = false;
+    const int mb = qEnvironmentVariableIntValue("SHADERTOY_IMAGE_CACHE_MB", &ok);
+    if (ok && mb >= 0) m_maxBytes = qint64(mb) * 1024 * 1024;
+}
+
+QString ImageCache::localPath(const QString &path)
+{
+    return path.startsWith("file:") ? QUrl(path).toLocalFile() : path;
+}
+
+QString ImageCache::makeKeyLocked(const QString &path, const QSize &fitSize) const
+{
+    // 修改时间参与 key: 文件在磁盘上被替换 (并 refresh) 后不会命中旧图
+    const QString local = localPath(path);
+    const qint64 mtime = m_mtimes.value(local, -1);
+    return QStringLiteral("%1|%2|%3x%4").arg(local).arg(mtime)
+        .arg(fitSize.isValid() ? fitSize.width() : -1).arg(fitSize.isValid() ? fitSize.height() : -1);
+}
+
+void ImageCache::refresh(const QString &path)
+{
+    const QString local = localPath(path);
+    const QFileInfo info(local);
+    const qint64 mtime = info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mtimes.insert(local, mtime);
+}
+
+QImage ImageCache::find(const QString &path, const QSize &fitSize, bool countStats)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(makeKeyLocked(path, fitSize));
+    if (it == m_index.end()) {
+        if (countStats) m_misses++;
+        return QImage();
+    }
+    m_lru.splice(m_lru.begin(), m_lru, it.value());
+    if (countStats) m_hits++;
+    return m_lru.front().image;
+}
+
+void ImageCache::insert(const QString &path, const QSize &fitSize, const QImage &image)
+{
+    if (image.isNull()) return;
+    const qint64 bytes = image.sizeInBytes();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const QString key = makeKeyLocked(path, fitSize);
+    if (bytes > m_maxBytes) return;     // 单张超过容量上限，不缓存
+
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_totalBytes -= it.value()->image.sizeInBytes();
+        m_lru.erase(it.value());
+        m_index.erase(it);
+    }
+    m_lru.push_front({ key, image });
+    m_index.insert(key, m_lru.begin());
+    m_totalBytes += bytes;
+    evictLocked();
+}
+
+void ImageCache::evictLocked()
+{
+    while (m_totalBytes > m_maxBytes && !m_lru.empty()) {
+        const Entry &victim = m_lru.back();
+        m_totalBytes -= victim.image.sizeInBytes();
+        m_index.remove(victim.key);
+        m_lru.pop_back();
+    }
+}
+
+void ImageCache::setMaxBytes(qint64 bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxBytes = std::max<qint64>(0, bytes);
+    evictLocked();
+}
+
+qint64 ImageCache::maxBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxBytes;
+}
+
+qint64 ImageCache::totalBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_totalBytes;
+}
+
+void ImageCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lru.clear();
+    m_index.clear();
+    m_mtimes.clear();
+    m_totalBytes = 0;
+}
@@ -0,0 +1,62 @@
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include <QHash>
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <atomic>
+#include <list>
+#include <mutex>
+
+// ----------------------------------------------------------------
+// ImageCache: 进程级的已解码图像缓存 (内存 LRU)
+// key = 路径 + 文件修改时间 + 目标尺寸；修改时间由加载线程 refresh() 时读取并记在表中，
+// 查找本身不访问文件系统 (渲染线程上也可直接调用)；目标尺寸无效时存放解码后的原图，
+// 有效时存放裁剪填充好的 RGBA8888 图像，命中后可直接上传。
+// 所有 RhiPingPongItem / 渲染器共用，容量默认 256 MB，
+// 可用环境变量 SHADERTOY_IMAGE_CACHE_MB 或 setMaxBytes() 调整。
+// 所有接口线程安全，可直接在加载线程池中调用。
+// ----------------------------------------------------------------
+class ImageCache {
+public:
+    static ImageCache &instance();
+
+    // fitSize 无效表示原图；文件已修改时 key 不同，旧条目随 LRU 淘汰
+    // countStats 为 false 时不计入命中/未命中 (同一请求内的后续查找)
+    QImage find(const QString &path, const QSize &fitSize = QSize(), bool countStats = true);
+    void insert(const QString &path, const QSize &fitSize, const QImage &image);
+    // 重新读取文件修改时间 (加载线程在读盘前调用)
+    void refresh(const QString &path);
+
+    void setMaxBytes(qint64 bytes);
+    qint64 maxBytes() const;
+    qint64 totalBytes() const;
+    void clear();
+
+    quint64 hits() const { return m_hits.load(); }
+    quint64 misses() const { return m_misses.load(); }
+
+private:
+    ImageCache();
+    static QString localPath(const QString &path);
+    QString makeKeyLocked(const QString &path, const QSize &fitSize) const;
+    void evictLocked();
+
+    struct Entry {
+        QString key;
+        QImage image;
+    };
+
+    std::list<Entry> m_lru;     // 头部为最近使用
+    QHash<QString, std::list<Entry>::iterator> m_index;
+    QHash<QString, qint64> m_mtimes;    // 本地路径 → 最近一次 refresh 读到的修改时间
+    qint64 m_totalBytes = 0;
+    qint64 m_maxBytes = 256 * 1024 * 1024;
+    mutable std::mutex m_mutex;
+
+    std::atomic<quint64> m_hits { 0 };
+    std::atomic<quint64> m_misses { 0 };
+};
+
+#endif // IMAGECACHE_H
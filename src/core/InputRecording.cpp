@@ -0,0 +1,332 @@
+#include "InputRecording.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+constexpr quint32 kMagic = 0x53524543;     // "SREC"
+constexpr quint16 kVersion = 2;             // 2: 增加 Texture 记录 (仍可读取版本 1)
+constexpr quint32 kMaxCount = 1u << 16;     // 读入时的数量上限，防止损坏的文件申请大量内存
+
+enum RecordType : quint8 {
+    ShaderRecord = 1,
+    ConfigRecord = 2,
+    FrameRecord = 3,
+    TextureRecord = 4
+};
+
+// QML 传入的可能是 file:// URL
+QString localPath(const QString &path)
+{
+    const QString local = QUrl(path).toLocalFile();
+    return local.isEmpty() ? path : local;
+}
+
+// Qt 资源随程序一起发布，回放端一定存在，无需内嵌
+bool isResourcePath(const QString &path)
+{
+    return path.startsWith(QLatin1Char(':')) || path.startsWith(QLatin1String("qrc:"));
+}
+
+void setupStream(QDataStream &s)
+{
+    s.setVersion(QDataStream::Qt_6_5);
+    s.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
+
+// ----------------------------------------------------------------
+// 序列化
+// ----------------------------------------------------------------
+void writeParams(QDataStream &s, const RenderParams &p)
+{
+    s << p.time << p.timeDelta << qint32(p.frame) << qint32(p.simulationSteps) << p.screenSize
+      << p.mousePos << p.mousePressOrigin << p.isPressed << p.date
+      << p.accumulate << qint32(p.sampleBudget) << p.convergenceThreshold << p.accumulationEpoch;
+}
+
+void readParams(QDataStream &s, RenderParams &p)
+{
+    qint32 frame = 0, steps = 0, budget = 0;
+    s >> p.time >> p.timeDelta >> frame >> steps >> p.screenSize
+      >> p.mousePos >> p.mousePressOrigin >> p.isPressed >> p.date
+      >> p.accumulate >> budget >> p.convergenceThreshold >> p.accumulationEpoch;
+    p.frame = frame;
+    p.simulationSteps = steps;
+    p.sampleBudget = budget;
+}
+
+void writeConfig(QDataStream &s, const PassConfigSnapshot &c)
+{
+    s << qint32(c.loopNum) << c.shaders;
+    s << quint32(c.bindOrder.size());
+    for (int v : c.bindOrder) s << qint32(v);
+    s << quint32(c.channels.size());
+    for (const PassChannels &pass : c.channels) {
+        for (const ChannelInput &in : pass)
+            s << quint8(in.source) << qint32(in.index) << quint8(in.filter) << quint8(in.wrap);
+    }
+    s << quint32(c.targets.size());
+    for (const PassTarget &t : c.targets) s << t.scale << t.fixedSize << quint8(t.format);
+    s << quint32(c.uniformUsage.size());
+    for (quint32 u : c.uniformUsage) s << u;
+    s << c.texUrls;
+}
+
+bool readConfig(QDataStream &s, PassConfigSnapshot &c)
+{
+    qint32 loopNum = 0;
+    quint32 count = 0;
+    s >> loopNum >> c.shaders;
+    c.loopNum = loopNum;
+
+    s >> count;
+    if (count > kMaxCount) return false;
+    c.bindOrder.resize(count);
+    for (int &v : c.bindOrder) { qint32 x = 0; s >> x; v = x; }
+
+    s >> count;
+    if (count > kMaxCount) return false;
+    c.channels.resize(count);
+    for (PassChannels &pass : c.channels) {
+        for (ChannelInput &in : pass) {
+            quint8 source = 0, filter = 0, wrap = 0;
+            qint32 index = 0;
+            s >> source >> index >> filter >> wrap;
+            in.source = ChannelSource(source);
+            in.index = index;
+            in.filter = ChannelFilter(filter);
+            in.wrap = ChannelWrap(wrap);
+        }
+    }
+
+    s >> count;
+    if (count > kMaxCount) return false;
+    c.targets.resize(count);
+    for (PassTarget &t : c.targets) {
+        quint8 format = 0;
+        s >> t.scale >> t.fixedSize >> format;
+        t.format = PassFormat(format);
+    }
+
+    s >> count;
+    if (count > kMaxCount) return false;
+    c.uniformUsage.resize(count);
+    for (quint32 &u : c.uniformUsage) s >> u;
+    s >> c.texUrls;
+    return s.status() == QDataStream::Ok;
+}
+}
+
+// ========================================================================
+// InputRecorder
+// ========================================================================
+bool InputRecorder::open(const QString &path, QString *error)
+{
+    close();
+    m_file.setFileName(localPath(path));
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+    m_stream.setDevice(&m_file);
+    setupStream(m_stream);
+    m_stream << kMagic << kVersion;
+    m_embeddedShaders.clear();
+    m_embeddedTextures.clear();
+    m_frames = 0;
+    qDebug() << "[Record] Recording to" << m_file.fileName();
+    return true;
+}
+
+void InputRecorder::close()
+{
+    if (!m_file.isOpen()) return;
+    m_stream.setDevice(nullptr);
+    m_file.close();
+    qDebug() << "[Record] Stopped," << m_frames << "frames," << m_file.size() << "bytes";
+}
+
+void InputRecorder::recordConfig(const PassConfigSnapshot &config)
+{
+    if (!isOpen()) return;
+    // 先写出尚未内嵌的 .qsb，回放端读到配置时它们已经就绪
+    for (const QString &shader : config.shaders) {
+        if (shader.isEmpty() || m_embeddedShaders.contains(shader)) continue;
+        QFile file(shader);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "[Record] Cannot embed shader" << shader << file.errorString();
+            continue;
+        }
+        m_stream << quint8(ShaderRecord) << shader << file.readAll();
+        m_embeddedShaders.insert(shader);
+    }
+    // 通道贴图同样内嵌 (原始文件，解码由回放端完成)；空路径与程序内置的资源不需要
+    for (const QString &texture : config.texUrls) {
+        if (texture.isEmpty() || isResourcePath(texture) || m_embeddedTextures.contains(texture)) continue;
+        QFile file(localPath(texture));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "[Record] Cannot embed texture" << texture << file.errorString();
+            continue;
+        }
+        m_stream << quint8(TextureRecord) << texture << file.readAll();
+        m_embeddedTextures.insert(texture);
+    }
+    m_stream << quint8(ConfigRecord);
+    writeConfig(m_stream, config);
+}
+
+void InputRecorder::recordFrame(const FrameSnapshot &frame, const FrameTiming &timing)
+{
+    if (!isOpen()) return;
+    m_stream << quint8(FrameRecord) << frame.viewport;
+    writeParams(m_stream, frame.params);
+    m_stream << float(timing.frameMs) << float(timing.gpuMs);
+    m_frames++;
+}
+
+// ========================================================================
+// InputReplayer
+// ========================================================================
+bool InputReplayer::open(const QString &path, QString *error)
+{
+    auto fail = [error](const QString &message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    QFile file(localPath(path));
+    if (!file.open(QIODevice::ReadOnly)) return fail(file.errorString());
+    QDataStream in(&file);
+    setupStream(in);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != kMagic) return fail(QStringLiteral("not an input recording"));
+    if (version < 1 || version > kVersion) return fail(QStringLiteral("unsupported recording version %1").arg(version));
+
+    m_configs.clear();
+    m_frames.clear();
+    m_replayed.clear();
+    m_extractDir = std::make_unique<QTemporaryDir>();
+    if (!m_extractDir->isValid()) return fail(QStringLiteral("cannot create a temporary directory"));
+    QHash<QString, QString> shaders;        // 录制时的路径 → 解出的文件
+    QHash<QString, QString> textures;
+
+    while (!in.atEnd()) {
+        quint8 type = 0;
+        in >> type;
+        if (type == ShaderRecord || type == TextureRecord) {
+            QString original;
+            QByteArray bytes;
+            in >> original >> bytes;
+            if (in.status() != QDataStream::Ok) break;      // 录制被中断: 不完整的文件不写出
+            // 保留原文件名 (贴图按扩展名识别格式)；序号避免不同目录下的重名
+            QHash<QString, QString> &extracted = type == ShaderRecord ? shaders : textures;
+            const QString target = m_extractDir->filePath(
+                QStringLiteral("%1_%2").arg(shaders.size() + textures.size()).arg(QFileInfo(localPath(original)).fileName()));
+            QFile out(target);
+            if (!out.open(QIODevice::WriteOnly) || out.write(bytes) != bytes.size())
+                return fail(QStringLiteral("cannot extract %1").arg(original));
+            extracted.insert(original, target);
+        } else if (type == ConfigRecord) {
+            PassConfigSnapshot config;
+            if (!readConfig(in, config)) return fail(QStringLiteral("corrupt configuration record"));
+            for (QString &shader : config.shaders)
+                shader = shaders.value(shader, shader);
+            for (QString &texture : config.texUrls) {
+                if (texture.isEmpty() || isResourcePath(texture)) continue;
+                auto it = textures.constFind(texture);
+                if (it != textures.constEnd()) {
+                    texture = it.value();
+                } else if (!QFileInfo::exists(localPath(texture))) {
+                    // 录制时未能内嵌且本机也没有: 回放结果不可能与录制一致，直接失败
+                    return fail(QStringLiteral("texture %1 is neither embedded nor available").arg(texture));
+                }
+            }
+            config.version = m_configs.size() + 1;
+            m_configs.push_back(std::move(config));
+        } else if (type == FrameRecord) {
+            RecordedFrame frame;
+            frame.config = (int)m_configs.size() - 1;
+            float frameMs = 0.0f, gpuMs = 0.0f;
+            in >> frame.frame.viewport;
+            readParams(in, frame.frame.params);
+            in >> frameMs >> gpuMs;
+            frame.recorded = { frameMs, gpuMs };
+            if (in.status() != QDataStream::Ok) break;     // 录制被中断: 保留完整的帧
+            m_frames.push_back(frame);
+        } else {
+            return fail(QStringLiteral("unknown record type %1").arg(type));
+        }
+    }
+
+    if (m_frames.empty()) return fail(QStringLiteral("recording contains no frames"));
+    if (m_frames.front().config < 0) return fail(QStringLiteral("recording starts without a configuration"));
+    m_replayed.resize(m_frames.size());
+    m_next = 0;
+    m_currentConfig = -1;
+    qDebug() << "[Replay] Loaded" << m_frames.size() << "frames," << m_configs.size() << "configurations,"
+             << shaders.size() << "shaders," << textures.size() << "textures";
+    return true;
+}
+
+const RecordedFrame &InputReplayer::next(const PassConfigSnapshot **config)
+{
+    const RecordedFrame &frame = m_frames[m_next++];
+    *config = nullptr;
+    if (frame.config != m_currentConfig) {
+        m_currentConfig = frame.config;
+        *config = &m_configs[frame.config];
+    }
+    return frame;
+}
+
+void InputReplayer::recordTiming(int frame, const FrameTiming &timing)
+{
+    if (frame >= 0 && frame < (int)m_replayed.size()) m_replayed[frame] = timing;
+}
+
+bool InputReplayer::dumpTimingsCsv(const QString &path) const
+{
+    QFile file(localPath(path));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+        return false;
+
+    QTextStream out(&file);
+    out << "frame,recorded_sync_interval_ms,replay_" << m_replayMetric << "_ms,recorded_gpu_ms,replay_gpu_ms\n";
+    for (size_t i = 0; i < m_frames.size(); ++i) {
+        out << i << ',' << m_frames[i].recorded.frameMs << ',' << m_replayed[i].frameMs << ','
+            << m_frames[i].recorded.gpuMs << ',' << m_replayed[i].gpuMs << '\n';
+    }
+    return true;
+}
+
+double InputReplayer::percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const size_t index = std::min(values.size() - 1, size_t(std::clamp(p, 0.0, 1.0) * double(values.size() - 1) + 0.5));
+    return values[index];
+}
+
+QString InputReplayer::summary() const
+{
+    std::vector<double> recorded, replayed;
+    double recordedSum = 0.0, replayedSum = 0.0;
+    for (size_t i = 0; i < m_frames.size(); ++i) {
+        recorded.push_back(m_frames[i].recorded.frameMs);
+        replayed.push_back(m_replayed[i].frameMs);
+        recordedSum += m_frames[i].recorded.frameMs;
+        replayedSum += m_replayed[i].frameMs;
+    }
+    const double n = std::max<double>(1.0, double(m_frames.size()));
+    return QStringLiteral("frames=%1 recorded_sync_interval_avg_ms=%2 recorded_sync_interval_p95_ms=%3 "
+                          "replay_%6_avg_ms=%4 replay_%6_p95_ms=%5")
+        .arg(m_frames.size())
+        .arg(recordedSum / n, 0, 'f', 3).arg(percentile(recorded, 0.95), 0, 'f', 3)
+        .arg(replayedSum / n, 0, 'f', 3).arg(percentile(replayed, 0.95), 0, 'f', 3)
+        .arg(m_replayMetric);
+}
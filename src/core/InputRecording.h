@@ -0,0 +1,98 @@
+#ifndef INPUTRECORDING_H
+#define INPUTRECORDING_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QTemporaryDir>
+#include <memory>
+#include <vector>
+#include "RenderState.h"
+
+// ----------------------------------------------------------------
+// 输入录制文件 (.srec)
+// QDataStream 二进制流，浮点按单精度写入:
+//   头:   magic "SREC" + 版本号
+//   记录: quint8 类型 + 内容，按发生顺序排列
+//     Shader: .qsb 路径 + 文件内容 (每个路径只写一次，回放不依赖本机的 Shader 缓存)
+//     Texture: 通道贴图路径 + 原始文件内容 (同上；Qt 资源中的内置贴图不写入)
+//     Config: 完整的 PassConfigSnapshot，从下一条 Frame 起生效
+//     Frame:  视口 + RenderParams + 录制时测得的耗时，每帧约 90 字节
+// ----------------------------------------------------------------
+struct FrameTiming {
+    double frameMs = 0.0;   // 相邻两次 sync 的间隔，受垂直同步限制 (无头回放: 一帧渲染与读回的耗时)
+    double gpuMs = 0.0;     // 最近一次完成的 GPU 帧耗时 (不支持时间戳时为 0)
+};
+
+struct RecordedFrame {
+    int config = -1;        // 生效的配置 (InputReplayer::config 的下标)
+    FrameSnapshot frame;
+    FrameTiming recorded;
+};
+
+// ----------------------------------------------------------------
+// InputRecorder: 逐帧写入录制文件，写入都经过 QFile 的缓冲
+// ----------------------------------------------------------------
+class InputRecorder {
+public:
+    ~InputRecorder() { close(); }
+
+    bool open(const QString &path, QString *error = nullptr);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    void recordConfig(const PassConfigSnapshot &config);
+    void recordFrame(const FrameSnapshot &frame, const FrameTiming &timing);
+    int framesRecorded() const { return m_frames; }
+
+private:
+    QFile m_file;
+    QDataStream m_stream;
+    QSet<QString> m_embeddedShaders;
+    QSet<QString> m_embeddedTextures;
+    int m_frames = 0;
+};
+
+// ----------------------------------------------------------------
+// InputReplayer: 读入整个录制文件，逐帧取出，并记录回放时的耗时
+// 录制中内嵌的 .qsb 与贴图解到临时目录，配置中的路径指向解出的文件；
+// 贴图既未内嵌、本机也不存在时 open() 失败
+// ----------------------------------------------------------------
+class InputReplayer {
+public:
+    bool open(const QString &path, QString *error = nullptr);
+
+    int frameCount() const { return (int)m_frames.size(); }
+    int position() const { return m_next; }
+    bool atEnd() const { return m_next >= (int)m_frames.size(); }
+
+    // 取出下一帧；这一帧起生效的新配置写入 *config (配置不变时为 nullptr)
+    const RecordedFrame &next(const PassConfigSnapshot **config);
+    const PassConfigSnapshot &config(int index) const { return m_configs[index]; }
+
+    // 第 frame 帧回放时测得的耗时
+    void recordTiming(int frame, const FrameTiming &timing);
+    // 回放耗时的含义，用于 CSV 列名与汇总: 窗口回放为 "sync_interval"，无头回放为 "render_readback"
+    void setReplayMetric(const QString &metric) { m_replayMetric = metric; }
+    // frame,recorded_sync_interval_ms,replay_<metric>_ms,recorded_gpu_ms,replay_gpu_ms
+    bool dumpTimingsCsv(const QString &path) const;
+    // 录制与回放耗时的汇总 (平均 / P95)
+    QString summary() const;
+
+    // 最近秩百分位 (p 取 0-1)，空数组返回 0
+    static double percentile(std::vector<double> values, double p);
+
+private:
+    std::vector<PassConfigSnapshot> m_configs;
+    std::vector<RecordedFrame> m_frames;
+    std::vector<FrameTiming> m_replayed;
+    std::unique_ptr<QTemporaryDir> m_extractDir;
+    QString m_replayMetric = QStringLiteral("sync_interval");
+    int m_next = 0;
+    int m_currentConfig = -1;
+};
+
+#endif // INPUTRECORDING_H
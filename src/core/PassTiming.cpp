@@ -0,0 +1,169 @@
+#include "PassTiming.h"
+#include <QFile>
+#include <QTextStream>
+#include <QUrl>
+#include <algorithm>
+
+// ========================================================================
+// PassTimingStats
+// ========================================================================
+void PassTimingStats::Series::push(double v, int window)
+{
+    if ((int)values.size() < window) {
+        values.push_back(v);
+    } else {
+        values[next] = v;
+        next = (next + 1) % values.size();
+    }
+}
+
+PassTimingRow PassTimingStats::Series::stats() const
+{
+    PassTimingRow row;
+    if (values.empty()) return row;
+
+    std::vector<double> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for (double v : sorted) sum += v;
+
+    auto percentile = [&sorted](double p) {
+        const size_t idx = std::min(sorted.size() - 1, (size_t)(p * (sorted.size() - 1) + 0.5));
+        return sorted[idx];
+    };
+
+    row.samples = (int)sorted.size();
+    row.avgMs = sum / sorted.size();
+    row.minMs = sorted.front();
+    row.maxMs = sorted.back();
+    row.p50Ms = percentile(0.50);
+    row.p95Ms = percentile(0.95);
+    return row;
+}
+
+void PassTimingStats::reset(int passCount)
+{
+    m_cpu.assign(std::max(0, passCount), Series());
+    m_gpu = Series();
+}
+
+void PassTimingStats::recordCpu(int passIndex, double ms)
+{
+    if (passIndex < 0) return;
+    if (passIndex >= (int)m_cpu.size()) m_cpu.resize(passIndex + 1);
+    m_cpu[passIndex].push(ms, m_window);
+}
+
+void PassTimingStats::recordGpuFrame(double ms)
+{
+    // 后端不支持时间戳时返回 0，不计入
+    m_lastGpuMs = std::max(ms, 0.0);
+    if (ms <= 0.0) return;
+    m_gpu.push(ms, m_window);
+}
+
+QList<PassTimingRow> PassTimingStats::snapshot() const
+{
+    QList<PassTimingRow> rows;
+    for (size_t i = 0; i < m_cpu.size(); ++i) {
+        PassTimingRow row = m_cpu[i].stats();
+        row.passIndex = (int)i;
+        row.kind = QStringLiteral("cpu");
+        rows.append(row);
+    }
+    PassTimingRow gpu = m_gpu.stats();
+    gpu.passIndex = -1;
+    gpu.kind = QStringLiteral("gpu");
+    rows.append(gpu);
+    return rows;
+}
+
+// ========================================================================
+// PassTimingModel
+// ========================================================================
+int PassTimingModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+QString PassTimingModel::nameFor(const PassTimingRow &row) const
+{
+    if (row.passIndex < 0) return QStringLiteral("GPU (frame)");
+    QString name = QStringLiteral("Pass %1").arg(row.passIndex);
+    if (row.passIndex < m_passNames.size())
+        name += QStringLiteral(" (%1)").arg(m_passNames[row.passIndex]);
+    return name;
+}
+
+QVariant PassTimingModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) return QVariant();
+    const PassTimingRow &row = m_rows[index.row()];
+    switch (role) {
+    case NameRole: return nameFor(row);
+    case KindRole: return row.kind;
+    case AvgRole: return row.avgMs;
+    case MinRole: return row.minMs;
+    case MaxRole: return row.maxMs;
+    case P50Role: return row.p50Ms;
+    case P95Role: return row.p95Ms;
+    case SamplesRole: return row.samples;
+    default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> PassTimingModel::roleNames() const
+{
+    return {
+        { NameRole, "name" },
+        { KindRole, "kind" },
+        { AvgRole, "avgMs" },
+        { MinRole, "minMs" },
+        { MaxRole, "maxMs" },
+        { P50Role, "p50Ms" },
+        { P95Role, "p95Ms" },
+        { SamplesRole, "samples" }
+    };
+}
+
+void PassTimingModel::setRows(const QList<PassTimingRow> &rows)
+{
+    if (rows.size() != m_rows.size()) {
+        beginResetModel();
+        m_rows = rows;
+        endResetModel();
+        return;
+    }
+    m_rows = rows;
+    if (!m_rows.isEmpty())
+        emit dataChanged(index(0), index(m_rows.size() - 1));
+}
+
+void PassTimingModel::setPassNames(const QStringList &names)
+{
+    m_passNames = names;
+    if (!m_rows.isEmpty())
+        emit dataChanged(index(0), index(m_rows.size() - 1), { NameRole });
+}
+
+bool PassTimingModel::dumpCsv(const QString &filePath) const
+{
+    QString localPath = QUrl(filePath).toLocalFile();
+    if (localPath.isEmpty()) localPath = filePath;
+
+    QFile file(localPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+        return false;
+
+    QTextStream out(&file);
+    out << "pass,name,kind,samples,avg_ms,min_ms,max_ms,p50_ms,p95_ms\n";
+    for (const PassTimingRow &row : m_rows) {
+        QString name = nameFor(row);
+        name.replace('"', "\"\"");
+        out << row.passIndex << ",\"" << name << "\"," << row.kind << ',' << row.samples << ','
+            << row.avgMs << ',' << row.minMs << ',' << row.maxMs << ','
+            << row.p50Ms << ',' << row.p95Ms << '\n';
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef PASSTIMING_H
+#define PASSTIMING_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+// ----------------------------------------------------------------
+// 一行统计结果 (单位 ms)
+// kind: "cpu" 为单个 Pass 的命令录制耗时，"gpu" 为整帧 GPU 耗时
+// QRhi 只提供整个命令缓冲的 GPU 时间戳 (lastCompletedGpuTime)，无法细分到 Pass
+// ----------------------------------------------------------------
+struct PassTimingRow {
+    int passIndex = -1;         // -1 表示整帧
+    QString kind;
+    double avgMs = 0.0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    int samples = 0;
+};
+
+// ----------------------------------------------------------------
+// PassTimingStats: 渲染线程内的滑动窗口采样，不加锁，只在渲染线程使用
+// ----------------------------------------------------------------
+class PassTimingStats {
+public:
+    explicit PassTimingStats(int window = 240) : m_window(window) {}
+
+    void reset(int passCount);
+    void recordCpu(int passIndex, double ms);
+    void recordGpuFrame(double ms);
+    // 最近一次完成的 GPU 帧耗时 (不支持时间戳时为 0)，供录制/回放逐帧记录
+    double lastGpuFrameMs() const { return m_lastGpuMs; }
+
+    QList<PassTimingRow> snapshot() const;
+
+private:
+    struct Series {
+        std::vector<double> values;
+        size_t next = 0;
+        void push(double v, int window);
+        PassTimingRow stats() const;
+    };
+
+    int m_window;
+    std::vector<Series> m_cpu;
+    Series m_gpu;
+    double m_lastGpuMs = 0.0;
+};
+
+// ----------------------------------------------------------------
+// PassTimingModel: 暴露给 QML 的统计模型 (GUI 线程)
+// ----------------------------------------------------------------
+class PassTimingModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        KindRole,
+        AvgRole,
+        MinRole,
+        MaxRole,
+        P50Role,
+        P95Role,
+        SamplesRole
+    };
+
+    explicit PassTimingModel(QObject *parent = nullptr) : QAbstractListModel(parent) {}
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void setRows(const QList<PassTimingRow> &rows);
+    void setPassNames(const QStringList &names);
+
+    bool dumpCsv(const QString &filePath) const;
+
+private:
+    QString nameFor(const PassTimingRow &row) const;
+
+    QList<PassTimingRow> m_rows;
+    QStringList m_passNames;
+};
+
+#endif // PASSTIMING_H
@@ -0,0 +1,166 @@
+#include "PipelineCacheStore.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+#include <rhi/qrhi.h>
+
+// 文件头: 修改布局时递增 kFormatVersion，旧文件会被自动丢弃
+static const quint32 kMagic = 0x53545043; // 'STPC'
+static const quint32 kFormatVersion = 1;
+
+namespace {
+
+struct CacheHeader {
+    quint32 magic = 0;
+    quint32 formatVersion = 0;
+    QString qtVersion;
+    qint32 backend = 0;
+    QByteArray deviceName;
+    quint64 deviceId = 0;
+    quint64 vendorId = 0;
+    qint64 coldBuildNs = 0;
+    QByteArray blobHash;
+};
+
+CacheHeader headerFor(QRhi *rhi)
+{
+    const QRhiDriverInfo info = rhi->driverInfo();
+    CacheHeader h;
+    h.magic = kMagic;
+    h.formatVersion = kFormatVersion;
+    h.qtVersion = QLatin1String(qVersion());
+    h.backend = int(rhi->backend());
+    h.deviceName = info.deviceName;
+    h.deviceId = info.deviceId;
+    h.vendorId = info.vendorId;
+    return h;
+}
+
+} // namespace
+
+PipelineCacheStore &PipelineCacheStore::instance()
+{
+    static PipelineCacheStore store;
+    return store;
+}
+
+QString PipelineCacheStore::filePath()
+{
+    return QCoreApplication::applicationDirPath() + "/pipelinecache/pipeline.cache";
+}
+
+QString PipelineCacheStore::qtDumpFilePath()
+{
+    return QCoreApplication::applicationDirPath() + "/pipelinecache/pipeline.qtraw";
+}
+
+bool PipelineCacheStore::load(QRhi *rhi)
+{
+    if (!rhi) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // 上次退出时 Qt 写出的原始数据，仅是开关的副产物
+    QFile::remove(qtDumpFilePath());
+
+    QFile f(filePath());
+    if (!f.open(QIODevice::ReadOnly)) {
+        qDebug() << "[PipelineCache] No cache file, cold start.";
+        return false;
+    }
+
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    CacheHeader h;
+    QByteArray blob;
+    in >> h.magic >> h.formatVersion;
+    if (h.magic == kMagic && h.formatVersion == kFormatVersion) {
+        in >> h.qtVersion >> h.backend >> h.deviceName >> h.deviceId >> h.vendorId
+           >> h.coldBuildNs >> h.blobHash >> blob;
+    }
+    f.close();
+
+    const CacheHeader expected = headerFor(rhi);
+    QString reason;
+    if (in.status() != QDataStream::Ok)
+        reason = "truncated";
+    else if (h.magic != kMagic || h.formatVersion != kFormatVersion)
+        reason = "format version mismatch";
+    else if (h.qtVersion != expected.qtVersion)
+        reason = "Qt version mismatch";
+    else if (h.backend != expected.backend || h.deviceName != expected.deviceName
+             || h.deviceId != expected.deviceId || h.vendorId != expected.vendorId)
+        reason = "device/driver mismatch";
+    else if (QCryptographicHash::hash(blob, QCryptographicHash::Sha1) != h.blobHash)
+        reason = "checksum mismatch";
+
+    if (!reason.isEmpty()) {
+        qWarning() << "[PipelineCache] Discarding" << filePath() << ":" << reason;
+        QFile::remove(filePath());
+        return false;
+    }
+
+    rhi->setPipelineCacheData(blob);
+    m_loaded = true;
+    m_coldBuildNs = h.coldBuildNs;
+    qDebug() << "[PipelineCache] Loaded" << blob.size() << "bytes for" << rhi->backendName()
+             << expected.deviceName;
+    return true;
+}
+
+bool PipelineCacheStore::save(QRhi *rhi)
+{
+    if (!rhi) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const QByteArray blob = rhi->pipelineCacheData();
+    if (blob.isEmpty()) {
+        qDebug() << "[PipelineCache] Backend returned no cache data, nothing saved.";
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(filePath()).absolutePath());
+    QSaveFile f(filePath());
+    if (!f.open(QIODevice::WriteOnly)) return false;
+
+    CacheHeader h = headerFor(rhi);
+    h.coldBuildNs = m_coldBuildNs;
+    h.blobHash = QCryptographicHash::hash(blob, QCryptographicHash::Sha1);
+
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << h.magic << h.formatVersion << h.qtVersion << h.backend << h.deviceName
+        << h.deviceId << h.vendorId << h.coldBuildNs << h.blobHash << blob;
+
+    if (!f.commit()) return false;
+    qDebug() << "[PipelineCache] Saved" << blob.size() << "bytes to" << filePath();
+    return true;
+}
+
+void PipelineCacheStore::recordPipelineBuild(int count, qint64 nsecs)
+{
+    if (count <= 0) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_totalPipelines += count;
+    m_totalBuildNs += nsecs;
+
+    if (m_firstBuildReported) return;
+    m_firstBuildReported = true;
+
+    const double ms = nsecs / 1e6;
+    if (!m_loaded || m_coldBuildNs <= 0) {
+        // 冷启动: 记为基线，随缓存一起保存
+        m_coldBuildNs = nsecs;
+        qDebug() << "[PipelineCache] First build (cold):" << count << "pipelines in" << ms << "ms";
+    } else {
+        const double coldMs = m_coldBuildNs / 1e6;
+        qDebug() << "[PipelineCache] First build (warm):" << count << "pipelines in" << ms
+                 << "ms, cold baseline" << coldMs << "ms, saved" << (coldMs - ms) << "ms";
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef PIPELINECACHESTORE_H
+#define PIPELINECACHESTORE_H
+
+#include <QByteArray>
+#include <QString>
+#include <mutex>
+
+class QRhi;
+
+// ----------------------------------------------------------------
+// PipelineCacheStore: QRhi 管线缓存的持久化
+// 退出时保存 QRhi::pipelineCacheData()，启动时在创建任何管线之前加载。
+// 文件带格式版本、Qt 版本、后端与设备/驱动信息以及内容校验，
+// 任意一项不匹配或数据损坏都直接丢弃，不会交给驱动。
+// 同时统计管线创建耗时，用于对比冷启动与命中缓存时节省的时间。
+// ----------------------------------------------------------------
+class PipelineCacheStore {
+public:
+    static PipelineCacheStore &instance();
+
+    static QString filePath();
+    // Qt Quick 只有在指定保存路径时才会以 EnablePipelineCacheDataSave 创建 QRhi，
+    // 该路径仅用于打开这个开关，Qt 写出的原始数据不带校验信息，不会被读取
+    static QString qtDumpFilePath();
+
+    // 渲染线程调用，QRhi 必须有效
+    bool load(QRhi *rhi);
+    bool save(QRhi *rhi);
+
+    // 记录一次管线构建 (count 条管线共耗时 nsecs)，首次构建时输出对比统计
+    void recordPipelineBuild(int count, qint64 nsecs);
+
+private:
+    PipelineCacheStore() = default;
+
+    std::mutex m_mutex;
+    bool m_loaded = false;          // 本次运行是否成功加载了缓存
+    bool m_firstBuildReported = false;
+    qint64 m_coldBuildNs = 0;       // 无缓存时首次构建的耗时 (随文件持久化)
+    qint64 m_totalBuildNs = 0;
+    int m_totalPipelines = 0;
+};
+
+#endif // PIPELINECACHESTORE_H
@@ -0,0 +1,139 @@
+#include "RenderGraph.h"
+#include <QDebug>
+#include <algorithm>
+
+static const int kTextureCount = 3;
+
+RenderGraphPlan RenderGraph::build(const std::vector<PassChannels> &channels)
+{
+    RenderGraphPlan plan;
+    const int count = (int)channels.size();
+    if (count == 0) return plan;
+    const int screen = count - 1;
+
+    // 1. 规范化: 越界或指向上屏 Pass 的引用置空，读取自身视为读取上一帧
+    plan.channels = channels;
+    for (int p = 0; p < count; ++p) {
+        for (int c = 0; c < kMaxChannels; ++c) {
+            ChannelInput &in = plan.channels[p][c];
+            switch (in.source) {
+            case ChannelSource::Pass:
+            case ChannelSource::PreviousFrame:
+                if (in.index < 0 || in.index >= count || in.index == screen) {
+                    qDebug() << "[Graph] Pass" << p << "channel" << c << "references invalid pass" << in.index << ", unbound.";
+                    in = ChannelInput();
+                } else if (in.source == ChannelSource::Pass && in.index == p) {
+                    in.source = ChannelSource::PreviousFrame;
+                }
+                break;
+            case ChannelSource::Texture:
+                if (in.index < 0 || in.index >= kTextureCount) in = ChannelInput();
+                break;
+            case ChannelSource::None:
+                in.index = -1;
+                break;
+            }
+        }
+    }
+
+    // 2. 存活性: 从上屏 Pass 沿所有输入 (含上一帧) 反向遍历
+    plan.alive.assign(count, false);
+    std::vector<int> stack = { screen };
+    plan.alive[screen] = true;
+    while (!stack.empty()) {
+        const int p = stack.back();
+        stack.pop_back();
+        for (const ChannelInput &in : plan.channels[p]) {
+            if (in.source != ChannelSource::Pass && in.source != ChannelSource::PreviousFrame) continue;
+            if (!plan.alive[in.index]) {
+                plan.alive[in.index] = true;
+                stack.push_back(in.index);
+            }
+        }
+    }
+
+    // 被读取上一帧的存活 Pass 需要双缓冲，避免读写同一张纹理
+    plan.feedback.assign(count, false);
+    for (int p = 0; p < count; ++p) {
+        if (!plan.alive[p]) continue;
+        for (const ChannelInput &in : plan.channels[p]) {
+            if (in.source == ChannelSource::PreviousFrame) plan.feedback[in.index] = true;
+        }
+    }
+
+    // 3. 拓扑排序 (Kahn)，同层按声明顺序，保证结果稳定
+    std::vector<int> indegree(count, 0);
+    std::vector<std::vector<int>> consumers(count);
+    for (int p = 0; p < screen; ++p) {
+        if (!plan.alive[p]) continue;
+        for (const ChannelInput &in : plan.channels[p]) {
+            if (in.source != ChannelSource::Pass) continue;
+            indegree[p]++;
+            consumers[in.index].push_back(p);
+        }
+    }
+
+    std::vector<bool> placed(count, false);
+    int aliveOffscreen = 0;
+    for (int p = 0; p < screen; ++p) if (plan.alive[p]) aliveOffscreen++;
+
+    while ((int)plan.order.size() < aliveOffscreen) {
+        int next = -1;
+        for (int p = 0; p < screen; ++p) {
+            if (plan.alive[p] && !placed[p] && indegree[p] == 0) { next = p; break; }
+        }
+        if (next < 0) break;
+        placed[next] = true;
+        plan.order.push_back(next);
+        for (int consumer : consumers[next]) indegree[consumer]--;
+    }
+
+    // 4. 环: 剩余 Pass 按声明顺序执行，环上的输入读到的是上一帧内容
+    if ((int)plan.order.size() < aliveOffscreen) {
+        plan.hasCycle = true;
+        for (int p = 0; p < screen; ++p) {
+            if (plan.alive[p] && !placed[p]) {
+                qWarning() << "[Graph] Pass" << p << "is part of a dependency cycle, running in declaration order.";
+                plan.order.push_back(p);
+            }
+        }
+    }
+
+    // 5. 生命周期: 输出在本帧内最后被读取的位置，之后其纹理可被后续 Pass 复用
+    std::vector<int> position(count, -1);
+    for (int k = 0; k < (int)plan.order.size(); ++k) position[plan.order[k]] = k;
+    position[screen] = (int)plan.order.size();
+
+    plan.lastUse.assign(count, -1);
+    for (int p = 0; p < count; ++p) {
+        if (!plan.alive[p]) continue;
+        plan.lastUse[p] = std::max(plan.lastUse[p], position[p]);
+        for (const ChannelInput &in : plan.channels[p]) {
+            if (in.source != ChannelSource::Pass) continue;
+            plan.lastUse[in.index] = std::max(plan.lastUse[in.index], position[p]);
+        }
+    }
+
+    return plan;
+}
+
+std::vector<PassChannels> RenderGraph::fromLegacyBindOrder(const std::vector<int> &bindOrder, int passCount)
+{
+    std::vector<PassChannels> result(std::max(0, passCount));
+    for (int i = 0; i < passCount; ++i) {
+        PassChannels &ch = result[i];
+        const int idx = i < (int)bindOrder.size() ? bindOrder[i] : -1;
+
+        // 旧逻辑: 指向更早的 Pass 读本帧结果，指向自身或更晚的 Pass 实际读到的是上一帧
+        if (idx >= 0 && idx < passCount - 1) {
+            ch[0].source = idx < i ? ChannelSource::Pass : ChannelSource::PreviousFrame;
+            ch[0].index = idx;
+        } else {
+            ch[0] = { ChannelSource::Texture, 0 };
+        }
+        for (int t = 0; t < kTextureCount; ++t) {
+            ch[t + 1] = { ChannelSource::Texture, t };
+        }
+    }
+    return result;
+}
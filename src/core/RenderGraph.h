@@ -0,0 +1,31 @@
+#ifndef RENDERGRAPH_H
+#define RENDERGRAPH_H
+
+#include <vector>
+#include "StructModel.h"
+
+// ----------------------------------------------------------------
+// RenderGraph: 由各 Pass 的 iChannel 声明构建执行计划
+// - ChannelSource::Pass 形成 "先执行生产者" 的依赖边，按拓扑序排列
+// - ChannelSource::PreviousFrame 只影响存活性，不产生排序边；被读取的 Pass 标记为反馈 (双缓冲)
+// - 从上屏 Pass (最后一个) 出发不可达的 Pass 被剔除
+// ----------------------------------------------------------------
+struct RenderGraphPlan {
+    std::vector<PassChannels> channels;   // 规范化后的输入 (非法引用已修正)
+    std::vector<int> order;               // 存活离屏 Pass 的执行顺序 (不含上屏 Pass)
+    std::vector<bool> alive;              // 每个 Pass 是否从上屏 Pass 可达
+    std::vector<bool> feedback;           // 被存活 Pass 以 PreviousFrame 读取，需要双缓冲
+    std::vector<int> lastUse;             // 本帧最后一次被读取时的执行位置 (order 下标，上屏 Pass 为 order.size())
+    bool hasCycle = false;                // Pass 依赖存在环 (环内按声明顺序执行)
+};
+
+class RenderGraph {
+public:
+    static RenderGraphPlan build(const std::vector<PassChannels> &channels);
+
+    // 旧接口 getArr 的单输入绑定 → 4 通道声明
+    // binding 1 = inputBindOrder[i] 指向的 Pass，binding 2-4 = 三张底图
+    static std::vector<PassChannels> fromLegacyBindOrder(const std::vector<int> &bindOrder, int passCount);
+};
+
+#endif // RENDERGRAPH_H
@@ -0,0 +1,92 @@
+#ifndef RENDERSTATE_H
+#define RENDERSTATE_H
+
+#include <QRectF>
+#include <QStringList>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "StructModel.h"
+
+// ----------------------------------------------------------------
+// TripleBuffer: 单生产者 / 单消费者的无锁快照交接
+// 生产者写满 back() 后 publish()，与中间槽原子交换；消费者 fetch() 时若中间槽是新的，
+// 再与自己的 front() 交换。双方永远不会同时访问同一个槽，读到的总是一次完整写入的结果，
+// 生产者连续发布多次时消费者只拿到最新的一份。
+// 注意: publish() 之后 back() 指向的是旧内容，每次都要整体写入，不能只改部分字段。
+// ----------------------------------------------------------------
+template <typename T>
+class TripleBuffer {
+public:
+    // --- 生产者 ---
+    T &back() { return m_slots[m_back]; }
+    void publish() {
+        const int previous = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel);
+        m_back = previous & kIndexMask;
+    }
+
+    // --- 消费者 ---
+    // 有新快照时切换到它并返回 true
+    bool fetch() {
+        if (!(m_middle.load(std::memory_order_acquire) & kFresh)) return false;
+        const int previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & kIndexMask;
+        return true;
+    }
+    const T &front() const { return m_slots[m_front]; }
+
+private:
+    static constexpr int kIndexMask = 0x3;
+    static constexpr int kFresh = 0x4;
+
+    std::array<T, 3> m_slots;
+    std::atomic<int> m_middle { 1 };
+    int m_back = 0;     // 仅生产者访问
+    int m_front = 2;    // 仅消费者访问
+};
+
+// 通道贴图的初始路径: 工程尚未指定贴图时渲染器使用的三张内置图片
+inline QStringList defaultTexUrls()
+{
+    return {
+        QStringLiteral(":qt/qml/MyRhi/assets/others/noiseInit.png"),
+        QStringLiteral(":qt/qml/MyRhi/assets/others/picInit.jpg"),
+        QStringLiteral(":qt/qml/MyRhi/assets/others/other.png")
+    };
+}
+
+// ----------------------------------------------------------------
+// 工程配置快照: 每次都是一份完整且一致的配置 (Shader 与绑定同时生效)
+// ----------------------------------------------------------------
+struct PassConfigSnapshot {
+    quint64 version = 0;                     // 单调递增，渲染线程据此判断是否已应用
+    int loopNum = 0;
+    QStringList shaders;                     // 编译后的 .qsb 路径
+    std::vector<int> bindOrder;              // 旧接口的单输入绑定
+    std::vector<PassChannels> channels;      // 4 通道声明 (优先于 bindOrder)
+    std::vector<PassTarget> targets;
+    std::vector<quint32> uniformUsage;       // 每个 Pass 读取的随帧变化 Uniform (为空: 未知，按全部处理)
+    QStringList texUrls = defaultTexUrls();  // 每个槽位的贴图路径，空路径表示该槽位不绑定贴图
+};
+
+// ----------------------------------------------------------------
+// 每帧参数快照: 视口 (物理像素) 与 Uniform 输入
+// ----------------------------------------------------------------
+struct FrameSnapshot {
+    QRectF viewport;
+    RenderParams params;
+};
+
+// GUI 线程 (RhiPingPongItem) 与渲染线程 (SquircleRenderer) 之间的全部共享状态
+// 由 Item 持有，渲染器重建时直接接上，不需要再通过渲染器指针写入
+struct RenderStateChannel {
+    TripleBuffer<PassConfigSnapshot> config;
+    TripleBuffer<FrameSnapshot> frame;
+    // 渲染线程 → GUI 线程: 渲染器还有未完成的工作，按需模式下也需要下一帧
+    std::atomic<bool> redrawRequested { false };
+    // 渲染线程 → GUI 线程: 累积模式的进度 (已累积的样本数；已收敛或达到样本上限)
+    std::atomic<int> accumulatedSamples { 0 };
+    std::atomic<bool> accumulationFinished { false };
+};
+
+#endif // RENDERSTATE_H
@@ -0,0 +1,258 @@
+#include "RhiSharedContext.h"
+#include "myrhiitem.h"
+#include "StructModel.h"
+#include <QFile>
+#include <QImage>
+#include <QMutex>
+#include <QQuickWindow>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// 窗口 → 共享上下文 (弱引用: 最后一个渲染器释放时上下文随之销毁)
+QMutex g_registryMutex;
+QHash<QQuickWindow *, std::weak_ptr<RhiSharedContext>> g_registry;
+
+const float kQuadVertices[] = {
+    -1.0f, -1.0f,
+     1.0f, -1.0f,
+    -1.0f,  1.0f,
+     1.0f,  1.0f
+};
+}
+
+RhiSharedContext::RhiSharedContext(QRhi *rhi, QQuickWindow *window)
+    : m_rhi(rhi), m_window(window)
+{
+    if (m_window) {
+        // 每个窗口只挂一次钩子，由上下文按注册顺序驱动所有渲染器
+        connect(m_window, &QQuickWindow::beforeRendering, this, &RhiSharedContext::simulateAll, Qt::DirectConnection);
+        connect(m_window, &QQuickWindow::beforeRenderPassRecording, this, &RhiSharedContext::renderAll, Qt::DirectConnection);
+    }
+}
+
+RhiSharedContext::~RhiSharedContext()
+{
+    qDebug() << "[Shared] Releasing context:" << m_shaders.size() << "shaders," << m_samplers.count() << "samplers.";
+    m_samplers.releaseAll();
+}
+
+std::shared_ptr<RhiSharedContext> RhiSharedContext::forWindow(QQuickWindow *window)
+{
+    if (!window || !window->rhi()) return nullptr;
+
+    QMutexLocker lock(&g_registryMutex);
+    std::shared_ptr<RhiSharedContext> ctx = g_registry.value(window).lock();
+    // 场景图重建后 QRhi 已换新，旧上下文的资源不能再用
+    if (ctx && ctx->rhi() == window->rhi()) return ctx;
+
+    for (auto it = g_registry.begin(); it != g_registry.end();) {
+        if (it.value().expired()) it = g_registry.erase(it);
+        else ++it;
+    }
+    ctx = std::make_shared<RhiSharedContext>(window->rhi(), window);
+    g_registry.insert(window, ctx);
+    qDebug() << "[Shared] Created context for window" << window;
+    return ctx;
+}
+
+// ========================================================================
+// 渲染器遍历
+// ========================================================================
+void RhiSharedContext::addRenderer(SquircleRenderer *renderer)
+{
+    if (std::find(m_renderers.begin(), m_renderers.end(), renderer) == m_renderers.end())
+        m_renderers.push_back(renderer);
+}
+
+void RhiSharedContext::removeRenderer(SquircleRenderer *renderer)
+{
+    m_renderers.erase(std::remove(m_renderers.begin(), m_renderers.end(), renderer), m_renderers.end());
+}
+
+void RhiSharedContext::simulateAll()
+{
+    // 所有离屏 Pass 录制在同一个命令缓冲中，顺序固定:
+    // 先注册的渲染器上传的共享资源 (底图、Mip) 对后面的渲染器当帧可见
+    for (SquircleRenderer *renderer : m_renderers) renderer->simulate();
+}
+
+void RhiSharedContext::renderAll()
+{
+    for (SquircleRenderer *renderer : m_renderers) renderer->render();
+}
+
+// ========================================================================
+// 通用资源
+// ========================================================================
+QRhiBuffer *RhiSharedContext::quadVertexBuffer(QRhiResourceUpdateBatch *rub)
+{
+    if (!m_quadBuffer) {
+        m_quadBuffer.reset(m_rhi->newBuffer(QRhiBuffer::Immutable, QRhiBuffer::VertexBuffer, sizeof(kQuadVertices)));
+        m_quadBuffer->create();
+        rub->uploadStaticBuffer(m_quadBuffer.get(), kQuadVertices);
+        qDebug() << "[Shared] Vertex Buffer created.";
+    }
+    return m_quadBuffer.get();
+}
+
+QRhiTexture *RhiSharedContext::dummyTexture(QRhiResourceUpdateBatch *rub)
+{
+    if (!m_dummyTexture) {
+        m_dummyTexture.reset(m_rhi->newTexture(QRhiTexture::RGBA8, QSize(1, 1), 1));
+        m_dummyTexture->create();
+    }
+    if (!m_dummyUploaded && rub) {
+        // 未绑定的 iChannel 读到的黑色纹理
+        QImage black(1, 1, QImage::Format_RGBA8888);
+        black.fill(Qt::transparent);
+        rub->uploadTexture(m_dummyTexture.get(), black);
+        m_dummyUploaded = true;
+    }
+    return m_dummyTexture.get();
+}
+
+QShader RhiSharedContext::shader(const QString &path)
+{
+    auto it = m_shaders.constFind(path);
+    if (it != m_shaders.constEnd()) return it.value();
+
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        qWarning() << "[Shader] Failed to open:" << path;
+        return QShader();
+    }
+    const QShader shader = QShader::fromSerialized(f.readAll());
+    if (shader.isValid()) m_shaders.insert(path, shader);
+    return shader;
+}
+
+// ========================================================================
+// 管线
+// ========================================================================
+QRhiShaderResourceBindings *RhiSharedContext::layoutBindings()
+{
+    if (m_layoutSrb) return m_layoutSrb.get();
+
+    // 与各 Pass 的 SRB 布局一致: binding 0 为 Uniform，binding 1-4 为 iChannel0-3
+    // 管线只记录布局，绘制时绑定各渲染器自己的 SRB
+    m_layoutUniformBuffer.reset(m_rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer,
+                                                 m_rhi->ubufAligned(sizeof(ShaderToyUniforms))));
+    m_layoutUniformBuffer->create();
+    QRhiTexture *tex = dummyTexture(nullptr);
+    QRhiSampler *sampler = m_samplers.get(m_rhi, ChannelFilter::Linear, ChannelWrap::Clamp);
+
+    QVector<QRhiShaderResourceBinding> bindings;
+    bindings.append(QRhiShaderResourceBinding::uniformBufferWithDynamicOffset(0, QRhiShaderResourceBinding::VertexStage | QRhiShaderResourceBinding::FragmentStage,
+                                                                              m_layoutUniformBuffer.get(), sizeof(ShaderToyUniforms)));
+    for (int c = 0; c < kMaxChannels; ++c) {
+        bindings.append(QRhiShaderResourceBinding::sampledTexture(1 + c, QRhiShaderResourceBinding::FragmentStage, tex, sampler));
+    }
+    m_layoutSrb.reset(m_rhi->newShaderResourceBindings());
+    m_layoutSrb->setBindings(bindings.cbegin(), bindings.cend());
+    m_layoutSrb->create();
+    return m_layoutSrb.get();
+}
+
+std::shared_ptr<QRhiGraphicsPipeline> RhiSharedContext::pipeline(const QString &fragmentPath, PipelineBlend blend,
+                                                                 QRhiRenderPassDescriptor *rpDesc, bool *created)
+{
+    if (created) *created = false;
+    if (!rpDesc) return nullptr;
+
+    QString key = fragmentPath + QStringLiteral("|blend%1|").arg(int(blend));
+    for (quint32 v : rpDesc->serializedFormat()) key += QString::number(v, 16) + QLatin1Char(',');
+
+    if (std::shared_ptr<QRhiGraphicsPipeline> existing = m_pipelines.value(key).pipeline.lock()) return existing;
+    if (m_failedPipelines.contains(key)) return nullptr;
+
+    QRhiVertexInputLayout inputLayout;
+    // 一个顶点只有 x,y 两个 float
+    inputLayout.setBindings({{ 2 * sizeof(float) }});
+    inputLayout.setAttributes({{ 0, 0, QRhiVertexInputAttribute::Float2, 0 }});
+
+    std::shared_ptr<QRhiGraphicsPipeline> ps(m_rhi->newGraphicsPipeline());
+    ps->setTopology(QRhiGraphicsPipeline::TriangleStrip);
+    ps->setShaderStages({
+        { QRhiShaderStage::Vertex, shader(":/myfile/common.vert.qsb") },
+        { QRhiShaderStage::Fragment, shader(fragmentPath) }
+    });
+    ps->setVertexInputLayout(inputLayout);
+    ps->setShaderResourceBindings(layoutBindings());
+    ps->setRenderPassDescriptor(rpDesc);
+
+    if (blend == PipelineBlend::Alpha) {
+        QRhiGraphicsPipeline::TargetBlend targetBlend;
+        targetBlend.enable = true;
+        targetBlend.srcColor = QRhiGraphicsPipeline::SrcAlpha;
+        targetBlend.dstColor = QRhiGraphicsPipeline::OneMinusSrcAlpha;
+        targetBlend.srcAlpha = QRhiGraphicsPipeline::One;
+        targetBlend.dstAlpha = QRhiGraphicsPipeline::One;
+        ps->setTargetBlends({ targetBlend });
+    } else if (blend == PipelineBlend::Accumulate) {
+        // 滑动平均: avg_n = avg_(n-1) + (x - avg_(n-1)) / n，四个通道同样处理
+        QRhiGraphicsPipeline::TargetBlend targetBlend;
+        targetBlend.enable = true;
+        targetBlend.srcColor = QRhiGraphicsPipeline::ConstantColor;
+        targetBlend.dstColor = QRhiGraphicsPipeline::OneMinusConstantColor;
+        targetBlend.srcAlpha = QRhiGraphicsPipeline::ConstantAlpha;
+        targetBlend.dstAlpha = QRhiGraphicsPipeline::OneMinusConstantAlpha;
+        ps->setTargetBlends({ targetBlend });
+    }
+
+    if (!ps->create()) {
+        // .qsb 路径以内容哈希命名，同一个键重试也只会再失败一次
+        qWarning() << "[Pipeline] Failed to create pipeline for" << fragmentPath;
+        m_failedPipelines.insert(key);
+        pruneExpired();
+        return nullptr;
+    }
+    if (created) *created = true;
+
+    m_pipelines.insert(key, { ps, fragmentPath });
+    pruneExpired();
+    return ps;
+}
+
+void RhiSharedContext::pruneExpired()
+{
+    // 过期的弱引用顺带清理，键表不随编辑历史无限增长
+    QSet<QString> liveShaders = { QStringLiteral(":/myfile/common.vert.qsb") };
+    for (auto it = m_pipelines.begin(); it != m_pipelines.end();) {
+        if (it.value().pipeline.expired()) {
+            it = m_pipelines.erase(it);
+        } else {
+            liveShaders.insert(it.value().fragmentPath);
+            ++it;
+        }
+    }
+    // QShader 只在创建管线时用到，已没有管线引用的就释放 (再次需要时从 .qsb 重新读取)
+    for (auto it = m_shaders.begin(); it != m_shaders.end();) {
+        if (!liveShaders.contains(it.key())) it = m_shaders.erase(it);
+        else ++it;
+    }
+}
+
+// ========================================================================
+// 底图与渲染通道描述
+// ========================================================================
+std::shared_ptr<QRhiTexture> RhiSharedContext::findTexture(const QString &key) const
+{
+    return m_textures.value(key).lock();
+}
+
+void RhiSharedContext::insertTexture(const QString &key, const std::shared_ptr<QRhiTexture> &texture)
+{
+    for (auto it = m_textures.begin(); it != m_textures.end();) {
+        if (it.value().expired()) it = m_textures.erase(it);
+        else ++it;
+    }
+    m_textures.insert(key, texture);
+}
+
+QRhiRenderPassDescriptor *RhiSharedContext::renderPassDescriptor(QRhiTexture::Format format, QRhiTextureRenderTarget *prototype)
+{
+    auto &rpDesc = m_rpDescs[format];
+    if (!rpDesc && prototype) rpDesc.reset(prototype->newCompatibleRenderPassDescriptor());
+    return rpDesc.get();
+}
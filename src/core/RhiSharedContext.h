@@ -0,0 +1,99 @@
+#ifndef RHISHAREDCONTEXT_H
+#define RHISHAREDCONTEXT_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QShader>
+#include <rhi/qrhi.h>
+#include <map>
+#include <memory>
+#include <vector>
+#include "SamplerCache.h"
+
+class QQuickWindow;
+class SquircleRenderer;
+
+// 管线的混合方式
+// - Opaque:     离屏 Pass，直接覆盖
+// - Alpha:      上屏 Pass，按 Alpha 叠加到场景上
+// - Accumulate: 累积模式，结果 = 新样本 x 常量 + 原值 x (1 - 常量)，常量由 setBlendConstants 指定
+enum class PipelineBlend { Opaque, Alpha, Accumulate };
+
+// ----------------------------------------------------------------
+// RhiSharedContext: 同一窗口 (同一 QRhi) 下所有渲染器共用的资源
+// - 全屏四边形顶点缓冲、未绑定通道的黑色纹理、采样器
+// - 已加载的 QShader 与图形管线 (同一 Shader + 同一渲染通道格式只建一条，所有 SRB 布局相同)
+// - 底图纹理 (同一路径、同一填充尺寸只上传一次)
+// - 离屏渲染目标的渲染通道描述 (按格式一个，管线跨渲染器兼容)
+// 窗口模式下每个窗口只连接一次 beforeRendering / beforeRenderPassRecording，
+// 按注册顺序依次执行各渲染器，而不是每个 Item 各自挂钩子。
+// 仅在渲染线程使用；最后一个渲染器释放时随之销毁 (先于 QRhi)。
+// ----------------------------------------------------------------
+class RhiSharedContext : public QObject {
+    Q_OBJECT
+public:
+    explicit RhiSharedContext(QRhi *rhi, QQuickWindow *window = nullptr);
+    ~RhiSharedContext() override;
+
+    // 窗口对应的共享上下文，不存在时创建 (窗口的 QRhi 必须已初始化)
+    static std::shared_ptr<RhiSharedContext> forWindow(QQuickWindow *window);
+
+    QRhi *rhi() const { return m_rhi; }
+
+    // 窗口模式: 参与每帧的统一遍历
+    void addRenderer(SquircleRenderer *renderer);
+    void removeRenderer(SquircleRenderer *renderer);
+    int rendererCount() const { return (int)m_renderers.size(); }
+
+    // 首次使用时创建，上传命令写入 rub
+    QRhiBuffer *quadVertexBuffer(QRhiResourceUpdateBatch *rub);
+    QRhiTexture *dummyTexture(QRhiResourceUpdateBatch *rub);
+    SamplerCache &samplers() { return m_samplers; }
+
+    // 已加载的 .qsb (路径以内容哈希命名，同一路径内容不变)
+    QShader shader(const QString &path);
+
+    // 共享管线: 键为 (片元 Shader, 混合方式, 渲染通道格式)；created 返回是否为新建 (创建成功才为 true)
+    // 创建失败的键会被记住，之后直接返回空，不再每帧重试
+    std::shared_ptr<QRhiGraphicsPipeline> pipeline(const QString &fragmentPath, PipelineBlend blend,
+                                                   QRhiRenderPassDescriptor *rpDesc, bool *created = nullptr);
+
+    // 共享底图纹理: 上传完成后登记，其他渲染器按相同键直接复用 (纹理内容不再修改)
+    std::shared_ptr<QRhiTexture> findTexture(const QString &key) const;
+    void insertTexture(const QString &key, const std::shared_ptr<QRhiTexture> &texture);
+
+    // 某格式离屏目标共用的渲染通道描述 (prototype 用于首次创建)
+    QRhiRenderPassDescriptor *renderPassDescriptor(QRhiTexture::Format format, QRhiTextureRenderTarget *prototype);
+
+private:
+    QRhiShaderResourceBindings *layoutBindings();
+    void pruneExpired();   // 清理已无人使用的管线键及只被它们引用的 QShader
+
+public slots:
+    void simulateAll();   // 全部渲染器的离屏 Pass
+    void renderAll();     // 全部渲染器的上屏 Pass
+
+private:
+    QRhi *m_rhi = nullptr;
+    QQuickWindow *m_window = nullptr;
+    std::vector<SquircleRenderer *> m_renderers;
+
+    std::unique_ptr<QRhiBuffer> m_quadBuffer;
+    std::unique_ptr<QRhiTexture> m_dummyTexture;
+    bool m_dummyUploaded = false;
+    std::unique_ptr<QRhiBuffer> m_layoutUniformBuffer;            // 仅用于管线布局
+    std::unique_ptr<QRhiShaderResourceBindings> m_layoutSrb;     // 与各 Pass 的 SRB 布局兼容
+    SamplerCache m_samplers;
+    QHash<QString, QShader> m_shaders;
+    std::map<QRhiTexture::Format, std::unique_ptr<QRhiRenderPassDescriptor>> m_rpDescs;
+    struct PipelineEntry {
+        std::weak_ptr<QRhiGraphicsPipeline> pipeline;
+        QString fragmentPath;
+    };
+    QHash<QString, PipelineEntry> m_pipelines;
+    QSet<QString> m_failedPipelines;
+    QHash<QString, std::weak_ptr<QRhiTexture>> m_textures;
+};
+
+#endif // RHISHAREDCONTEXT_H
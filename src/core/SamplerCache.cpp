@@ -0,0 +1,34 @@
+#include "SamplerCache.h"
+#include <QDebug>
+
+QRhiSampler *SamplerCache::get(QRhi *rhi, ChannelFilter filter, ChannelWrap wrap)
+{
+    auto &slot = m_samplers[int(filter) * kWrapCount + int(wrap)];
+    if (slot) return slot.get();
+
+    const QRhiSampler::Filter texFilter = filter == ChannelFilter::Nearest ? QRhiSampler::Nearest : QRhiSampler::Linear;
+    const QRhiSampler::Filter mipFilter = filter == ChannelFilter::Mipmap ? QRhiSampler::Linear : QRhiSampler::None;
+    QRhiSampler::AddressMode address = QRhiSampler::ClampToEdge;
+    if (wrap == ChannelWrap::Repeat) address = QRhiSampler::Repeat;
+    else if (wrap == ChannelWrap::Mirror) address = QRhiSampler::Mirror;
+
+    slot.reset(rhi->newSampler(texFilter, texFilter, mipFilter, address, address));
+    if (!slot->create()) {
+        qWarning() << "[Sampler] Failed to create sampler, filter" << int(filter) << "wrap" << int(wrap);
+        slot.reset();
+        return nullptr;
+    }
+    return slot.get();
+}
+
+void SamplerCache::releaseAll()
+{
+    for (auto &s : m_samplers) s.reset();
+}
+
+int SamplerCache::count() const
+{
+    int n = 0;
+    for (const auto &s : m_samplers) n += s ? 1 : 0;
+    return n;
+}
@@ -0,0 +1,26 @@
+#ifndef SAMPLERCACHE_H
+#define SAMPLERCACHE_H
+
+#include <rhi/qrhi.h>
+#include <array>
+#include <memory>
+#include "StructModel.h"
+
+// ----------------------------------------------------------------
+// SamplerCache: 按 (filter, wrap) 共享的采样器
+// 组合只有 3 x 3 种，首次使用时创建，所有 Pass 的所有通道共用
+// ----------------------------------------------------------------
+class SamplerCache {
+public:
+    QRhiSampler *get(QRhi *rhi, ChannelFilter filter, ChannelWrap wrap);
+
+    // 释放全部采样器 (必须先于 QRhi 销毁)
+    void releaseAll();
+    int count() const;
+
+private:
+    static constexpr int kWrapCount = 3;
+    std::array<std::unique_ptr<QRhiSampler>, 3 * kWrapCount> m_samplers;
+};
+
+#endif // SAMPLERCACHE_H
@@ -0,0 +1,33 @@
+#include "ShaderAnalysis.h"
+#include <QFile>
+#include <QRegularExpression>
+#include <QUrl>
+
+quint32 ShaderAnalysis::uniformUsage(const QString &sourcePath)
+{
+    QFile f(sourcePath.startsWith("file:") ? QUrl(sourcePath).toLocalFile() : sourcePath);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return UsesAllUniforms;
+    return uniformUsageOfSource(QString::fromUtf8(f.readAll()));
+}
+
+quint32 ShaderAnalysis::uniformUsageOfSource(const QString &source)
+{
+    static const QRegularExpression comments(R"(//[^\n]*|/\*.*?\*/)", QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression uniformBlock(R"(uniform\s+\w+\s*\{[^}]*\})");
+    static const struct { QRegularExpression pattern; quint32 flag; } uniforms[] = {
+        { QRegularExpression(R"(\b(iTime|iTimeDelta)\b)"), UsesTime },
+        { QRegularExpression(R"(\b(iFrame|iSampleCount)\b)"), UsesFrame },
+        { QRegularExpression(R"(\biMouse\b)"), UsesMouse },
+        { QRegularExpression(R"(\biDate\b)"), UsesDate },
+    };
+
+    QString code = source;
+    code.remove(comments);
+    code.remove(uniformBlock);
+
+    quint32 usage = 0;
+    for (const auto &u : uniforms) {
+        if (code.contains(u.pattern)) usage |= u.flag;
+    }
+    return usage;
+}
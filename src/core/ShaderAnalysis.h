@@ -0,0 +1,19 @@
+#ifndef SHADERANALYSIS_H
+#define SHADERANALYSIS_H
+
+#include <QString>
+#include "StructModel.h"
+
+// ----------------------------------------------------------------
+// ShaderAnalysis: 从 GLSL 源码判断 Pass 实际读取了哪些随帧变化的 Uniform
+// 每个 Shader 都声明完整的 UniformBlock，反射只能看到声明，因此分析源码:
+// 去掉注释与 uniform 块声明后查找 iTime / iFrame / iMouse 等标识符
+// ----------------------------------------------------------------
+class ShaderAnalysis {
+public:
+    // 返回 UniformUsage 标志；读不到源码时保守地返回 UsesAllUniforms
+    static quint32 uniformUsage(const QString &sourcePath);
+    static quint32 uniformUsageOfSource(const QString &source);
+};
+
+#endif // SHADERANALYSIS_H
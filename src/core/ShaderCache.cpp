@@ -0,0 +1,184 @@
+#include "ShaderCache.h"
+#include "ShaderCompiler.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+#include <algorithm>
+#include <vector>
+
+static const char *kCacheSuffix = ".qsb";
+
+ShaderCache &ShaderCache::instance()
+{
+    static ShaderCache cache;
+    return cache;
+}
+
+ShaderCache::ShaderCache()
+    : m_dir(ShaderCompiler::outputDir())
+{
+}
+
+QByteArray ShaderCache::makeKey(const QByteArray &source, const QString &targets, const QString &options)
+{
+    // 各字段之间插入分隔符，避免拼接后产生歧义
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(source);
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(targets.toUtf8());
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(options.toUtf8());
+    return hash.result().toHex();
+}
+
+QString ShaderCache::pathForKey(const QByteArray &key) const
+{
+    return m_dir + QString::fromLatin1(key) + QLatin1String(kCacheSuffix);
+}
+
+void ShaderCache::ensureLoaded()
+{
+    if (m_loaded) return;
+    m_loaded = true;
+
+    QDir dir(m_dir);
+    if (!dir.exists()) dir.mkpath(".");
+
+    const QFileInfoList files = dir.entryInfoList({ QStringLiteral("*") + QLatin1String(kCacheSuffix) }, QDir::Files);
+    for (const QFileInfo &fi : files) {
+        Entry e;
+        e.size = fi.size();
+        e.lastUsed = fi.lastModified().toMSecsSinceEpoch();
+        m_entries.insert(fi.completeBaseName().toLatin1(), e);
+        m_totalBytes += e.size;
+    }
+    qDebug() << "[ShaderCache] Indexed" << m_entries.size() << "entries," << m_totalBytes << "bytes in" << m_dir;
+    evictLocked();
+}
+
+QString ShaderCache::lookup(const QByteArray &key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ensureLoaded();
+
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        m_misses++;
+        return QString();
+    }
+
+    const QString path = pathForKey(key);
+    QFile f(path);
+    if (!f.exists()) {
+        // 文件被外部删除，索引失效
+        m_totalBytes -= it->size;
+        m_entries.erase(it);
+        m_misses++;
+        return QString();
+    }
+
+    const QDateTime now = QDateTime::currentDateTime();
+    it->lastUsed = now.toMSecsSinceEpoch();
+    if (f.open(QIODevice::ReadWrite))
+        f.setFileTime(now, QFileDevice::FileModificationTime);
+
+    m_pins[path]++;
+    m_hits++;
+    return path;
+}
+
+QString ShaderCache::store(const QByteArray &key, const QByteArray &qsbData)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ensureLoaded();
+
+    const QString path = pathForKey(key);
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) return QString();
+    out.write(qsbData);
+    if (!out.commit()) return QString();
+
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) m_totalBytes -= it->size;
+
+    Entry e;
+    e.size = qsbData.size();
+    e.lastUsed = QDateTime::currentMSecsSinceEpoch();
+    m_entries.insert(key, e);
+    m_totalBytes += e.size;
+
+    // 先 pin 再淘汰，同一批次中并行写入的其它条目不会把它挤掉
+    m_pins[path]++;
+    evictLocked();
+    return path;
+}
+
+void ShaderCache::pin(const QStringList &paths)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const QString &path : paths) {
+        if (!path.isEmpty()) m_pins[path]++;
+    }
+}
+
+void ShaderCache::unpin(const QStringList &paths)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const QString &path : paths) {
+        auto it = m_pins.find(path);
+        if (it == m_pins.end()) continue;
+        if (--it.value() <= 0) m_pins.erase(it);
+    }
+    // 之前因 pin 而超出的容量在这里补上淘汰
+    if (m_loaded) evictLocked();
+}
+
+bool ShaderCache::isPinned(const QString &path) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pins.contains(path);
+}
+
+void ShaderCache::evictLocked()
+{
+    if (m_totalBytes <= m_maxBytes) return;
+
+    std::vector<std::pair<qint64, QByteArray>> order;
+    order.reserve(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+        order.emplace_back(it->lastUsed, it.key());
+    std::sort(order.begin(), order.end());
+
+    // 从最久未使用的开始删，至少保留最近写入/命中的一个；仍在使用的条目跳过
+    for (size_t i = 0; i + 1 < order.size() && m_totalBytes > m_maxBytes; ++i) {
+        const QByteArray &key = order[i].second;
+        if (m_pins.contains(pathForKey(key))) continue;
+        QFile::remove(pathForKey(key));
+        m_totalBytes -= m_entries.value(key).size;
+        m_entries.remove(key);
+        qDebug() << "[ShaderCache] Evicted" << key;
+    }
+}
+
+void ShaderCache::setMaxBytes(qint64 bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxBytes = bytes;
+    if (m_loaded) evictLocked();
+}
+
+qint64 ShaderCache::maxBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxBytes;
+}
+
+qint64 ShaderCache::totalBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_totalBytes;
+}
@@ -0,0 +1,66 @@
+#ifndef SHADERCACHE_H
+#define SHADERCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <atomic>
+#include <mutex>
+
+// ----------------------------------------------------------------
+// ShaderCache: 按内容寻址的 .qsb 磁盘缓存
+// key = SHA-256(源码 + 目标语言/版本列表 + Baker 选项)，文件名即 key，
+// 不同工程中同名的 main.frag 不会再互相覆盖。
+// 容量超过上限时按最近使用时间 (LRU) 淘汰，最近使用时间持久化在文件 mtime 上。
+// 正在使用的 .qsb 通过 pin/unpin 计数，淘汰时跳过 (渲染器重建时仍要从磁盘加载)。
+// 所有接口线程安全，可直接在编译线程池中调用。
+// ----------------------------------------------------------------
+class ShaderCache {
+public:
+    static ShaderCache &instance();
+
+    static QByteArray makeKey(const QByteArray &source, const QString &targets, const QString &options);
+
+    // 命中返回 .qsb 路径并刷新其 LRU 时间；未命中返回空字符串
+    // 返回的路径已 pin 一次，调用方用完后 unpin
+    QString lookup(const QByteArray &key);
+    // 写入编译产物并按容量上限淘汰，返回 .qsb 路径 (失败返回空)；同样已 pin 一次
+    QString store(const QByteArray &key, const QByteArray &qsbData);
+
+    // 引用计数: 计数大于 0 的路径不会被淘汰 (不在缓存目录中的路径也可传入，不产生影响)
+    void pin(const QStringList &paths);
+    void unpin(const QStringList &paths);
+    bool isPinned(const QString &path) const;
+
+    QString cacheDir() const { return m_dir; }
+    void setMaxBytes(qint64 bytes);
+    qint64 maxBytes() const;
+    qint64 totalBytes() const;
+
+    quint64 hits() const { return m_hits.load(); }
+    quint64 misses() const { return m_misses.load(); }
+
+private:
+    ShaderCache();
+    void ensureLoaded();        // 首次使用时扫描目录建立索引
+    void evictLocked();
+    QString pathForKey(const QByteArray &key) const;
+
+    struct Entry {
+        qint64 size = 0;
+        qint64 lastUsed = 0;    // ms since epoch
+    };
+
+    QString m_dir;
+    QHash<QByteArray, Entry> m_entries;
+    QHash<QString, int> m_pins;     // .qsb 路径 → 引用计数
+    qint64 m_totalBytes = 0;
+    qint64 m_maxBytes = 64 * 1024 * 1024;
+    bool m_loaded = false;
+    mutable std::mutex m_mutex;
+
+    std::atomic<quint64> m_hits { 0 };
+    std::atomic<quint64> m_misses { 0 };
+};
+
+#endif // SHADERCACHE_H
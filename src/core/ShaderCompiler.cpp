@@ -0,0 +1,180 @@
+#include "ShaderCompiler.h"
+#include "ShaderAnalysis.h"
+#include "ShaderCache.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QThread>
+#include <QUrl>
+#include <QDebug>
+#include <rhi/qshaderbaker.h>
+#include <memory>
+
+namespace {
+
+// 与原 qsb 命令行参数保持一致: --glsl "310 es,440" --hlsl 50 --msl 12 (外加 SPIR-V)
+QList<QShaderBaker::GeneratedShader> bakeTargets()
+{
+    return {
+        { QShader::SpirvShader, QShaderVersion(100) },
+        { QShader::GlslShader, QShaderVersion(310, QShaderVersion::GlslEs) },
+        { QShader::GlslShader, QShaderVersion(440) },
+        { QShader::HlslShader, QShaderVersion(50) },
+        { QShader::MslShader, QShaderVersion(12) }
+    };
+}
+
+// 参与缓存 key 计算的目标描述，修改 bakeTargets() 时需同步修改
+QString bakeTargetsDescription()
+{
+    return QStringLiteral("spirv100;glsl310es;glsl440;hlsl50;msl12");
+}
+
+QShader::Stage stageForFile(const QString &path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "vert") return QShader::VertexStage;
+    if (suffix == "comp") return QShader::ComputeStage;
+    return QShader::FragmentStage;
+}
+
+// 分块渲染: gl_FragCoord 加上 common.vert 传来的本块偏移，Shader 看到的是整幅画面的像素坐标
+// (不分块时偏移为 0)。声明插在 #version 之后，并用 #line 保持报错行号不变
+QByteArray withTileOffset(const QByteArray &source)
+{
+    static const QRegularExpression fragCoord(QStringLiteral("\\bgl_FragCoord\\b"));
+    static const QRegularExpression version(QStringLiteral("^[ \\t]*#[ \\t]*version[^\\n]*\\n"), QRegularExpression::MultilineOption);
+
+    QString text = QString::fromUtf8(source);
+    if (!text.contains(fragCoord)) return source;
+    const QRegularExpressionMatch versionLine = version.match(text);
+    if (!versionLine.hasMatch()) return source;
+
+    const int versionEnd = versionLine.capturedEnd();
+    const int nextLine = text.left(versionEnd).count(QLatin1Char('\n')) + 1;
+    QString body = text.mid(versionEnd);
+    body.replace(fragCoord, QStringLiteral("(gl_FragCoord + vec4(v_tileFragOffset, 0.0, 0.0))"));
+    return (text.left(versionEnd)
+            + QStringLiteral("layout(location = 7) flat in vec2 v_tileFragOffset;\n#line %1\n").arg(nextLine)
+            + body).toUtf8();
+}
+
+struct CompileBatch {
+    int remaining = 0;
+    QList<ShaderCompileResult> results;
+};
+
+} // namespace
+
+ShaderCompiler::ShaderCompiler(QObject *parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+ShaderCompiler::~ShaderCompiler()
+{
+    // 等待未完成的任务，之后投递回来的回调会因为 this 被销毁而自动丢弃
+    m_pool.waitForDone();
+}
+
+QString ShaderCompiler::outputDir()
+{
+    return QCoreApplication::applicationDirPath() + "/qsbfile/";
+}
+
+ShaderCompileResult ShaderCompiler::compileFile(const QString &fileUrl)
+{
+    ShaderCompileResult result;
+    result.sourcePath = fileUrl;
+
+    QString localInputPath;
+    if (fileUrl.startsWith("file:")) localInputPath = QUrl(fileUrl).toLocalFile();
+    else localInputPath = fileUrl;
+
+    QFile src(localInputPath);
+    if (!src.open(QIODevice::ReadOnly)) {
+        result.errorMessage = QStringLiteral("Cannot open shader source: %1").arg(localInputPath);
+        return result;
+    }
+    const QShader::Stage stage = stageForFile(localInputPath);
+    const QByteArray text = src.readAll();
+    const QByteArray source = stage == QShader::FragmentStage ? withTileOffset(text) : text;
+    // 与编译的是同一份文本: 编译期间源文件被修改也不会让缓存判断与产物不符
+    result.uniformUsage = ShaderAnalysis::uniformUsageOfSource(QString::fromUtf8(text));
+
+    // 1. 查缓存: 源码、目标列表、Baker 选项 (含 Qt 版本) 完全一致才算命中
+    const QString options = QStringLiteral("stage=%1;variant=std;qt=%2").arg(int(stage)).arg(QLatin1String(qVersion()));
+    const QByteArray key = ShaderCache::makeKey(source, bakeTargetsDescription(), options);
+
+    ShaderCache &cache = ShaderCache::instance();
+    const QString cached = cache.lookup(key);
+    if (!cached.isEmpty()) {
+        result.qsbPath = cached;
+        return result;
+    }
+
+    // 2. 未命中才真正编译
+    QShaderBaker baker;
+    baker.setSourceString(source, stage, localInputPath);
+    baker.setGeneratedShaderVariants({ QShader::StandardShader });
+    baker.setGeneratedShaders(bakeTargets());
+
+    QShader shader = baker.bake();
+    if (!shader.isValid()) {
+        result.errorMessage = baker.errorMessage();
+        return result;
+    }
+
+    const QString finalOutputPath = cache.store(key, shader.serialized());
+    if (finalOutputPath.isEmpty()) {
+        result.errorMessage = QStringLiteral("Cannot write shader cache entry in %1").arg(cache.cacheDir());
+        return result;
+    }
+
+    result.qsbPath = finalOutputPath;
+    return result;
+}
+
+int ShaderCompiler::compileAll(const QStringList &fileList)
+{
+    const int batchId = ++m_nextBatchId;
+
+    auto batch = std::make_shared<CompileBatch>();
+    batch->remaining = fileList.count();
+    batch->results.resize(fileList.count());
+
+    if (fileList.isEmpty()) {
+        QMetaObject::invokeMethod(this, [this, batchId]() {
+            emit batchFinished(batchId, {});
+        }, Qt::QueuedConnection);
+        return batchId;
+    }
+
+    for (int i = 0; i < fileList.count(); ++i) {
+        const QString path = fileList[i];
+        m_pool.start([this, batchId, batch, i, path]() {
+            ShaderCompileResult result = compileFile(path);
+            result.passIndex = i;
+
+            // 汇总统一回到 GUI 线程完成，batch 只在该线程读写
+            QMetaObject::invokeMethod(this, [this, batchId, batch, result]() {
+                batch->results[result.passIndex] = result;
+                if (!result.ok()) {
+                    qWarning() << "[Compile] Pass" << result.passIndex << "failed:" << result.sourcePath
+                               << "\n" << result.errorMessage;
+                }
+                emit passCompiled(batchId, result);
+                if (--batch->remaining == 0) {
+                    emit batchFinished(batchId, batch->results);
+                    // 编译产物在 lookup/store 时已 pin，接收方在信号处理中自行 pin 需要保留的路径
+                    QStringList produced;
+                    for (const ShaderCompileResult &r : batch->results) produced.append(r.qsbPath);
+                    ShaderCache::instance().unpin(produced);
+                }
+            }, Qt::QueuedConnection);
+        });
+    }
+    return batchId;
+}
@@ -0,0 +1,54 @@
+#ifndef SHADERCOMPILER_H
+#define SHADERCOMPILER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QStringList>
+#include <QList>
+#include "StructModel.h"
+
+// ----------------------------------------------------------------
+// 单个 Pass 的编译结果
+// ----------------------------------------------------------------
+struct ShaderCompileResult {
+    int passIndex = -1;
+    QString sourcePath;     // 原始 GLSL 路径
+    QString qsbPath;        // 生成的 .qsb 路径 (失败时为空)
+    QString errorMessage;   // 失败原因 (QShaderBaker 的错误信息)
+    quint32 uniformUsage = UsesAllUniforms;  // 本次编译的源码读取的随帧变化 Uniform (UniformUsage)
+
+    bool ok() const { return !qsbPath.isEmpty(); }
+};
+
+// ----------------------------------------------------------------
+// ShaderCompiler: 进程内 QShaderBaker 编译，替代外部 qsb.exe
+// 每个 Pass 作为一个任务投递到线程池并行编译，结果通过信号回到 GUI 线程
+// ----------------------------------------------------------------
+class ShaderCompiler : public QObject {
+    Q_OBJECT
+public:
+    explicit ShaderCompiler(QObject *parent = nullptr);
+    ~ShaderCompiler();
+
+    // 异步编译一批 Shader，返回批次号 (信号中回传)
+    int compileAll(const QStringList &fileList);
+
+    // 同步编译单个文件，线程安全 (供工作线程和无窗口工具直接调用)
+    // 成功时返回的 .qsb 已在 ShaderCache 中 pin 一次，调用方负责 unpin
+    static ShaderCompileResult compileFile(const QString &fileUrl);
+
+    // .qsb 输出目录
+    static QString outputDir();
+
+    void waitForDone() { m_pool.waitForDone(); }
+
+signals:
+    void passCompiled(int batchId, const ShaderCompileResult &result);
+    void batchFinished(int batchId, const QList<ShaderCompileResult> &results);
+
+private:
+    QThreadPool m_pool;
+    int m_nextBatchId = 0;
+};
+
+#endif // SHADERCOMPILER_H
@@ -0,0 +1,42 @@
+#include "SimulationClock.h"
+#include <algorithm>
+#include <cmath>
+
+void SimulationClock::setStepRate(double hz)
+{
+    // 改变步长时保持当前模拟时间不变
+    const double now = time();
+    m_rate = std::clamp(hz, 1.0, 10000.0);
+    m_nextStep = (qint64)std::llround(now * m_rate);
+    m_accumulator = 0.0;
+}
+
+void SimulationClock::setMaxStepsPerFrame(int steps)
+{
+    m_maxSteps = std::clamp(steps, 1, 1024);
+}
+
+void SimulationClock::reset(double time)
+{
+    m_nextStep = (qint64)std::llround(std::max(0.0, time) * m_rate);
+    m_accumulator = 0.0;
+}
+
+int SimulationClock::advance(double wallSeconds, int minSteps)
+{
+    m_accumulator += std::max(0.0, wallSeconds);
+    const double delta = stepDelta();
+
+    // 浮点累加误差: 差一点点凑满一步也算一步，避免恰好整倍数的帧率时步数在 0/1/2 之间抖动
+    qint64 due = (qint64)std::floor(m_accumulator / delta + 1e-6);
+    due = std::max<qint64>(due, std::clamp(minSteps, 0, m_maxSteps));
+    if (due > m_maxSteps) {
+        m_dropped += due - m_maxSteps;
+        due = m_maxSteps;
+        m_accumulator = 0.0;   // 落后太多: 丢弃积压，从现在开始重新计时
+    } else {
+        m_accumulator = std::max(0.0, m_accumulator - due * delta);
+    }
+    m_nextStep += due;
+    return (int)due;
+}
@@ -0,0 +1,46 @@
+#ifndef SIMULATIONCLOCK_H
+#define SIMULATIONCLOCK_H
+
+#include <QtGlobal>
+
+// ----------------------------------------------------------------
+// SimulationClock: 固定步长的确定性模拟时钟
+// - 真实时间只用来决定 "本帧该走几步"，iTime / iFrame / iTimeDelta 完全由步数决定:
+//   第 n 步 iFrame = n，iTime = n / stepRate，iTimeDelta = 1 / stepRate
+// - 一帧最多追赶 maxStepsPerFrame 步，超出的时间直接丢弃 (画面变慢而不是越积越多)
+// - 同样的步数序列在任何机器上产生同样的 Uniform，反馈类模拟结果可复现
+// ----------------------------------------------------------------
+class SimulationClock {
+public:
+    void setStepRate(double hz);
+    double stepRate() const { return m_rate; }
+    double stepDelta() const { return 1.0 / m_rate; }
+
+    void setMaxStepsPerFrame(int steps);
+    int maxStepsPerFrame() const { return m_maxSteps; }
+
+    // 从 time 所在的步重新开始 (对齐到步边界)，清空累积的时间
+    void reset(double time = 0.0);
+
+    // 丢弃累积的时间但保留步序号: 暂停、隐藏或按需模式空闲之后恢复时调用，
+    // 中断期间的真实时间不参与追赶，也不计入 droppedSteps
+    void resync() { m_accumulator = 0.0; }
+
+    // 累加一段真实时间，返回本帧应执行的步数 (minSteps .. maxStepsPerFrame)，并推进步序号
+    // minSteps > 0 时即使累积的时间不足也至少执行这么多步 (不足的部分不再追补)
+    int advance(double wallSeconds, int minSteps = 0);
+
+    qint64 nextStep() const { return m_nextStep; }                 // 下一次 advance 返回的第一步的序号
+    double timeAt(qint64 step) const { return step / m_rate; }
+    double time() const { return timeAt(m_nextStep); }             // 已完成全部步之后的模拟时间
+    qint64 droppedSteps() const { return m_dropped; }              // 连续运行中因追赶上限而丢弃的步数
+
+private:
+    double m_rate = 60.0;
+    int m_maxSteps = 4;
+    double m_accumulator = 0.0;
+    qint64 m_nextStep = 0;
+    qint64 m_dropped = 0;
+};
+
+#endif // SIMULATIONCLOCK_H
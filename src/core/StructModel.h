@@ -2,8 +2,14 @@
 #define STRUCTMODEL_H
 #include <QSize>
 #include <QPointF>
+#include <QString>
+#include <QVector>
 #include <QVector4D>
+#include <algorithm>
+#include <array>
+#include <cmath>
 class QRhiGraphicsPipeline;
+class QRhiSampler;
 class QRhiShaderResourceBindings;
 class QRhiTexture;
 class QRhiTextureRenderTarget;
@@ -20,6 +26,110 @@ enum class BufferSlot {
     None = -1 // 用于某些不需要输入的特殊情况
 };
 
+// ----------------------------------------------------------------
+// iChannel 输入源 (每个 Pass 最多 4 个, 对应 binding 1-4)
+// ----------------------------------------------------------------
+enum class ChannelSource {
+    None = 0,       // 未绑定 (黑色纹理)
+    Pass,           // 另一个 Pass 本帧的输出 (决定执行顺序)
+    PreviousFrame,  // 某个 Pass 上一帧的输出 (含读取自身)，不参与排序
+    Texture         // 静态纹理 texUrl[index]
+};
+
+// 通道采样方式 (同 Shadertoy 的 filter / wrap 设置)
+enum class ChannelFilter {
+    Nearest,
+    Linear,
+    Mipmap      // 三线性；源纹理没有 Mip 时按 Linear 处理
+};
+
+enum class ChannelWrap {
+    Clamp,
+    Repeat,
+    Mirror
+};
+
+struct ChannelInput {
+    ChannelSource source = ChannelSource::None;
+    int index = -1;
+    ChannelFilter filter = ChannelFilter::Linear;
+    ChannelWrap wrap = ChannelWrap::Clamp;
+
+    // "nearest" | "linear" | "mipmap"
+    static bool parseFilter(const QString &name, ChannelFilter *out) {
+        if (name.compare(QLatin1String("nearest"), Qt::CaseInsensitive) == 0) { *out = ChannelFilter::Nearest; return true; }
+        if (name.compare(QLatin1String("linear"), Qt::CaseInsensitive) == 0) { *out = ChannelFilter::Linear; return true; }
+        if (name.compare(QLatin1String("mipmap"), Qt::CaseInsensitive) == 0) { *out = ChannelFilter::Mipmap; return true; }
+        return false;
+    }
+    // "clamp" | "repeat" | "mirror"
+    static bool parseWrap(const QString &name, ChannelWrap *out) {
+        if (name.compare(QLatin1String("clamp"), Qt::CaseInsensitive) == 0) { *out = ChannelWrap::Clamp; return true; }
+        if (name.compare(QLatin1String("repeat"), Qt::CaseInsensitive) == 0) { *out = ChannelWrap::Repeat; return true; }
+        if (name.compare(QLatin1String("mirror"), Qt::CaseInsensitive) == 0) { *out = ChannelWrap::Mirror; return true; }
+        return false;
+    }
+
+    bool operator==(const ChannelInput &o) const {
+        return source == o.source && index == o.index && filter == o.filter && wrap == o.wrap;
+    }
+    bool operator!=(const ChannelInput &o) const { return !(*this == o); }
+};
+
+constexpr int kMaxChannels = 4;
+
+// ----------------------------------------------------------------
+// Pass 读取的随帧变化的 Uniform (ShaderAnalysis 从源码得出)
+// 不含 iTime / iFrame / iDate 且不读上一帧的 Pass 输出只取决于输入，可以跨帧复用
+// ----------------------------------------------------------------
+enum UniformUsage : quint32 {
+    UsesTime  = 0x1,    // iTime / iTimeDelta
+    UsesFrame = 0x2,    // iFrame
+    UsesMouse = 0x4,    // iMouse (仅在鼠标变化时重绘)
+    UsesDate  = 0x8,    // iDate
+    UsesAllUniforms = UsesTime | UsesFrame | UsesMouse | UsesDate,
+    UsesPerFrameUniforms = UsesTime | UsesFrame | UsesDate
+};
+using PassChannels = std::array<ChannelInput, kMaxChannels>;
+
+// ----------------------------------------------------------------
+// 离屏 Pass 的渲染目标: 分辨率 (相对视口缩放或固定尺寸) 与格式
+// ----------------------------------------------------------------
+enum class PassFormat {
+    RGBA8,
+    R16F,
+    RG16F,      // QRhi 无双通道半浮点格式，实际分配 RGBA16F
+    RGBA16F,
+    RGBA32F
+};
+
+struct PassTarget {
+    float scale = 1.0f;                     // 相对视口的缩放 (fixedSize 有效时忽略)
+    QSize fixedSize;                        // 固定像素尺寸
+    PassFormat format = PassFormat::RGBA16F;
+
+    QSize resolve(const QSize &viewport) const {
+        if (fixedSize.isValid() && !fixedSize.isEmpty()) return fixedSize;
+        return QSize(std::max(1, (int)std::lround(viewport.width() * scale)),
+                     std::max(1, (int)std::lround(viewport.height() * scale)));
+    }
+
+    // "rgba8" | "r16f" | "rg16f" | "rgba16f" | "rgba32f"
+    static bool parseFormat(const QString &name, PassFormat *out) {
+        static const std::pair<const char *, PassFormat> names[] = {
+            { "rgba8", PassFormat::RGBA8 }, { "r16f", PassFormat::R16F }, { "rg16f", PassFormat::RG16F },
+            { "rgba16f", PassFormat::RGBA16F }, { "rgba32f", PassFormat::RGBA32F }
+        };
+        for (const auto &n : names) {
+            if (name.compare(QLatin1String(n.first), Qt::CaseInsensitive) == 0) { *out = n.second; return true; }
+        }
+        return false;
+    }
+
+    bool operator==(const PassTarget &o) const { return scale == o.scale && fixedSize == o.fixedSize && format == o.format; }
+    bool operator!=(const PassTarget &o) const { return !(*this == o); }
+};
+
 // ----------------------------------------------------------------
 // data from qml
 // ----------------------------------------------------------------
@@ -28,6 +138,9 @@ struct RenderParams {
     float time = 0.0f;          // 对应 iTime (运行时间)
     float timeDelta = 0.0f;     // 对应 iTimeDelta (帧间隔)
     int frame = 0;              // 对应 iFrame (帧数)
+    // 本帧执行的模拟步数: 离屏 Pass 连续执行 N 次 (同一命令缓冲)，第 k 步的
+    // iTime = time + k * timeDelta，iFrame = frame + k；0 表示沿用上一步的结果只重画上屏 Pass
+    int simulationSteps = 1;
     QSize screenSize;           // 对应 iResolution (屏幕/纹理大小)
 
     // --- 鼠标交互 ---
@@ -37,6 +150,13 @@ struct RenderParams {
 
     // --- 日期信息 ---
     QVector4D date;
+
+    // --- 累积模式 (渐进式路径追踪) ---
+    // 上屏 Pass 的结果逐帧做滑动平均；时间、鼠标或 accumulationEpoch 变化时从头累积
+    bool accumulate = false;
+    int sampleBudget = 0;               // 累积到该样本数即停止 (0: 不限)
+    float convergenceThreshold = 0.0f;  // 平均每个样本带来的变化低于此值视为收敛 (0: 不检测)
+    quint32 accumulationEpoch = 0;      // 外部参数 (相机等) 变化时递增
 };
 
 // ========================================================================
@@ -57,10 +177,15 @@ struct ShaderToyUniforms {
     // --- 杂项组 (Offset 48) ---
     float iSampleRate;
     int iFrame;
-    float padding0[2];
+    int iSampleCount;           // 累积模式: 本样本之前已累积的样本数 (非累积模式为 0)
+    float padding0;
 
     // --- 通道分辨率组 (Offset 64) ---
     float iChannelResolution[16];
+
+    // --- 分块渲染组 (Offset 128，由 common.vert 读取，用户 Shader 无需声明) ---
+    float iTileOffset[4];       // xy: 本块左下角在整幅画面中的 gl_FragCoord 偏移
+    float iTileUV[4];           // v_texCoord 在整幅画面中的范围: xy 起点, zw 大小 (不分块时为 0, 0, 1, 1)
 };
 
 // ----------------------------------------------------------------
@@ -71,18 +196,43 @@ struct RenderPass {
     QString shaderPath;
 
     // --- 拓扑连接 ---
-    BufferSlot outputSlot = BufferSlot::None;
-    BufferSlot inputSlot  = BufferSlot::None;
+    PassChannels channels;
+    bool isScreen = false;      // 最后一个 Pass 直接上屏
+    bool culled = false;        // 上屏 Pass 不可达，不分配资源也不执行
+    quint32 uniformUsage = UsesAllUniforms;  // 源码读取的随帧变化 Uniform (UniformUsage)
+    bool cacheable = false;     // 输出只取决于输入 (自身与上游都不读时间、不读上一帧)，输入不变时跳过渲染
+    bool outputValid = false;   // 纹理中保留着按当前输入渲染的结果
+    PassTarget target;          // 离屏输出的分辨率与格式
 
     // --- 资源 (Resources) ---
     // 【新增】每个 Pass 独占的纹理和渲染目标
-    // 对于上屏 Pass (Screen)，这两个指针为 nullptr，因为它使用 SwapChain
-    std::unique_ptr<QRhiTexture> texture;
-    std::unique_ptr<QRhiTextureRenderTarget> renderTarget;
+    // 对于上屏 Pass (Screen)，这些指针为 nullptr，因为它使用 SwapChain
+    // 被读取上一帧的 Pass (反馈) 双缓冲: 按帧奇偶交替读写 [0]/[1]；其余 Pass 只使用 [0]
+    // 纹理与渲染目标归 TexturePool 所有，生命周期不重叠的 Pass 可能共用同一张
+    bool doubleBuffered = false;
+    bool mipmapped = false;     // 有通道以 Mipmap 方式采样本 Pass 输出: 目标带 Mip，写完后在 GPU 上生成
+    QRhiTexture *texture[2] = {};
+    QRhiTextureRenderTarget *renderTarget[2] = {};
+
+    // 本帧写入的槽位
+    int writeSlot(int parity) const { return doubleBuffered ? parity : 0; }
+    // 上一帧写入的槽位
+    int readSlot(int parity) const { return doubleBuffered ? 1 - parity : 0; }
 
     // --- 管线状态 (Pipeline State) ---
-    std::unique_ptr<QRhiGraphicsPipeline> pipeline;
-    std::unique_ptr<QRhiShaderResourceBindings> srb;
+    // srb[parity]: 输入包含双缓冲 Pass 时两套预先建好，按帧奇偶选用；否则只有 srb[0]
+    // 管线归 RhiSharedContext 缓存，Shader 与渲染通道格式相同的 Pass (跨渲染器) 共用一条
+    std::shared_ptr<QRhiGraphicsPipeline> pipeline;
+    std::unique_ptr<QRhiShaderResourceBindings> srb[2];
+
+    QRhiShaderResourceBindings *currentSrb(int parity) const { return srb[parity] ? srb[parity].get() : srb[0].get(); }
+
+    // --- 增量重建的比对状态 ---
+    std::array<QRhiTexture *, kMaxChannels> srbInputs[2] = {};  // 各 SRB 当前绑定的通道纹理
+    std::array<QRhiSampler *, kMaxChannels> srbSamplers[2] = {}; // 各 SRB 当前绑定的采样器
+    quint32 srbUniformGen[2] = {};      // 各 SRB 绑定时 Uniform Buffer 的版本
+    QVector<quint32> rpFormat;          // 管线创建时渲染通道描述的格式 (比较兼容性)
+    bool needsClear = false;            // 反馈纹理新分配，首帧前清空读槽位
 };
 
 
@@ -0,0 +1,106 @@
+#include "TextureLoader.h"
+#include "ImageCache.h"
+#include <QThread>
+#include <QUrl>
+#include <QDebug>
+#include <algorithm>
+
+TextureLoader::TextureLoader()
+{
+    // 解码是纯 CPU 任务，留出核心给渲染线程与编译线程
+    m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+}
+
+TextureLoader::~TextureLoader()
+{
+    m_pool.waitForDone();
+}
+
+QImage TextureLoader::decode(const QString &path)
+{
+    const QString localPath = path.startsWith("file:") ? QUrl(path).toLocalFile() : path;
+    return QImage(localPath);
+}
+
+QImage TextureLoader::fitToSize(const QImage &source, const QSize &fitSize)
+{
+    QImage image = source;
+    if (image.isNull()) {
+        image = QImage(64, 64, QImage::Format_RGBA8888);
+        image.fill(Qt::red);
+    }
+
+    // Aspect Fill
+    const int targetW = fitSize.width();
+    const int targetH = fitSize.height();
+    if (targetW > 0 && targetH > 0) {
+        // A. 缩放：Qt::KeepAspectRatioByExpanding 会保证图片塞满框，短边对齐，长边溢出
+        image = image.scaled(targetW, targetH,
+                             Qt::KeepAspectRatioByExpanding,
+                             Qt::SmoothTransformation);
+
+        // B. 裁剪：计算居中偏移量，切掉溢出的部分
+        int x = (image.width() - targetW) / 2;
+        int y = (image.height() - targetH) / 2;
+        image = image.copy(x, y, targetW, targetH);
+    }
+
+    return image.convertToFormat(QImage::Format_RGBA8888);
+}
+
+quint64 TextureLoader::request(int slot, const QString &path, const QSize &fitSize)
+{
+    const quint64 ticket = ++m_nextTicket;
+    m_pool.start([this, slot, ticket, path, fitSize]() {
+        LoadedTexture result;
+        result.slot = slot;
+        result.ticket = ticket;
+        result.path = path;
+        result.fitSize = fitSize;
+
+        // 压缩纹理: 映射文件并定位各级 Mip，上传时零拷贝；解析失败时给出占位图
+        if (CompressedTexture::isTextureFile(path)) {
+            QString error;
+            result.compressed = CompressedTexture::open(path, &error);
+            result.ok = result.compressed != nullptr;
+            if (!result.ok) {
+                qWarning() << "  [Warn] Cannot read compressed texture" << path << ":" << error << ". Using red placeholder.";
+                result.image = fitToSize(QImage(), fitSize);
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_finished.push_back(std::move(result));
+            return;
+        }
+
+        // 先查填充好的结果，再查原图，都没有才读盘解码
+        // 渲染线程发起请求前已查过一次并计入统计，这里的查找不再计数
+        ImageCache &cache = ImageCache::instance();
+        cache.refresh(path);
+        result.image = cache.find(path, fitSize, false);
+        result.ok = !result.image.isNull();
+        if (!result.ok) {
+            QImage source = cache.find(path, QSize(), false);
+            if (source.isNull()) {
+                source = decode(path);
+                cache.insert(path, QSize(), source);
+            }
+            result.ok = !source.isNull();
+            if (!result.ok)
+                qWarning() << "  [Warn] Failed to load image:" << path << ". Using red placeholder.";
+            result.image = fitToSize(source, fitSize);
+            if (result.ok) cache.insert(path, fitSize, result.image);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished.push_back(std::move(result));
+    });
+    return ticket;
+}
+
+std::vector<LoadedTexture> TextureLoader::takeFinished()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<LoadedTexture> out;
+    out.swap(m_finished);
+    return out;
+}
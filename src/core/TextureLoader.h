@@ -0,0 +1,54 @@
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+#include "CompressedTexture.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// ----------------------------------------------------------------
+// 一次底图加载的结果 (工作线程产出，渲染线程上传)
+// ----------------------------------------------------------------
+struct LoadedTexture {
+    int slot = -1;
+    quint64 ticket = 0;     // 请求编号，渲染线程据此丢弃过期结果
+    QString path;
+    QSize fitSize;
+    QImage image;           // 裁剪填充到 fitSize 的 RGBA8888 图像，可直接上传
+    bool ok = false;        // 解码失败时 image 为红色占位图
+    std::shared_ptr<CompressedTexture> compressed;   // KTX/KTX2/DDS: 映射后的原始数据 (此时 image 为空)
+};
+
+// ----------------------------------------------------------------
+// TextureLoader: 底图的解码、缩放与格式转换放到线程池中完成
+// 渲染线程每帧调用 takeFinished() 取走已完成的结果并上传，不会阻塞帧
+// 原图与填充结果都存入进程级 ImageCache，重复加载只做一次解码
+// KTX/KTX2/DDS 文件只做内存映射与头部解析，保持原尺寸与全部 Mip，不经过 QImage
+// ----------------------------------------------------------------
+class TextureLoader {
+public:
+    TextureLoader();
+    ~TextureLoader();
+
+    // 返回请求编号；KTX/KTX2/DDS 解析失败时直接给出红色占位图 (QImage 没有这些格式的插件，不再尝试解码)
+    quint64 request(int slot, const QString &path, const QSize &fitSize);
+    std::vector<LoadedTexture> takeFinished();
+
+    void waitForDone() { m_pool.waitForDone(); }
+
+    // 解码 + 等比填充裁剪 + 转换为 RGBA8888 (线程安全)
+    static QImage fitToSize(const QImage &source, const QSize &fitSize);
+    static QImage decode(const QString &path);
+
+private:
+    QThreadPool m_pool;
+    std::mutex m_mutex;
+    std::vector<LoadedTexture> m_finished;
+    quint64 m_nextTicket = 0;
+};
+
+#endif // TEXTURELOADER_H
@@ -0,0 +1,108 @@
+#include "TexturePool.h"
+#include <QDebug>
+
+TexturePool::~TexturePool()
+{
+    releaseAll();
+}
+
+qint64 TexturePool::bytesFor(const QSize &size, QRhiTexture::Format format, bool mipmapped)
+{
+    qint64 bpp = 4;
+    switch (format) {
+    case QRhiTexture::RGBA16F: bpp = 8; break;
+    case QRhiTexture::RGBA32F: bpp = 16; break;
+    case QRhiTexture::R16F:    bpp = 2; break;
+    case QRhiTexture::R32F:    bpp = 4; break;
+    default: break;
+    }
+    const qint64 base = qint64(size.width()) * size.height() * bpp;
+    return mipmapped ? base * 4 / 3 : base;   // Mip 链约多 1/3
+}
+
+qint64 TexturePool::totalBytes() const
+{
+    qint64 total = 0;
+    for (const auto &e : m_entries) total += bytesFor(e->size, e->format, e->mipmapped);
+    return total;
+}
+
+QRhiRenderPassDescriptor *TexturePool::renderPassDescriptor(QRhiTexture::Format format) const
+{
+    if (m_descriptorSource) return m_descriptorSource(format, nullptr);
+    auto it = m_rpDescs.find(format);
+    return it != m_rpDescs.end() ? it->second.get() : nullptr;
+}
+
+std::vector<PooledTarget *> TexturePool::rebuild(QRhi *rhi, const std::vector<TargetRequest> &requests)
+{
+    std::vector<PooledTarget *> result(requests.size(), nullptr);
+    std::vector<bool> used(m_entries.size(), false);
+    int reused = 0;
+
+    // 1. 尺寸、格式与 Mip 设置相同的旧条目直接复用
+    for (size_t r = 0; r < requests.size(); ++r) {
+        for (size_t e = 0; e < m_entries.size(); ++e) {
+            if (used[e]) continue;
+            if (m_entries[e]->size == requests[r].size && m_entries[e]->format == requests[r].format
+                && m_entries[e]->mipmapped == requests[r].mipmapped) {
+                used[e] = true;
+                result[r] = m_entries[e].get();
+                reused++;
+                break;
+            }
+        }
+    }
+
+    // 2. 先释放用不上的旧条目，再新建
+    int freed = 0;
+    std::vector<std::unique_ptr<PooledTarget>> kept;
+    for (size_t e = 0; e < m_entries.size(); ++e) {
+        if (used[e]) kept.push_back(std::move(m_entries[e]));
+        else freed++;
+    }
+    m_entries = std::move(kept);
+
+    int allocated = 0;
+    for (size_t r = 0; r < requests.size(); ++r) {
+        if (result[r]) continue;
+
+        auto entry = std::make_unique<PooledTarget>();
+        entry->size = requests[r].size;
+        entry->format = requests[r].format;
+        entry->mipmapped = requests[r].mipmapped;
+        QRhiTexture::Flags flags = QRhiTexture::RenderTarget;
+        if (entry->mipmapped) flags |= QRhiTexture::MipMapped | QRhiTexture::UsedWithGenerateMips;
+        entry->texture.reset(rhi->newTexture(entry->format, entry->size, 1, flags));
+        if (!entry->texture->create()) {
+            qWarning() << "[Pool] Failed to create" << entry->size << "target, format" << entry->format;
+            continue;
+        }
+
+        entry->renderTarget.reset(rhi->newTextureRenderTarget({ QRhiColorAttachment(entry->texture.get()) }));
+        QRhiRenderPassDescriptor *rpDesc = nullptr;
+        if (m_descriptorSource) {
+            rpDesc = m_descriptorSource(entry->format, entry->renderTarget.get());
+        } else {
+            auto &owned = m_rpDescs[entry->format];
+            if (!owned) owned.reset(entry->renderTarget->newCompatibleRenderPassDescriptor());
+            rpDesc = owned.get();
+        }
+        entry->renderTarget->setRenderPassDescriptor(rpDesc);
+        entry->renderTarget->create();
+
+        result[r] = entry.get();
+        m_entries.push_back(std::move(entry));
+        allocated++;
+    }
+
+    qDebug() << "[Pool]" << count() << "targets," << totalBytes() / (1024 * 1024) << "MB"
+             << "(reused" << reused << ", allocated" << allocated << ", freed" << freed << ")";
+    return result;
+}
+
+void TexturePool::releaseAll()
+{
+    m_entries.clear();
+    m_rpDescs.clear();
+}
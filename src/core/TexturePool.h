@@ -0,0 +1,60 @@
+#ifndef TEXTUREPOOL_H
+#define TEXTUREPOOL_H
+
+#include <QSize>
+#include <rhi/qrhi.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+// ----------------------------------------------------------------
+// TexturePool: 离屏 Pass 的渲染目标池
+// - 每个条目是一张纹理 + 对应的渲染目标，同一格式共用一个渲染通道描述
+// - rebuild() 按请求列表重新分配: 尺寸、格式与 Mip 设置相同的旧条目直接复用，
+//   多余的旧条目在新建之前释放，重建期间显存峰值不叠加
+// - 条目在 rebuild() 之间保持不变，Pass 只持有裸指针
+// ----------------------------------------------------------------
+struct TargetRequest {
+    QSize size;
+    QRhiTexture::Format format = QRhiTexture::RGBA16F;
+    bool mipmapped = false;     // 带完整 Mip 链，可在 GPU 上生成
+};
+
+struct PooledTarget {
+    QSize size;
+    QRhiTexture::Format format = QRhiTexture::RGBA16F;
+    bool mipmapped = false;
+    std::unique_ptr<QRhiTexture> texture;
+    std::unique_ptr<QRhiTextureRenderTarget> renderTarget;
+};
+
+class TexturePool {
+public:
+    ~TexturePool();
+
+    // 返回与 requests 一一对应的目标；失败的项为 nullptr
+    std::vector<PooledTarget *> rebuild(QRhi *rhi, const std::vector<TargetRequest> &requests);
+
+    // 某格式渲染目标共用的渲染通道描述 (管线创建时使用)
+    QRhiRenderPassDescriptor *renderPassDescriptor(QRhiTexture::Format format) const;
+
+    // 渲染通道描述改由外部提供 (多个渲染器共用，管线可跨渲染器复用)；
+    // 提供方必须比池中的渲染目标活得更久
+    using DescriptorSource = std::function<QRhiRenderPassDescriptor *(QRhiTexture::Format, QRhiTextureRenderTarget *)>;
+    void setDescriptorSource(DescriptorSource source) { m_descriptorSource = std::move(source); }
+
+    // 释放全部 GPU 资源 (必须先于 QRhi 销毁)
+    void releaseAll();
+
+    int count() const { return (int)m_entries.size(); }
+    qint64 totalBytes() const;
+    static qint64 bytesFor(const QSize &size, QRhiTexture::Format format, bool mipmapped = false);
+
+private:
+    std::vector<std::unique_ptr<PooledTarget>> m_entries;
+    std::map<QRhiTexture::Format, std::unique_ptr<QRhiRenderPassDescriptor>> m_rpDescs;
+    DescriptorSource m_descriptorSource;
+};
+
+#endif // TEXTUREPOOL_H
@@ -0,0 +1,105 @@
+#include "TiledRenderer.h"
+#include "HeadlessRunner.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QDebug>
+#include <algorithm>
+
+bool TiledRenderer::render(const RenderParams &params, const TiledRenderSettings &settings, QString *error)
+{
+    auto fail = [error](const QString &message) {
+        if (error) *error = message;
+        qWarning() << "[Tiled]" << message;
+        return false;
+    };
+
+    QRhi *rhi = m_runner.rhi();
+    if (!rhi) return fail("No QRhi");
+    const QSize image = settings.imageSize;
+    if (image.isEmpty()) return fail("Image size is empty");
+
+    int tile = std::max(16, settings.tileSize);
+    const int maxSize = rhi->resourceLimit(QRhi::TextureSizeMax);
+    if (maxSize > 0) tile = std::min(tile, maxSize);
+    const int cols = (image.width() + tile - 1) / tile;
+    const int rows = (image.height() + tile - 1) / tile;
+
+    // 1. 输出: PAM 先写文件头并预留整幅空间，每块按行 seek 到自己的位置写入
+    const bool pam = settings.output.endsWith(".pam", Qt::CaseInsensitive);
+    QFile file;
+    qint64 headerSize = 0;
+    if (pam) {
+        file.setFileName(settings.output);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return fail("Cannot open " + settings.output + ": " + file.errorString());
+        const QByteArray header = QString("P7\nWIDTH %1\nHEIGHT %2\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n")
+            .arg(image.width()).arg(image.height()).toLatin1();
+        file.write(header);
+        headerSize = header.size();
+        if (!file.resize(headerSize + qint64(image.width()) * image.height() * 4))
+            return fail("Cannot reserve " + settings.output + ": " + file.errorString());
+    } else if (settings.output.isEmpty() || !QDir().mkpath(settings.output)) {
+        return fail("Cannot create " + settings.output);
+    }
+
+    // 2. 输出目标为一块，渲染器视口为整幅画面 (离屏 Pass 与 iResolution 都按整幅计算)
+    if (!m_runner.setOutputSize(QSize(tile, tile))) return fail("Cannot allocate a tile target");
+    SquircleRenderer &renderer = m_runner.renderer();
+    renderer.m_viewportW = (float)image.width();
+    renderer.m_viewportH = (float)image.height();
+
+    qDebug() << "[Tiled] Rendering" << image << "as" << cols << "x" << rows << "tiles of" << tile;
+    QElapsedTimer timer;
+    timer.start();
+    m_tileCount = 0;
+    m_bytesWritten = headerSize;
+    bool ok = true;
+
+    for (int r = 0; r < rows && ok; ++r) {
+        for (int c = 0; c < cols && ok; ++c) {
+            // 边缘块同样按完整尺寸渲染 (超出画面的部分不写出)，所有块的 iTileUV 比例一致
+            const QRect rect(c * tile, r * tile, tile, tile);
+            const QRect visible = rect.intersected(QRect(QPoint(0, 0), image));
+
+            QImage pixels;
+            if (!m_runner.renderTile(params, rect, m_tileCount == 0, &pixels)) {
+                ok = fail(QString("Tile %1,%2 failed").arg(r).arg(c));
+                break;
+            }
+
+            if (pam) {
+                const qint64 rowBytes = qint64(visible.width()) * 4;
+                for (int y = 0; y < visible.height(); ++y) {
+                    const qint64 offset = headerSize + (qint64(visible.y() + y) * image.width() + visible.x()) * 4;
+                    if (!file.seek(offset)
+                        || file.write(reinterpret_cast<const char *>(pixels.constScanLine(y)), rowBytes) != rowBytes) {
+                        ok = fail("Write failed: " + file.errorString());
+                        break;
+                    }
+                }
+                m_bytesWritten += rowBytes * visible.height();
+            } else {
+                const QString path = QDir(settings.output).filePath(QString("tile_%1_%2.png").arg(r).arg(c));
+                const QImage cropped = pixels.copy(0, 0, visible.width(), visible.height());
+                if (!cropped.save(path, "PNG")) {
+                    ok = fail("Cannot write " + path);
+                    break;
+                }
+                m_bytesWritten += QFileInfo(path).size();
+            }
+            m_tileCount++;
+        }
+    }
+
+    // 3. 恢复为普通输出 (视口与输出目标一致)
+    renderer.m_viewportW = (float)m_runner.outputSize().width();
+    renderer.m_viewportH = (float)m_runner.outputSize().height();
+    m_elapsedMs = timer.nsecsElapsed() / 1e6;
+    if (file.isOpen()) file.close();
+
+    qDebug() << "[Tiled] Finished" << m_tileCount << "tiles in" << m_elapsedMs << "ms," << m_bytesWritten / (1024 * 1024) << "MB";
+    return ok;
+}
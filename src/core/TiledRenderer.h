@@ -0,0 +1,45 @@
+#ifndef TILEDRENDERER_H
+#define TILEDRENDERER_H
+
+#include <QSize>
+#include <QString>
+
+class HeadlessRunner;
+struct RenderParams;
+
+// ----------------------------------------------------------------
+// 分块渲染的设置
+// output 以 .pam 结尾时写成一个 PAM (RGB_ALPHA) 文件，每块写完即按位置落盘；
+// 否则视为目录，每块一张 tile_<行>_<列>.png
+// ----------------------------------------------------------------
+struct TiledRenderSettings {
+    QSize imageSize;            // 整幅画面尺寸，可远超设备纹理上限
+    int tileSize = 2048;        // 块边长 (超过设备上限时按上限)
+    QString output;
+};
+
+// ----------------------------------------------------------------
+// TiledRenderer: 超大画面 (海报、印刷) 的分块渲染
+// - 离屏 Pass 按整幅画面的尺寸渲染一次 (超出设备上限的目标等比缩小)
+// - 上屏 Pass 逐块绘制: iResolution 为整幅尺寸，gl_FragCoord 与 v_texCoord 按块偏移，
+//   Shader 看到的是一张无缝的图
+// - 每块读回后立即写出，内存峰值为一块，而不是整幅画面
+// ----------------------------------------------------------------
+class TiledRenderer {
+public:
+    explicit TiledRenderer(HeadlessRunner &runner) : m_runner(runner) {}
+
+    bool render(const RenderParams &params, const TiledRenderSettings &settings, QString *error = nullptr);
+
+    int tileCount() const { return m_tileCount; }
+    double elapsedMs() const { return m_elapsedMs; }
+    qint64 bytesWritten() const { return m_bytesWritten; }
+
+private:
+    HeadlessRunner &m_runner;
+    int m_tileCount = 0;
+    double m_elapsedMs = 0.0;
+    qint64 m_bytesWritten = 0;
+};
+
+#endif // TILEDRENDERER_H
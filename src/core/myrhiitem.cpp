@@ -1,18 +1,26 @@
-#include "MyRhiItem.h"
+#include "myrhiitem.h"
 #include <QFile>
 #include "StructModel.h"
 #include <QDirIterator>
+#include <QElapsedTimer>
 #include <QDebug>
+#include "PipelineCacheStore.h"
+#include "RenderGraph.h"
+#include "ImageCache.h"
+#include <array>
+#include <limits>
+#include <QVarLengthArray>
+
+SquircleRenderer::~SquircleRenderer() {
+    if (shared) shared->removeRenderer(this);
+}
 
 void SquircleRenderer::init(QRhi* rhi, QSize size) {
-    // 1. 检查重建逻辑
+    // 1. 检查重建逻辑: 配置变化 (isReset) 或视口尺寸变化时，与现有 Pass 逐项对比
     bool needRebuild = isReset || renderPass.empty();
-
-    if (!renderPass.empty() && renderPass[0]->texture) {
-        if (renderPass[0]->texture->pixelSize() != size) {
-            qDebug() << "[Init] Size changed from" << renderPass[0]->texture->pixelSize() << "to" << size << ", rebuilding...";
-            needRebuild = true;
-        }
+    if (!renderPass.empty() && size != m_targetViewport) {
+        qDebug() << "[Init] Size changed from" << m_targetViewport << "to" << size << ", re-allocating targets...";
+        needRebuild = true;
     }
 
     // 基础检查
@@ -21,6 +29,7 @@ void SquircleRenderer::init(QRhi* rhi, QSize size) {
     // 【调试】输出关键状态
     qDebug() << "[Init] Triggered. LoopNum:" << loopNum
              << "BindOrder Size:" << inputBindOrder.size()
+             << "Channel Bindings:" << channelBindings.size()
              << "IsReset:" << isReset;
 
     if (loopNum == 0) {
@@ -28,96 +37,291 @@ void SquircleRenderer::init(QRhi* rhi, QSize size) {
         return;
     }
     // 【关键】防止空绑定导致后续逻辑崩溃
-    if (inputBindOrder.empty()) {
-        qDebug() << "[Init] inputBindOrder is empty! Waiting for getArr(). Aborting.";
+    if (inputBindOrder.empty() && channelBindings.empty()) {
+        qDebug() << "[Init] No bindings! Waiting for getArr()/getChannels(). Aborting.";
         return;
     }
 
-    std::lock_guard<std::mutex> lock(mux);
-
-    qDebug() << "[Init] Clearing old passes...";
-    renderPass.clear();
-    rpDesc.reset();
     isReset = false;
+    m_targetViewport = size;
+    m_resourcesDirty = true;
+    m_accumDirty = true;
 
     // loopNum 是总数，取最小值更安全
     int safeLoopNum = std::min((int)MyShader.size(), loopNum);
     qDebug() << "[Init] SafeLoopNum:" << safeLoopNum << "(Shaders:" << MyShader.size() << ")";
+    if (safeLoopNum != (int)renderPass.size()) m_timing.reset(safeLoopNum);
+
+    // 构建渲染图: 4 通道声明优先，否则由旧的单输入绑定转换
+    std::vector<PassChannels> declared = channelBindings.empty()
+        ? RenderGraph::fromLegacyBindOrder(inputBindOrder, safeLoopNum)
+        : channelBindings;
+    declared.resize(safeLoopNum);
+    const RenderGraphPlan plan = RenderGraph::build(declared);
+    m_execOrder = plan.order;
+    qDebug() << "[Graph] Execution order:" << m_execOrder << (plan.hasCycle ? "(cycle)" : "");
+
+    // 被存活 Pass 以 Mipmap 方式读取的 Pass，其输出需要 Mip 链 (后端不支持时忽略)
+    std::vector<bool> wantsMips(safeLoopNum, false);
+    if (rhi->isFeatureSupported(QRhi::MipMaps)) {
+        for (int p = 0; p < safeLoopNum; ++p) {
+            if (!plan.alive[p]) continue;
+            for (const ChannelInput &in : plan.channels[p]) {
+                if ((in.source == ChannelSource::Pass || in.source == ChannelSource::PreviousFrame)
+                    && in.filter == ChannelFilter::Mipmap) {
+                    wantsMips[in.index] = true;
+                }
+            }
+        }
+    }
 
+    // A. 逐个 Pass 与现有配置对比，只作废真正变化的部分
+    //    Shader / 上屏属性 / 输出格式变化 → 重建管线；输入与纹理变化在 createPipelines 中按 SRB 对比更新
+    if ((int)renderPass.size() > safeLoopNum) renderPass.resize(safeLoopNum);
+    m_targetFormats.resize(safeLoopNum, QRhiTexture::UnknownFormat);
+    int pipelinesInvalidated = 0;
     for(int i = 0; i < safeLoopNum; i++)
     {
-        auto initRendPass = std::make_unique<RenderPass>();
-        initRendPass->shaderPath = MyShader[i];
-
-        bool isScreen = (i == safeLoopNum - 1);
-        qDebug() << "  [Init] Building Pass" << i << "IsScreen:" << isScreen << "Path:" << MyShader[i];
-
-        // A. 创建资源 (仅限离屏 Pass)
-        if (!isScreen) {
-            initRendPass->texture.reset(rhi->newTexture(QRhiTexture::RGBA16F, size, 1, QRhiTexture::RenderTarget));
-            initRendPass->texture->create();
+        if (i >= (int)renderPass.size()) renderPass.push_back(std::make_unique<RenderPass>());
+        RenderPass &pass = *renderPass[i];
+
+        PassTarget target = i < (int)targetSpecs.size() ? targetSpecs[i] : PassTarget();
+        const bool isScreen = (i == safeLoopNum - 1);
+        const bool culled = !plan.alive[i];
+
+        const bool pipelineDirty = pass.shaderPath != MyShader[i]
+            || pass.isScreen != isScreen
+            || rhiFormat(pass.target.format) != rhiFormat(target.format);
+        if ((pipelineDirty || culled) && pass.pipeline) {
+            pass.pipeline.reset();
+            pipelinesInvalidated++;
+        }
+        if (culled) {
+            pass.srb[0].reset();
+            pass.srb[1].reset();
+        }
 
-            QRhiTextureRenderTargetDescription desc;
-            desc.setColorAttachments({ QRhiColorAttachment(initRendPass->texture.get()) });
+        pass.shaderPath = MyShader[i];
+        pass.channels = plan.channels[i];
+        pass.isScreen = isScreen;
+        pass.culled = culled;
+        pass.doubleBuffered = plan.feedback[i] && !isScreen;
+        pass.mipmapped = wantsMips[i] && !isScreen;
+        pass.target = target;
+
+        if (pass.culled) {
+            qDebug() << "  [Init] Pass" << i << "culled (not reachable from the screen pass).";
+        } else if (!isScreen) {
+            qDebug() << "  [Init] Pass" << i << "target" << pass.target.resolve(size) << "format" << (int)pass.target.format
+                     << (pass.doubleBuffered ? "(double-buffered feedback)" : "");
+        }
+    }
 
-            initRendPass->renderTarget.reset(rhi->newTextureRenderTarget(desc));
+    // 可缓存的 Pass: 自身不读 iTime/iFrame/iDate，不读上一帧，上游也都可缓存
+    // 它们的输出跨帧保留，输入不变的帧直接跳过 (依赖环中的 Pass 一律每帧渲染)
+    int cacheableCount = 0;
+    for (int p : m_execOrder) {
+        RenderPass &pass = *renderPass[p];
+        pass.uniformUsage = p < (int)passUsage.size() ? passUsage[p] : UsesAllUniforms;
+        bool cacheable = !plan.hasCycle && !pass.doubleBuffered && !(pass.uniformUsage & UsesPerFrameUniforms);
+        for (const ChannelInput &in : pass.channels) {
+            if (in.source == ChannelSource::PreviousFrame) cacheable = false;
+            if (in.source == ChannelSource::Pass && !renderPass[in.index]->cacheable) cacheable = false;
+        }
+        if (cacheable != pass.cacheable) pass.outputValid = false;
+        pass.cacheable = cacheable;
+        if (cacheable) cacheableCount++;
+    }
+    if (cacheableCount > 0) qDebug() << "[Init]" << cacheableCount << "passes are time-invariant, output cached across frames.";
+
+    // B. 分配渲染目标 (仅限存活的离屏 Pass，按执行顺序)
+    // - 反馈 Pass 的两张纹理跨帧保留，独占
+    // - 可缓存 Pass 的输出跨帧保留，独占
+    // - 其余 Pass 的输出只在 [写入, 本帧最后一次被读取] 之间有效，区间不重叠的 Pass 共用一张纹理
+    // - 存在依赖环时读取顺序不可靠，不做别名
+    // 请求不变时池按相同顺序返回相同的纹理，各 Pass 的绑定也就不变
+    const int kPersistent = std::numeric_limits<int>::max();
+    const int maxSize = rhi->resourceLimit(QRhi::TextureSizeMax);   // 渲染目标不超过设备上限
+    const bool allowAliasing = !plan.hasCycle;
+    std::vector<TargetRequest> requests;
+    std::vector<int> targetBusyUntil;   // 每个物理目标当前占用者的最后使用位置
+    std::vector<std::array<int, 2>> passTargets(safeLoopNum, { -1, -1 });
+
+    for (int k = 0; k < (int)m_execOrder.size(); ++k) {
+        const int p = m_execOrder[k];
+        QSize targetSize = renderPass[p]->target.resolve(size);
+        if (maxSize > 0 && (targetSize.width() > maxSize || targetSize.height() > maxSize)) {
+            // 超出设备上限 (例如分块渲染的大幅画面): 等比缩小到上限以内
+            qWarning() << "[Init] Pass" << p << "target" << targetSize << "exceeds the texture limit" << maxSize << ", clamped.";
+            targetSize = targetSize.scaled(maxSize, maxSize, Qt::KeepAspectRatio).expandedTo(QSize(1, 1));
+        }
+        const QRhiTexture::Format format = renderTargetFormat(rhi, renderPass[p]->target.format);
+        if (format != rhiFormat(renderPass[p]->target.format) && format != m_targetFormats[p]) {
+            qWarning() << "[Init] Pass" << p << "target format" << rhiFormat(renderPass[p]->target.format)
+                       << "is not renderable on" << rhi->backendName() << ", using" << format;
+        }
+        m_targetFormats[p] = format;
+        const TargetRequest req { targetSize, format, renderPass[p]->mipmapped };
+
+        if (renderPass[p]->doubleBuffered) {
+            for (int s = 0; s < 2; ++s) {
+                passTargets[p][s] = (int)requests.size();
+                requests.push_back(req);
+                targetBusyUntil.push_back(kPersistent);
+            }
+            continue;
+        }
 
-            if (!rpDesc) {
-                rpDesc.reset(initRendPass->renderTarget->newCompatibleRenderPassDescriptor());
+        int target = -1;
+        if (allowAliasing && !renderPass[p]->cacheable) {
+            for (int t = 0; t < (int)requests.size(); ++t) {
+                if (targetBusyUntil[t] < k && requests[t].size == req.size && requests[t].format == req.format
+                    && requests[t].mipmapped == req.mipmapped) {
+                    target = t;
+                    break;
+                }
             }
-            initRendPass->renderTarget->setRenderPassDescriptor(rpDesc.get());
-            initRendPass->renderTarget->create();
-            qDebug() << "    -> Offscreen resources created.";
         }
-        else {
-            initRendPass->texture = nullptr;
-            initRendPass->renderTarget = nullptr;
-            qDebug() << "    -> Screen pass (no texture created).";
+        if (target < 0) {
+            target = (int)requests.size();
+            requests.push_back(req);
+            targetBusyUntil.push_back(0);
         }
+        targetBusyUntil[target] = allowAliasing && !renderPass[p]->cacheable ? plan.lastUse[p] : kPersistent;
+        passTargets[p][0] = target;
+    }
 
-        // B. 配置输入绑定
-        if (i < inputBindOrder.size()) {
-            initRendPass->inputSlot = static_cast<BufferSlot>(inputBindOrder[i]);
-            qDebug() << "    -> InputSlot set to:" << inputBindOrder[i];
-        } else {
-            initRendPass->inputSlot = BufferSlot::None;
-            qDebug() << "    -> [WARNING] No bind order for this pass! Set to None.";
+    const std::vector<PooledTarget *> targets = m_targetPool.rebuild(rhi, requests);
+    int logicalTargets = 0;
+    int retargeted = 0;
+    for (int p = 0; p < safeLoopNum; ++p) {
+        RenderPass &pass = *renderPass[p];
+        QRhiTexture *before[2] = { pass.texture[0], pass.texture[1] };
+        for (int s = 0; s < 2; ++s) {
+            const int t = passTargets[p][s];
+            const bool valid = t >= 0 && targets[t];
+            pass.texture[s] = valid ? targets[t]->texture.get() : nullptr;
+            pass.renderTarget[s] = valid ? targets[t]->renderTarget.get() : nullptr;
+            if (valid) logicalTargets++;
+        }
+        if (pass.texture[0] != before[0] || pass.texture[1] != before[1]) {
+            retargeted++;
+            pass.outputValid = false;
+            // 新分配的反馈纹理没有 "上一帧" 内容，首帧前清空
+            pass.needsClear = pass.doubleBuffered;
         }
-
-        renderPass.push_back(std::move(initRendPass));
     }
-    qDebug() << "[Init] Finished. RenderPass count:" << renderPass.size();
+    qDebug() << "[Init]" << logicalTargets << "pass targets mapped onto" << requests.size() << "pooled textures.";
+    qDebug() << "[Init] Finished. RenderPass count:" << renderPass.size()
+             << "pipelines invalidated:" << pipelinesInvalidated << "retargeted passes:" << retargeted;
+}
+
+void SquircleRenderer::releasePasses() {
+    renderPass.clear();
+    m_targetFormats.clear();
+    m_resourcesDirty = true;
+}
+
+void SquircleRenderer::releaseResources() {
+    releasePasses();
+    m_accumulator.release();
+    m_accumPipeline[0].reset();
+    m_accumPipeline[1].reset();
+    m_accumShader.clear();
+    m_accumulating = false;
+    m_targetPool.releaseAll();
+    m_uBuf.reset();
+    for (auto &tex : m_bgTex) tex.reset();
+    for (BackgroundSlot &bg : m_bgSlots) bg = BackgroundSlot();
+    m_vBuf = nullptr;
+    m_dummyTex = nullptr;
+    if (shared) shared->removeRenderer(this);
+    shared.reset();
 }
 
 // ========================================================================
 // Helpers
 // ========================================================================
-QShader SquircleRenderer::getShader(const QString &name) {
-    QFile f(name);
-    if (!f.open(QIODevice::ReadOnly)) {
-        qWarning() << "[Shader] Failed to open:" << name;
-        return QShader();
+// 共享底图的键: 同一路径按相同尺寸填充的结果才能共用 (压缩纹理保持原尺寸)
+static QString textureKey(const QString &path, const QSize &fitSize) {
+    return path + QLatin1Char('|') + QString::number(fitSize.width()) + QLatin1Char('x') + QString::number(fitSize.height());
+}
+static QString nativeTextureKey(const QString &path) {
+    return path + QStringLiteral("|native");
+}
+
+QRhiTexture *SquircleRenderer::resolveChannel(const ChannelInput &in, int parity) const {
+    switch (in.source) {
+    case ChannelSource::Pass:
+    case ChannelSource::PreviousFrame:
+        if (in.index >= 0 && in.index < (int)renderPass.size()) {
+            const RenderPass &src = *renderPass[in.index];
+            // Pass: 本帧写入的槽位；PreviousFrame: 上一帧写入的槽位 (单缓冲时两者相同)
+            const int slot = in.source == ChannelSource::Pass ? src.writeSlot(parity) : src.readSlot(parity);
+            if (src.texture[slot]) return src.texture[slot];
+        }
+        break;
+    case ChannelSource::Texture:
+        if (in.index >= 0 && in.index < (int)std::size(m_bgTex) && m_bgTex[in.index])
+            return m_bgTex[in.index].get();
+        break;
+    case ChannelSource::None:
+        break;
+    }
+    return m_dummyTex;
+}
+
+QRhiSampler *SquircleRenderer::resolveSampler(QRhi *rhi, const ChannelInput &in, QRhiTexture *tex) {
+    // 纹理没有 Mip 链时三线性采样会读到不完整的纹理 (部分后端为黑色)，退回双线性
+    ChannelFilter filter = in.filter;
+    if (filter == ChannelFilter::Mipmap && !(tex && tex->flags().testFlag(QRhiTexture::MipMapped)))
+        filter = ChannelFilter::Linear;
+    return shared->samplers().get(rhi, filter, in.wrap);
+}
+
+void SquircleRenderer::invalidateTextureReaders(int textureSlot) {
+    m_accumDirty = true;
+    for (auto &pass : renderPass) {
+        for (const ChannelInput &in : pass->channels) {
+            if (in.source == ChannelSource::Texture && in.index == textureSlot) pass->outputValid = false;
+        }
     }
-    return QShader::fromSerialized(f.readAll());
 }
 
-void SquircleRenderer::initGeometryData() {
-    m_vertexData = {
-        -1.0f, -1.0f,
-        1.0f, -1.0f,
-        -1.0f,  1.0f,
-        1.0f,  1.0f
-    };
-    m_isVertexUploaded = false;
+QRhiTexture::Format SquircleRenderer::rhiFormat(PassFormat format) {
+    switch (format) {
+    case PassFormat::RGBA8:   return QRhiTexture::RGBA8;
+    case PassFormat::R16F:    return QRhiTexture::R16F;
+    case PassFormat::RG16F:   return QRhiTexture::RGBA16F;   // QRhi 没有 RG16F
+    case PassFormat::RGBA16F: return QRhiTexture::RGBA16F;
+    case PassFormat::RGBA32F: return QRhiTexture::RGBA32F;
+    }
+    return QRhiTexture::RGBA16F;
+}
+
+QRhiTexture::Format SquircleRenderer::renderTargetFormat(QRhi *rhi, PassFormat format) {
+    const QRhiTexture::Format candidates[] = { rhiFormat(format), QRhiTexture::RGBA16F, QRhiTexture::RGBA8 };
+    for (QRhiTexture::Format f : candidates) {
+        if (rhi->isTextureFormatSupported(f, QRhiTexture::RenderTarget)) return f;
+    }
+    return QRhiTexture::RGBA8;   // 所有后端都能渲染到 RGBA8
+}
+
+QSize SquircleRenderer::passOutputSize(int index) const {
+    const QSize viewport((int)m_viewportW, (int)m_viewportH);
+    const RenderPass &pass = *renderPass[index];
+    if (pass.isScreen) return viewport;
+    if (pass.texture[0]) return pass.texture[0]->pixelSize();
+    return pass.target.resolve(viewport);
 }
 
 void SquircleRenderer::releasePipelines() {
     // 可以在这里重置所有管线
-    std::lock_guard<std::mutex> lock(mux);
     qDebug() << "[Release] Releasing pipelines...";
     for(auto& pass : renderPass) {
         pass->pipeline.reset();
     }
+    m_resourcesDirty = true;
 }
 
 // ========================================================================
@@ -126,254 +330,582 @@ void SquircleRenderer::releasePipelines() {
 void SquircleRenderer::updateUniformLogic() {
     if (renderPass.empty()) return;
 
-    // 【修改】直接使用 Viewport 尺寸，或者纹理尺寸
-    QSize texSize;
-    if (renderPass[0]->texture) {
-        texSize = renderPass[0]->texture->pixelSize();
-    } else {
-        // 如果是直接上屏的 Pass，使用我们的 m_viewportW/H
-        texSize = QSize((int)m_viewportW, (int)m_viewportH);
-    }
-
-    // 【修改】鼠标坐标换算逻辑简化
-    // 之前是用 texSize/winSize 算比例，现在直接乘 DPR 即可
-    // 因为 MouseArea 的坐标是逻辑坐标，Shader 需要物理像素坐标
-    float dpr = m_window->effectiveDevicePixelRatio();
-
-    m_currentUniforms.iResolution[0] = (float)texSize.width();
-    m_currentUniforms.iResolution[1] = (float)texSize.height();
-    m_currentUniforms.iTime = m_params.time;
-    m_currentUniforms.iTimeDelta = 0.016f;
-
-    // 鼠标坐标直接映射
-    float mx = m_params.mousePos.x() * dpr;
-    float my = m_params.mousePos.y() * dpr;
+    // 所有 Pass 共用的部分
+    ShaderToyUniforms common = {};
+    common.iTileUV[2] = 1.0f;
+    common.iTileUV[3] = 1.0f;
+    common.iTime = m_params.time;
+    common.iTimeDelta = m_params.timeDelta > 0.0f ? m_params.timeDelta : 0.016f;
+    common.iMouse[2] = m_params.isPressed ? 1.0f : -1.0f;
+    common.iMouse[3] = 0.0f;
+    common.iFrame = m_params.frame;
+    common.iSampleCount = m_accumulating ? m_accumulator.sampleCount() : 0;
+
+    // MouseArea 的坐标是逻辑坐标，Shader 需要物理像素坐标，直接乘 DPR
     // 如果需要翻转Y轴 (取决于Shader逻辑，ShaderToy通常原点在左下角)
-    // my = (float)texSize.height() - my;
+    // my = viewportH - my;
+    const float mx = m_params.mousePos.x() * m_dpr;
+    const float my = m_params.mousePos.y() * m_dpr;
+    const float viewportW = std::max(1.0f, m_viewportW);
+    const float viewportH = std::max(1.0f, m_viewportH);
 
-    m_currentUniforms.iMouse[0] = mx;
-    m_currentUniforms.iMouse[1] = my;
-    m_currentUniforms.iMouse[2] = m_params.isPressed ? 1.0f : -1.0f;
-    m_currentUniforms.iMouse[3] = 0.0f;
-    m_currentUniforms.iFrame = m_params.frame;
+    m_passUniforms.resize(renderPass.size());
+    for (size_t i = 0; i < renderPass.size(); ++i) {
+        const RenderPass &pass = *renderPass[i];
+        ShaderToyUniforms &u = m_passUniforms[i];
+        u = common;
+        if (pass.culled) continue;
+
+        // iResolution 为本 Pass 输出尺寸，鼠标坐标按同样比例换算到本 Pass 的像素空间
+        const QSize outSize = passOutputSize((int)i);
+        u.iResolution[0] = (float)outSize.width();
+        u.iResolution[1] = (float)outSize.height();
+        u.iMouse[0] = mx * outSize.width() / viewportW;
+        u.iMouse[1] = my * outSize.height() / viewportH;
+
+        if (pass.isScreen && !m_screenTile.isEmpty()) {
+            // gl_FragCoord 的原点随后端而定: Y 向上时以本块底边到画面底边的距离为偏移
+            const QRect &t = m_screenTile;
+            u.iTileOffset[0] = (float)t.x();
+            u.iTileOffset[1] = m_screenTileYUp ? (float)(outSize.height() - t.y() - t.height()) : (float)t.y();
+            u.iTileUV[0] = (float)t.x() / outSize.width();
+            u.iTileUV[1] = (float)t.y() / outSize.height();
+            u.iTileUV[2] = (float)t.width() / outSize.width();
+            u.iTileUV[3] = (float)t.height() / outSize.height();
+        }
 
-    for (int i = 0; i < 4; ++i) {
-        m_currentUniforms.iChannelResolution[4 * i + 0] = (float)texSize.width();
-        m_currentUniforms.iChannelResolution[4 * i + 1] = (float)texSize.height();
-        m_currentUniforms.iChannelResolution[4 * i + 2] = 1.0f;
-        m_currentUniforms.iChannelResolution[4 * i + 3] = 0.0f;
+        // iChannelResolution 为每个通道实际绑定纹理的尺寸，未绑定为 0
+        for (int c = 0; c < kMaxChannels; ++c) {
+            QSize chSize;
+            if (pass.channels[c].source != ChannelSource::None) {
+                if (QRhiTexture *tex = resolveChannel(pass.channels[c], m_parity)) chSize = tex->pixelSize();
+            }
+            u.iChannelResolution[4 * c + 0] = (float)chSize.width();
+            u.iChannelResolution[4 * c + 1] = (float)chSize.height();
+            u.iChannelResolution[4 * c + 2] = chSize.isEmpty() ? 0.0f : 1.0f;
+            u.iChannelResolution[4 * c + 3] = 0.0f;
+        }
     }
 }
 
+void SquircleRenderer::setScreenTile(const QRect &rect, bool yUp) {
+    m_screenTile = rect;
+    m_screenTileYUp = yUp;
+}
+
+void SquircleRenderer::uploadScreenUniforms(QRhiResourceUpdateBatch *rub) {
+    if (renderPass.empty() || !m_uBuf) return;
+    updateUniformLogic();
+    const int i = (int)renderPass.size() - 1;
+    rub->updateDynamicBuffer(m_uBuf.get(), uniformOffset(m_uniformSteps - 1, i), sizeof(ShaderToyUniforms), &m_passUniforms[i]);
+}
+
 // ========================================================================
 // Create Pipelines (【重写】修正了你代码中的旧逻辑)
 // ========================================================================
-void SquircleRenderer::createPipelines(QRhi *rhi) {
-    QRhiVertexInputLayout inputLayout;
+void SquircleRenderer::createPipelines(const FrameContext &ctx) {
+    QRhi *rhi = ctx.rhi;
 
-    // 【核心修复】这里是步长(Stride)，不是总大小！
-    // 一个顶点只有 x,y 两个 float，所以是 2 * sizeof(float)
-    inputLayout.setBindings({{ 2 * sizeof(float) }});
-
-    inputLayout.setAttributes({{ 0, 0, QRhiVertexInputAttribute::Float2, 0 }});
-
-    // 1. 通用资源
+    // 1. 通用资源: 顶点缓冲、黑色占位纹理、采样器与管线由同窗口的渲染器共用
+    if (!shared || shared->rhi() != rhi) {
+        if (shared) releaseResources();
+        shared = std::make_shared<RhiSharedContext>(rhi);
+    }
     if (!m_vBuf) {
-        m_vBuf.reset(rhi->newBuffer(QRhiBuffer::Immutable, QRhiBuffer::VertexBuffer, 8 * sizeof(float)));
-        m_vBuf->create();
-        qDebug() << "[Resource] Vertex Buffer created.";
+        // 离屏目标的渲染通道描述也由上下文统一提供，管线才能跨渲染器复用
+        m_targetPool.setDescriptorSource([ctxRef = std::weak_ptr<RhiSharedContext>(shared)](QRhiTexture::Format format, QRhiTextureRenderTarget *prototype) {
+            const auto context = ctxRef.lock();
+            return context ? context->renderPassDescriptor(format, prototype) : nullptr;
+        });
+        auto *rub = rhi->nextResourceUpdateBatch();
+        m_vBuf = shared->quadVertexBuffer(rub);
+        m_dummyTex = shared->dummyTexture(rub);
+        ctx.cb->resourceUpdate(rub);
     }
-    if (!m_uBuf) {
-        m_uBuf.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, sizeof(ShaderToyUniforms)));
-        m_uBuf->create();
-        qDebug() << "[Resource] Uniform Buffer created.";
+
+    // 2. 调用 Init
+    // 视口尺寸连续变化 (拖动窗口) 时先沿用旧尺寸的渲染目标，上屏 Pass 拉伸显示，
+    // 尺寸稳定 resizeSettleMs 之后才重新分配；管线与 SRB 布局保持不变
+    const QSize viewport((int)m_viewportW, (int)m_viewportH);
+    if (viewport != m_pendingViewport) {
+        m_pendingViewport = viewport;
+        m_resizeTimer.start();
     }
-    if (!m_sampler) {
-        m_sampler.reset(rhi->newSampler(QRhiSampler::Linear, QRhiSampler::Linear, QRhiSampler::None, QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge));
-        m_sampler->create();
+    QSize targetViewport = m_targetViewport;
+    if (renderPass.empty() || targetViewport.isEmpty()
+        || (m_pendingViewport != m_targetViewport && m_resizeTimer.elapsed() >= resizeSettleMs)) {
+        targetViewport = m_pendingViewport;
+    }
+    init(rhi, targetViewport);
+
+    // Uniform Buffer: 每个 Pass 一段 (按 ubufAlignment 对齐)，绘制时以动态偏移选用各自的一段
+    m_uniformStride = rhi->ubufAligned(sizeof(ShaderToyUniforms));
+    // 多步模拟时每步一组，按 "步 x Pass" 排列；只增不减，步数回落时不重建
+    const quint32 uniformBytes = m_uniformStride * (quint32)std::max<size_t>(1, renderPass.size())
+        * (quint32)std::max(1, m_params.simulationSteps);
+    if (!m_uBuf || m_uBuf->size() < uniformBytes) {
+        if (!m_uBuf) m_uBuf.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, uniformBytes));
+        else m_uBuf->setSize(uniformBytes);
+        m_uBuf->create();
+        m_uniformGeneration++;
+        m_resourcesDirty = true;
+        qDebug() << "[Resource] Uniform Buffer created:" << uniformBytes << "bytes.";
     }
 
-    // 2. 调用 Init
-    init(rhi, QSize((int)m_viewportW, (int)m_viewportH));
+    // 3. 底图: 只重新加载路径或填充尺寸变化的那几张 (picIsReset 强制全部重载)
+    const bool forceReload = picIsReset;
+    picIsReset = false;
+    const QStringList &urls = texUrl;
+
+    // 底图与渲染目标一样按稳定后的尺寸填充
+    QSize fitSize = m_targetViewport.isEmpty() ? viewport : m_targetViewport;
+    const int maxSize = rhi->resourceLimit(QRhi::TextureSizeMax);
+    if (maxSize > 0 && (fitSize.width() > maxSize || fitSize.height() > maxSize))
+        fitSize = fitSize.scaled(maxSize, maxSize, Qt::KeepAspectRatio);
+
+    // 解码、缩放与格式转换在 TextureLoader 的线程池中完成，渲染线程只负责上传；
+    // 加载完成前继续使用旧纹理 (首次加载时为黑色占位纹理)，完成后在同一批次中整体切换
+    std::vector<LoadedTexture> ready;
+    for (int i = 0; i < (int)std::size(m_bgTex); i++) {
+        BackgroundSlot &bg = m_bgSlots[i];
+        const QString path = urls.value(i);
+        if (forceReload) {
+            bg.path.clear();
+            bg.ticket = 0;
+        }
 
-    // 3. Reset 检查
-    {
-        std::lock_guard<std::mutex> lock(mux);
-        if (this->isReset) {
-            qDebug() << "[Pipeline] isReset is true, clearing pipelines...";
-            for (auto& pass : renderPass) {
-                pass->pipeline.reset();
-                pass->srb.reset();
+        // 通道贴图被清空: 释放旧纹理，读取该槽位的通道回落到黑色占位纹理
+        if (path.isEmpty()) {
+            if (m_bgTex[i]) {
+                m_bgTex[i].reset();
+                invalidateTextureReaders(i);
+                m_resourcesDirty = true;
+                qDebug() << "[Resource] Background texture" << i << "cleared";
             }
-            this->isReset = false;
+            bg.path.clear();
+            bg.mapped.reset();
+            bg.ticket = 0;
+            continue;
         }
-    }
 
-    mux.lock();
-    if(this->picIsReset)
-    {
-        for(int i=0;i<std::size(m_bgTex);i++)
-        {
-            m_bgTex[i].reset();
+        if (m_bgTex[i] && bg.path == path && (bg.nativeSize || bg.fitSize == fitSize)) {
+            bg.ticket = 0;   // 已是最新，丢弃仍在路上的旧请求
+            continue;
         }
-        picIsReset=false;
-    }
-    mux.unlock();
-
-    // 4. 加载底图
-    if (!m_bgTex[0]) {
-        qDebug() << "[Resource] Loading background textures...";
-        auto *rub = rhi->nextResourceUpdateBatch();
-
-        // 【新增 1】获取目标渲染框尺寸
-        int targetW = (int)m_viewportW;
-        int targetH = (int)m_viewportH;
-
-        for(int i=0; i<3; i++) {
-            QString path = texUrl[i];
-            QImage image(path);
-            if (image.isNull()) {
-                qWarning() << "  [Warn] Failed to load image:" << path << ". Using red placeholder.";
-                image = QImage(64, 64, QImage::Format_RGBA8888);
-                image.fill(Qt::red);
+        if (bg.ticket != 0 && bg.pendingPath == path && bg.pendingFit == fitSize) continue;
+
+        // 同窗口的其他渲染器已上传过同一张图，直接共用其纹理 (无需解码与上传)
+        std::shared_ptr<QRhiTexture> sharedTex = shared->findTexture(nativeTextureKey(path));
+        const bool nativeHit = (bool)sharedTex;
+        if (!sharedTex) sharedTex = shared->findTexture(textureKey(path, fitSize));
+        if (sharedTex) {
+            if (sharedTex != m_bgTex[i]) {
+                m_bgTex[i] = std::move(sharedTex);
+                invalidateTextureReaders(i);
+                m_resourcesDirty = true;
+                qDebug() << "[Resource] Background texture" << i << "shared:" << path;
             }
+            bg.path = path;
+            bg.fitSize = fitSize;
+            bg.nativeSize = nativeHit;
+            bg.mapped.reset();
+            bg.ticket = 0;
+            continue;
+        }
 
-            // Aspect Fill)
-            if (targetW > 0 && targetH > 0) {
-                // A. 缩放：Qt::KeepAspectRatioByExpanding 会保证图片塞满框，短边对齐，长边溢出
-                image = image.scaled(targetW, targetH,
-                                     Qt::KeepAspectRatioByExpanding,
-                                     Qt::SmoothTransformation);
-
-                // B. 裁剪：计算居中偏移量，切掉溢出的部分
-                int x = (image.width() - targetW) / 2;
-                int y = (image.height() - targetH) / 2;
-                image = image.copy(x, y, targetW, targetH);
-            }
-            // =========================================================
+        // 进程级缓存中已有填充好的图像 (重新打开工程、切换回用过的图片)，当帧直接上传
+        const QImage cached = ImageCache::instance().find(path, fitSize);
+        if (!cached.isNull()) {
+            LoadedTexture hit;
+            hit.slot = i;
+            hit.path = path;
+            hit.fitSize = fitSize;
+            hit.image = cached;
+            hit.ok = true;
+            ready.push_back(std::move(hit));
+            bg.ticket = 0;
+            continue;
+        }
 
-            image = image.convertToFormat(QImage::Format_RGBA8888);
+        bg.ticket = m_textureLoader.request(i, path, fitSize);
+        bg.pendingPath = path;
+        bg.pendingFit = fitSize;
+    }
+    if (!asyncTextureLoads) m_textureLoader.waitForDone();
 
-            m_bgTex[i].reset(rhi->newTexture(QRhiTexture::RGBA8, image.size(), 1));
-            m_bgTex[i]->create();
-            rub->uploadTexture(m_bgTex[i].get(), image);
-        }
+    for (LoadedTexture &loaded : m_textureLoader.takeFinished()) {
+        BackgroundSlot &bg = m_bgSlots[loaded.slot];
+        if (loaded.ticket != bg.ticket) continue;   // 过期结果
+        bg.ticket = 0;
+        ready.push_back(std::move(loaded));
+    }
 
-        initGeometryData();
-        if (!m_vertexData.empty()) {
-            rub->uploadStaticBuffer(m_vBuf.get(), m_vertexData.data());
+    // 纹理一经上传即可能被其他渲染器共用，内容不再修改: 新内容总是上传到新纹理，
+    // 旧纹理在最后一个使用者切换后释放
+    auto *rub = rhi->nextResourceUpdateBatch();
+    bool uploaded = false;
+    const bool mipsSupported = rhi->isFeatureSupported(QRhi::MipMaps);
+
+    for (LoadedTexture &loaded : ready) {
+        BackgroundSlot &bg = m_bgSlots[loaded.slot];
+        auto &tex = m_bgTex[loaded.slot];
+
+        // 压缩纹理: 原尺寸、全部 Mip 直接从映射内存上传
+        // 后端不能采样该格式时没有可用的解码器 (QImage 不支持 KTX/DDS)，报错并使用占位图
+        if (loaded.compressed && !rhi->isTextureFormatSupported(loaded.compressed->format(), loaded.compressed->flags())) {
+            qWarning() << "[Resource] Texture format" << loaded.compressed->format() << "of" << loaded.path
+                       << "is not supported on backend" << rhi->backendName() << ", using red placeholder.";
+            loaded.compressed.reset();
+            loaded.image = TextureLoader::fitToSize(QImage(), loaded.fitSize);
+            loaded.ok = false;
         }
-        m_window->swapChain()->currentFrameCommandBuffer()->resourceUpdate(rub);
+        if (const auto &ct = loaded.compressed) {
+            tex.reset(rhi->newTexture(ct->format(), ct->size(), 1, ct->flags()));
+            tex->create();
+            QVarLengthArray<QRhiTextureUploadEntry, 16> entries;
+            for (int level = 0; level < ct->levelCount(); ++level) {
+                QRhiTextureSubresourceUploadDescription sub(ct->levelData(level));
+                sub.setSourceSize(ct->level(level).pixelSize);
+                entries.append(QRhiTextureUploadEntry(0, level, sub));
+            }
+            QRhiTextureUploadDescription desc;
+            desc.setEntries(entries.cbegin(), entries.cend());
+            rub->uploadTexture(tex.get(), desc);
+            shared->insertTexture(nativeTextureKey(loaded.path), tex);
+
+            bg.path = loaded.path;
+            bg.fitSize = loaded.fitSize;
+            bg.nativeSize = true;
+            bg.mapped = ct;
+            invalidateTextureReaders(loaded.slot);
+            m_resourcesDirty = true;
+            uploaded = true;
+            qDebug() << "[Resource] Background texture" << loaded.slot << "ready (compressed):" << loaded.path
+                     << ct->size() << ct->levelCount() << "levels," << ct->totalBytes() / 1024 << "KB";
+            continue;
+        }
+
+        // 底图是静态的，上传后在 GPU 上生成一次完整 Mip 链，供 Mipmap 采样的通道使用
+        const QRhiTexture::Flags bgFlags = mipsSupported ? (QRhiTexture::MipMapped | QRhiTexture::UsedWithGenerateMips) : QRhiTexture::Flags();
+        tex.reset(rhi->newTexture(QRhiTexture::RGBA8, loaded.image.size(), 1, bgFlags));
+        tex->create();
+        rub->uploadTexture(tex.get(), loaded.image);
+        if (mipsSupported) rub->generateMips(tex.get());
+        shared->insertTexture(textureKey(loaded.path, loaded.fitSize), tex);
+        bg.path = loaded.path;
+        bg.fitSize = loaded.fitSize;
+        bg.nativeSize = false;
+        bg.mapped.reset();
+        invalidateTextureReaders(loaded.slot);
+        m_resourcesDirty = true;
+        uploaded = true;
+        qDebug() << "[Resource] Background texture" << loaded.slot << "ready:" << loaded.path << loaded.image.size();
     }
 
-    // 5. 【核心】遍历 renderPass 创建管线
+    if (uploaded) ctx.cb->resourceUpdate(rub);
+    else rub->release();
+
+    // 4. 资源有变化时逐个 Pass 校验 SRB 与管线，只重建不一致的部分 (稳定运行时每帧直接跳过)
+    if (!m_resourcesDirty) return;
+    m_resourcesDirty = false;
+
+    QElapsedTimer buildTimer;
+    qint64 buildNs = 0;
+    int builtCount = 0;
+    int reusedCount = 0;
+    int srbUpdated = 0;
     for (size_t i = 0; i < renderPass.size(); ++i) {
         auto& pass = renderPass[i];
-        if (pass->pipeline) continue;
+        if (pass->culled) continue;
+
+        bool isScreenPass = pass->isScreen;
+        QRhiRenderPassDescriptor *passRpDesc = isScreenPass ? ctx.screenRpDesc
+            : (pass->renderTarget[0] ? pass->renderTarget[0]->renderPassDescriptor() : nullptr);
+        if (!passRpDesc) continue;
+
+        // A/B. SRB: binding 0 为 Uniform，binding 1-4 依次为 iChannel0-3
+        // 输入包含双缓冲 Pass 时按两种帧奇偶各建一套，运行时只切换 SRB，不重建
+        bool readsDoubleBuffered = false;
+        for (const ChannelInput &in : pass->channels) {
+            if ((in.source == ChannelSource::Pass || in.source == ChannelSource::PreviousFrame)
+                && renderPass[in.index]->doubleBuffered) {
+                readsDoubleBuffered = true;
+            }
+        }
 
-        qDebug() << "[Pipeline] Creating pipeline for Pass" << i;
+        const int srbCount = readsDoubleBuffered ? 2 : 1;
+        for (int parity = 0; parity < srbCount; ++parity) {
+            std::array<QRhiTexture *, kMaxChannels> inputs;
+            std::array<QRhiSampler *, kMaxChannels> samplers;
+            for (int c = 0; c < kMaxChannels; ++c) {
+                inputs[c] = resolveChannel(pass->channels[c], parity);
+                samplers[c] = resolveSampler(rhi, pass->channels[c], inputs[c]);
+            }
 
-        bool isScreenPass = (pass->texture == nullptr);
+            // 绑定的纹理、采样器与 Uniform Buffer 都没变，保留
+            if (pass->srb[parity] && pass->srbInputs[parity] == inputs && pass->srbSamplers[parity] == samplers
+                && pass->srbUniformGen[parity] == m_uniformGeneration)
+                continue;
 
-        // A. 动态输入纹理
-        QRhiTexture* inputTexture = m_bgTex[0].get();
-        int inputIdx = static_cast<int>(pass->inputSlot);
+            QVector<QRhiShaderResourceBinding> bindings;
+            bindings.append(QRhiShaderResourceBinding::uniformBufferWithDynamicOffset(0, QRhiShaderResourceBinding::VertexStage | QRhiShaderResourceBinding::FragmentStage,
+                                                                                      m_uBuf.get(), sizeof(ShaderToyUniforms)));
+            for (int c = 0; c < kMaxChannels; ++c) {
+                bindings.append(QRhiShaderResourceBinding::sampledTexture(1 + c, QRhiShaderResourceBinding::FragmentStage, inputs[c], samplers[c]));
+            }
 
-        // 根据 InputSlot 找到对应的 Texture
-        if (inputIdx >= 0 && inputIdx < renderPass.size()) {
-            if (renderPass[inputIdx]->texture) {
-                inputTexture = renderPass[inputIdx]->texture.get();
-                qDebug() << "  -> Linked Input: Pass" << i << "reads from Pass" << inputIdx;
+            if (pass->srb[parity]) {
+                // 布局不变，只替换资源；引用它的管线无需重建
+                pass->srb[parity]->setBindings(bindings.cbegin(), bindings.cend());
+                pass->srb[parity]->updateResources();
             } else {
-                qDebug() << "  -> [Warn] Pass" << inputIdx << "has no texture (maybe Screen?). Using fallback.";
+                pass->srb[parity].reset(rhi->newShaderResourceBindings());
+                pass->srb[parity]->setBindings(bindings.cbegin(), bindings.cend());
+                pass->srb[parity]->create();
             }
-        } else {
-            qDebug() << "  -> Input: Default/None (Idx:" << inputIdx << ")";
-        }
-
-        // B. SRB
-        pass->srb.reset(rhi->newShaderResourceBindings());
-        pass->srb->setBindings({
-            QRhiShaderResourceBinding::uniformBuffer(0, QRhiShaderResourceBinding::VertexStage | QRhiShaderResourceBinding::FragmentStage, m_uBuf.get()),
-            // Binding 1 是动态输入 (PingPong 结果)
-            QRhiShaderResourceBinding::sampledTexture(1, QRhiShaderResourceBinding::FragmentStage, inputTexture, m_sampler.get()),
-            // Binding 2,3,4 是固定底图
-            QRhiShaderResourceBinding::sampledTexture(2, QRhiShaderResourceBinding::FragmentStage, m_bgTex[0].get(), m_sampler.get()),
-            QRhiShaderResourceBinding::sampledTexture(3, QRhiShaderResourceBinding::FragmentStage, m_bgTex[1].get(), m_sampler.get()),
-            QRhiShaderResourceBinding::sampledTexture(4, QRhiShaderResourceBinding::FragmentStage, m_bgTex[2].get(), m_sampler.get()),
-        });
-        pass->srb->create();
-
-        // C. Pipeline
-        pass->pipeline.reset(rhi->newGraphicsPipeline());
-        pass->pipeline->setTopology(QRhiGraphicsPipeline::TriangleStrip);
-        pass->pipeline->setShaderStages({
-            { QRhiShaderStage::Vertex, getShader(":/myfile/common.vert.qsb") },
-            { QRhiShaderStage::Fragment, getShader(pass->shaderPath) }
-        });
-        pass->pipeline->setVertexInputLayout(inputLayout);
-        pass->pipeline->setShaderResourceBindings(pass->srb.get());
-
-        if (isScreenPass) {
-            pass->pipeline->setRenderPassDescriptor(m_window->swapChain()->currentFrameRenderTarget()->renderPassDescriptor());
-            QRhiGraphicsPipeline::TargetBlend blend;
-            blend.enable = true;
-            blend.srcColor = QRhiGraphicsPipeline::SrcAlpha;
-            blend.dstColor = QRhiGraphicsPipeline::OneMinusSrcAlpha;
-            blend.srcAlpha = QRhiGraphicsPipeline::One;
-            blend.dstAlpha = QRhiGraphicsPipeline::One;
-            pass->pipeline->setTargetBlends({ blend });
-        } else {
-            pass->pipeline->setRenderPassDescriptor(rpDesc.get());
+            pass->srbInputs[parity] = inputs;
+            pass->srbSamplers[parity] = samplers;
+            pass->outputValid = false;
+            pass->srbUniformGen[parity] = m_uniformGeneration;
+            srbUpdated++;
+        }
+        if (srbCount == 1) pass->srb[1].reset();
+
+        // 渲染通道格式变了 (例如无窗口模式更换输出目标)，管线不再兼容
+        const QVector<quint32> rpFormat = passRpDesc->serializedFormat();
+        if (pass->pipeline && pass->rpFormat != rpFormat) pass->pipeline.reset();
+        if (pass->pipeline) continue;
+
+        pass->outputValid = false;
+        pass->rpFormat = rpFormat;
+
+        // C. Pipeline: 同一 Shader + 同一渲染通道格式在整个窗口内只建一次 (上屏 Pass 开启混合)
+        bool created = false;
+        buildTimer.start();
+        pass->pipeline = shared->pipeline(pass->shaderPath, isScreenPass ? PipelineBlend::Alpha : PipelineBlend::Opaque,
+                                          passRpDesc, &created);
+        if (created) {
+            buildNs += buildTimer.nsecsElapsed();
+            builtCount++;
+        } else if (pass->pipeline) {
+            reusedCount++;
         }
 
-        if (!pass->pipeline->create()) {
+        if (!pass->pipeline) {
             qCritical() << "  -> [Error] Failed to create pipeline for Pass" << i;
         } else {
-            qDebug() << "  -> Pipeline created successfully.";
+            qDebug() << "[Pipeline] Pass" << i << (created ? "pipeline created." : "pipeline shared.");
         }
     }
+    qDebug() << "[Pipeline] Built" << builtCount << "pipelines, reused" << reusedCount << "," << srbUpdated << "SRBs updated.";
+    if (builtCount > 0) PipelineCacheStore::instance().recordPipelineBuild(builtCount, buildNs);
 }
 
 // ========================================================================
-// Simulate (【重写】修正了旧变量引用)
+// Execute (与窗口无关，窗口模式与无窗口模式共用)
 // ========================================================================
-void SquircleRenderer::simulate() {
-    QRhi *rhi = m_window->rhi();
-    if (!rhi) return;
+void SquircleRenderer::executeOffscreen(const FrameContext &ctx) {
+    if (!ctx.rhi || !ctx.cb) return;
+    m_dpr = ctx.dpr;
+
+    createPipelines(ctx);
+    m_screenRpDesc = ctx.screenRpDesc;
+    const bool accumulate = prepareAccumulation(ctx);
+
+    // 每个模拟步一组 Uniform: 同一帧内 Dynamic Buffer 的同一段只能有一个值，
+    // 多步时按步分段上传，绘制时以动态偏移选用 (0 步时仍上传一组供上屏 Pass 使用)
+    int steps = std::max(0, m_params.simulationSteps);
+    // 累积已完成 (输入未变): 不再渲染新样本，离屏 Pass 也无需执行
+    if (accumulate && accumulationFinished()) steps = 0;
+    // 0 步本应沿用上一步的离屏结果；但结果还不存在时 (刚建立或目标重新分配) 仍执行一步，避免上屏读到空纹理
+    for (int i : m_execOrder) {
+        if (steps > 0) break;
+        if (i >= 0 && i < (int)renderPass.size() && !renderPass[i]->outputValid) steps = 1;
+    }
+    m_uniformSteps = std::max(1, steps);
+    auto* rub = ctx.rhi->nextResourceUpdateBatch();
+    const RenderParams base = m_params;
+    for (int step = 0; step < m_uniformSteps; ++step) {
+        m_params.time = base.time + step * base.timeDelta;
+        m_params.frame = base.frame + step;
+        updateUniformLogic();
+        for (size_t i = 0; i < m_passUniforms.size(); ++i) {
+            if (renderPass[i]->culled) continue;
+            rub->updateDynamicBuffer(m_uBuf.get(), uniformOffset(step, (int)i), sizeof(ShaderToyUniforms), &m_passUniforms[i]);
+        }
+    }
+    m_params = base;
 
-    createPipelines(rhi);
+    auto* cb = ctx.cb;
+    cb->resourceUpdate(rub);
 
-    auto* rub = rhi->nextResourceUpdateBatch();
-    updateUniformLogic();
-    rub->updateDynamicBuffer(m_uBuf.get(), 0, sizeof(ShaderToyUniforms), &m_currentUniforms);
+    // 上一帧完成时的 GPU 耗时 (需要 QRhi::EnableTimestamps，不支持时为 0)
+    m_timing.recordGpuFrame(cb->lastCompletedGpuTime() * 1000.0);
+
+    // 新分配的反馈纹理: "上一帧" 还没有内容，两个槽位都先清空 (与之后的步数和奇偶无关)
+    for (auto &pass : renderPass) {
+        if (!pass->needsClear) continue;
+        for (int slot = 0; pass->doubleBuffered && slot < 2; ++slot) {
+            if (!pass->renderTarget[slot]) continue;
+            QRhiResourceUpdateBatch *mipBatch = nullptr;
+            if (pass->mipmapped && pass->texture[slot]->flags().testFlag(QRhiTexture::MipMapped)) {
+                mipBatch = ctx.rhi->nextResourceUpdateBatch();
+                mipBatch->generateMips(pass->texture[slot]);
+            }
+            cb->beginPass(pass->renderTarget[slot], Qt::transparent, {1.0f, 0});
+            cb->endPass(mipBatch);
+        }
+        pass->needsClear = false;
+    }
 
-    auto* cb = m_window->swapChain()->currentFrameCommandBuffer();
-    cb->resourceUpdate(rub);
+    // 鼠标变化时读 iMouse 的缓存 Pass 需要重绘 (0 步时不记录，留到下一次真正执行的步)
+    m_skippedPasses = 0;
+    if (steps == 0) return;
+    const bool mouseChanged = m_params.mousePos != m_renderedMousePos || m_params.isPressed != m_renderedPressed;
+    m_renderedMousePos = m_params.mousePos;
+    m_renderedPressed = m_params.isPressed;
+
+    // 全部模拟步录制在同一个命令缓冲中；每步双缓冲 Pass 交换读写槽位
+    for (int step = 0; step < steps; ++step) {
+        m_parity ^= 1;   // 双缓冲 Pass 本步写 [m_parity]、读 [1 - m_parity]
+        recordStep(ctx, step, mouseChanged && step == 0);
+    }
+    if (accumulate) recordAccumulationSample(ctx);
+}
 
-    // 遍历执行所有离屏 Pass
-    int execCount = 0;
-    for(size_t i = 0; i < renderPass.size(); i++)
+void SquircleRenderer::recordStep(const FrameContext &ctx, int step, bool mouseChanged) {
+    // 按渲染图的拓扑顺序执行存活的离屏 Pass
+    // 可缓存 Pass 的输出仍有效、且本步没有上游被重绘时直接跳过，沿用纹理中的结果
+    auto* cb = ctx.cb;
+    std::vector<bool> rendered(renderPass.size(), false);
+    QElapsedTimer passTimer;
+    for (int i : m_execOrder)
     {
+        if (i < 0 || i >= (int)renderPass.size()) continue;
         auto& pass = renderPass[i];
+        const int slot = pass->writeSlot(m_parity);
+
+        bool dirty = !pass->cacheable || !pass->outputValid || (mouseChanged && (pass->uniformUsage & UsesMouse));
+        for (const ChannelInput &in : pass->channels) {
+            if (in.source == ChannelSource::Pass && rendered[in.index]) dirty = true;
+        }
+        if (!dirty) {
+            m_skippedPasses++;
+            continue;
+        }
 
-        if (pass->renderTarget && pass->pipeline) {
-            cb->beginPass(pass->renderTarget.get(), Qt::transparent, {1.0f, 0});
+        if (pass->renderTarget[slot] && pass->pipeline) {
+            passTimer.start();
+            cb->beginPass(pass->renderTarget[slot], Qt::transparent, {1.0f, 0});
             cb->setGraphicsPipeline(pass->pipeline.get());
-            QSize size = pass->texture->pixelSize();
+            QSize size = pass->texture[slot]->pixelSize();
             cb->setViewport({0, 0, (float)size.width(), (float)size.height()});
-            cb->setShaderResources(pass->srb.get());
+            const QRhiCommandBuffer::DynamicOffset uniformSlice(0, uniformOffset(step, i));
+            cb->setShaderResources(pass->currentSrb(m_parity), 1, &uniformSlice);
 
-            const QRhiCommandBuffer::VertexInput vbuf(m_vBuf.get(), 0);
+            const QRhiCommandBuffer::VertexInput vbuf(m_vBuf, 0);
             cb->setVertexInput(0, 1, &vbuf);
             cb->draw(4);
-            cb->endPass();
-            execCount++;
+
+            // 输出被 Mipmap 方式读取: 写完立即生成 Mip 链，后续 Pass (及下一帧) 读到的都是完整的
+            QRhiResourceUpdateBatch *mipBatch = nullptr;
+            if (pass->mipmapped && pass->texture[slot]->flags().testFlag(QRhiTexture::MipMapped)) {
+                mipBatch = ctx.rhi->nextResourceUpdateBatch();
+                mipBatch->generateMips(pass->texture[slot]);
+            }
+            cb->endPass(mipBatch);
+            m_timing.recordCpu(i, passTimer.nsecsElapsed() / 1e6);
+            rendered[i] = true;
+            pass->outputValid = true;
         }
     }
 }
 
-void SquircleRenderer::render() {
+// ========================================================================
+// 累积模式
+// ========================================================================
+bool SquircleRenderer::accumulationFinished() const {
+    if (!m_accumulating) return false;
+    const int samples = m_accumulator.sampleCount();
+    return m_accumulator.converged() || (m_params.sampleBudget > 0 && samples >= m_params.sampleBudget);
+}
+
+bool SquircleRenderer::prepareAccumulation(const FrameContext &ctx) {
+    m_accumulating = false;
+    RenderPass *screen = renderPass.empty() ? nullptr : renderPass.back().get();
+    // 视口尚未稳定 (拖动窗口) 时直接上屏，稳定后从头累积
+    const QSize size((int)m_viewportW, (int)m_viewportH);
+    if (!m_params.accumulate || !screen || !screen->pipeline || m_pendingViewport != m_targetViewport || size.isEmpty()) {
+        if (m_accumulator.isReady()) {
+            m_accumulator.release();
+            m_accumPipeline[0].reset();
+            m_accumPipeline[1].reset();
+            qDebug() << "[Accumulate] Stopped.";
+        }
+        return false;
+    }
+
+    const bool reallocated = m_accumulator.ensureTarget(ctx.rhi, size);
+    if (!m_accumulator.isReady()) return false;
+
+    // 画面的任何输入变化都让已累积的样本失效
+    const bool inputsChanged = m_params.time != m_accumTime || m_params.mousePos != m_accumMouse
+        || m_params.isPressed != m_accumPressed || m_params.accumulationEpoch != m_accumEpoch;
+    if (reallocated || m_accumDirty || inputsChanged) {
+        if (m_accumulator.sampleCount() > 0) qDebug() << "[Accumulate] Reset after" << m_accumulator.sampleCount() << "samples.";
+        m_accumulator.reset();
+        m_accumDirty = false;
+        m_accumTime = m_params.time;
+        m_accumMouse = m_params.mousePos;
+        m_accumPressed = m_params.isPressed;
+        m_accumEpoch = m_params.accumulationEpoch;
+    }
+    m_accumulator.convergenceThreshold = m_params.convergenceThreshold;
+
+    // 上屏 Shader 针对累积纹理的两条管线 (与 Pass 共用 SRB 布局，直接使用上屏 Pass 的 SRB)
+    if (reallocated || screen->shaderPath != m_accumShader || !m_accumPipeline[0] || !m_accumPipeline[1]) {
+        QRhiRenderPassDescriptor *rpDesc = m_accumulator.renderPassDescriptor();
+        m_accumPipeline[0] = shared->pipeline(screen->shaderPath, PipelineBlend::Opaque, rpDesc);
+        m_accumPipeline[1] = shared->pipeline(screen->shaderPath, PipelineBlend::Accumulate, rpDesc);
+        m_accumShader = screen->shaderPath;
+        m_accumulator.reset();
+    }
+    if (!m_accumPipeline[0] || !m_accumPipeline[1]) return false;
+
+    m_accumulating = true;
+    // 收敛检测的读回在之前的帧提交，完成后在这里更新收敛状态
+    m_accumulator.poll();
+    return true;
+}
+
+void SquircleRenderer::recordAccumulationSample(const FrameContext &ctx) {
+    if (!m_accumulating || accumulationFinished()) return;
+
+    QElapsedTimer passTimer;
+    passTimer.start();
+    RenderPass &screen = *renderPass.back();
+    const bool first = m_accumulator.sampleCount() == 0;
+    auto *cb = ctx.cb;
+    const QSize size = m_accumulator.renderTarget()->pixelSize();
+    const QRhiCommandBuffer::DynamicOffset uniformSlice(0, uniformOffset(m_uniformSteps - 1, (int)renderPass.size() - 1));
+
+    // 第一个样本直接覆盖旧内容，之后以 1/(n+1) 的权重与已有平均值混合
+    cb->beginPass(m_accumulator.renderTarget(), Qt::transparent, { 1.0f, 0 });
+    cb->setGraphicsPipeline(m_accumPipeline[first ? 0 : 1].get());
+    cb->setViewport({ 0, 0, (float)size.width(), (float)size.height() });
+    if (!first) cb->setBlendConstants(m_accumulator.blendConstant());
+    cb->setShaderResources(screen.currentSrb(m_parity), 1, &uniformSlice);
+    const QRhiCommandBuffer::VertexInput vbuf(m_vBuf, 0);
+    cb->setVertexInput(0, 1, &vbuf);
+    cb->draw(4);
+    cb->endPass();
+    m_accumulator.sampleAdded();
+    m_timing.recordCpu((int)renderPass.size() - 1, passTimer.nsecsElapsed() / 1e6);
+
+    m_accumulator.recordConvergenceCheck(ctx.rhi, cb, *shared, m_uBuf.get(), uniformSlice.second, m_vBuf);
+}
+
+void SquircleRenderer::executeScreen(QRhiCommandBuffer *cb, const QRhiViewport &viewport) {
     if (renderPass.empty()) return;
 
     // 上屏 Pass 是最后一个
@@ -381,25 +913,106 @@ void SquircleRenderer::render() {
     // 检查管线是否存在
     if (!screenPass->pipeline) return;
 
-    auto* cb = m_window->swapChain()->currentFrameCommandBuffer();
+    // 累积模式: 画累积结果 (上屏 Shader 已在离屏阶段写入累积纹理)
+    if (m_accumulating && m_accumulator.sampleCount() > 0) {
+        const quint32 uniformSlice = uniformOffset(m_uniformSteps - 1, (int)renderPass.size() - 1);
+        m_accumulator.present(cb, *shared, m_screenRpDesc, viewport, m_uBuf.get(), uniformSlice, m_vBuf);
+        return;
+    }
+
+    QElapsedTimer passTimer;
+    passTimer.start();
 
     // 1. 绑定管线
     cb->setGraphicsPipeline(screenPass->pipeline.get());
 
     // 2. 设置视口
-    QSize s = m_window->swapChain()->currentFrameRenderTarget()->pixelSize();
-    cb->setViewport({ m_viewportX, m_viewportY, m_viewportW, m_viewportH });
+    cb->setViewport(viewport);
 
-    // 3. 绑定资源
-    cb->setShaderResources(screenPass->srb.get());
+    // 3. 绑定资源 (使用最后一个模拟步的 Uniform)
+    const QRhiCommandBuffer::DynamicOffset uniformSlice(0, uniformOffset(m_uniformSteps - 1, (int)renderPass.size() - 1));
+    cb->setShaderResources(screenPass->currentSrb(m_parity), 1, &uniformSlice);
 
     // 4. 绑定顶点并绘制
-    const QRhiCommandBuffer::VertexInput vbuf(m_vBuf.get(), 0);
+    const QRhiCommandBuffer::VertexInput vbuf(m_vBuf, 0);
     cb->setVertexInput(0, 1, &vbuf);
     cb->draw(4);
 
+    m_timing.recordCpu((int)renderPass.size() - 1, passTimer.nsecsElapsed() / 1e6);
+}
+
+// ========================================================================
+// Simulate / Render (窗口模式: 从 swapChain 取当前帧)
+// ========================================================================
+void SquircleRenderer::applyPendingState() {
+    if (!stateChannel) return;
+
+    if (stateChannel->frame.fetch()) {
+        const FrameSnapshot &frame = stateChannel->frame.front();
+        m_viewportX = (float)frame.viewport.x();
+        m_viewportY = (float)frame.viewport.y();
+        m_viewportW = (float)frame.viewport.width();
+        m_viewportH = (float)frame.viewport.height();
+        m_params = frame.params;
+    }
+
+    if (stateChannel->config.fetch()) {
+        const PassConfigSnapshot &config = stateChannel->config.front();
+        if (config.version == m_appliedConfigVersion) return;
+        m_appliedConfigVersion = config.version;
+
+        // 只换底图时不需要重新对比 Pass (底图每帧按路径校验)
+        const bool passesChanged = loopNum != config.loopNum || MyShader != config.shaders
+            || inputBindOrder != config.bindOrder || channelBindings != config.channels
+            || targetSpecs != config.targets || passUsage != config.uniformUsage;
+        loopNum = config.loopNum;
+        MyShader = config.shaders;
+        inputBindOrder = config.bindOrder;
+        channelBindings = config.channels;
+        targetSpecs = config.targets;
+        passUsage = config.uniformUsage;
+        texUrl = config.texUrls;
+        if (passesChanged) isReset = true;
+        qDebug() << "[State] Applied config version" << config.version << (passesChanged ? "(passes changed)" : "");
+    }
+}
+
+void SquircleRenderer::simulate() {
+    QRhi *rhi = m_window->rhi();
+    if (!rhi) return;
+
+    applyPendingState();
+
+    FrameContext ctx;
+    ctx.rhi = rhi;
+    ctx.cb = m_window->swapChain()->currentFrameCommandBuffer();
+    ctx.screenRpDesc = m_window->swapChain()->currentFrameRenderTarget()->renderPassDescriptor();
+    ctx.dpr = m_window->effectiveDevicePixelRatio();
+    executeOffscreen(ctx);
+
+    // 自身还有未完成的工作时告知 Item，按需模式下也会补帧
+    if (stateChannel && hasPendingWork())
+        stateChannel->redrawRequested.store(true, std::memory_order_release);
+    if (stateChannel) {
+        stateChannel->accumulatedSamples.store(accumulatedSamples(), std::memory_order_relaxed);
+        stateChannel->accumulationFinished.store(accumulationFinished(), std::memory_order_release);
+    }
+}
+
+void SquircleRenderer::render() {
+    if (renderPass.empty() || !renderPass.back()->pipeline) return;
+
+    auto* cb = m_window->swapChain()->currentFrameCommandBuffer();
+    executeScreen(cb, { m_viewportX, m_viewportY, m_viewportW, m_viewportH });
+
     // 【注意】不要调用 cb->endPass()，Qt 会自己处理
+    // 不再在这里请求下一帧: 是否出帧由 RhiPingPongItem 按渲染模式决定
+}
 
-    // 保持刷新
-    m_window->update();
+bool SquircleRenderer::hasPendingWork() const {
+    if (!renderPass.empty() && m_pendingViewport != m_targetViewport) return true;
+    for (const BackgroundSlot &bg : m_bgSlots) {
+        if (bg.ticket != 0) return true;
+    }
+    return false;
 }
@@ -7,10 +7,12 @@
 #include <QRunnable>
 #include <QColor>
 #include <QPointF>
+#include <QRect>
 #include <QImage>
 #include <QStandardPaths>
 #include <QDir>
 #include <QObject>
+#include <QElapsedTimer>
 
 //RHI Includes
 #include <rhi/qrhi.h>
@@ -18,27 +20,72 @@
 
 //Std Includes
 #include <memory>
-#include <mutex>
 #include <vector>
 
 //Local Includes
 #include "StructModel.h"
+#include "PassTiming.h"
+#include "TexturePool.h"
+#include "TextureLoader.h"
+#include "RenderState.h"
+#include "RhiSharedContext.h"
+#include "Accumulator.h"
+
+// ----------------------------------------------------------------
+// 一帧的执行环境，与 QQuickWindow 解耦
+// 窗口模式由 simulate()/render() 从 swapChain 填充，无窗口模式由 HeadlessRunner 填充
+// ----------------------------------------------------------------
+struct FrameContext {
+    QRhi *rhi = nullptr;
+    QRhiCommandBuffer *cb = nullptr;
+    QRhiRenderPassDescriptor *screenRpDesc = nullptr;   // 上屏 Pass 所在渲染通道
+    float dpr = 1.0f;
+};
 
 // SquircleRenderer
 class SquircleRenderer : public QObject {
     Q_OBJECT
 public:
+    ~SquircleRenderer() override;
+
     //初始化与生命周期
     void init(QRhi* rhi, QSize size);
-    void initGeometryData();
     void releasePipelines();
+    void releasePasses();   // 丢弃全部 Pass 资源，下次 init 完整重建
+    void releaseResources(); // 释放全部 QRhi 资源并脱离共享上下文 (无窗口模式须在 QRhi 销毁前调用)
 
     // 2. 参数与逻辑更新
     void setParams(const RenderParams& params) { m_params = params; }
+    // 窗口模式: 从 stateChannel 取走 GUI 线程最新发布的配置与帧参数 (不阻塞)
+    void applyPendingState();
+    // 视口尚未稳定或底图仍在加载，需要后续帧才能完成
+    bool hasPendingWork() const;
+    // 上一帧因输入未变而跳过的离屏 Pass 数
+    int skippedPassCount() const { return m_skippedPasses; }
+    // 累积模式的进度: 已累积的样本数、是否已收敛或达到样本上限 (之后的帧只重画累积结果)
+    int accumulatedSamples() const { return m_accumulating ? m_accumulator.sampleCount() : 0; }
+    bool accumulationFinished() const;
+    double convergenceDelta() const { return m_accumulator.perSampleDelta(); }
     void updateUniformLogic();
 
+    // 分块渲染: 上屏 Pass 只画整幅画面 (视口尺寸) 中的 rect 一块 (左上角为原点，可超出画面)
+    // iResolution 仍为整幅尺寸，gl_FragCoord 与 v_texCoord 按本块偏移；yUp 为后端帧缓冲是否 Y 向上
+    void setScreenTile(const QRect &rect, bool yUp);
+    void clearScreenTile() { m_screenTile = QRect(); }
+    // 只重写上屏 Pass 的 Uniform (同一帧的离屏 Pass 结果不变，逐块切换时使用)
+    void uploadScreenUniforms(QRhiResourceUpdateBatch *rub);
+
+    // 3. 与窗口无关的 Pass 执行
+    // executeOffscreen: 按需重建资源、上传 Uniform，并录制全部离屏 Pass (需在渲染通道外调用)
+    // executeScreen:    在调用方已经开始的渲染通道中绘制上屏 Pass
+    void executeOffscreen(const FrameContext &ctx);
+    void executeScreen(QRhiCommandBuffer *cb, const QRhiViewport &viewport);
+
+    // 按需创建通用资源、底图与各 Pass 管线 (需在一帧之内调用)
+    void createPipelines(const FrameContext &ctx);
+
 public slots:
-    // 渲染槽函数
+    // 渲染槽函数 (窗口模式)
     void simulate(); // 离屏渲染
     void render();   // 上屏渲染
 
@@ -48,44 +95,108 @@ public:
     float m_viewportY = 0.0f;
     float m_viewportW = 100.0f; // 给个默认值防止刚启动时黑屏
     float m_viewportH = 100.0f;
+    int resizeSettleMs = 150;     // 视口尺寸稳定多久后才重新分配渲染目标 (0: 立即)
+    bool asyncTextureLoads = true; // 底图在线程池中加载 (false: 当帧等待加载完成，用于无窗口渲染)
 
     QQuickWindow *m_window = nullptr;
     RenderParams m_params;
-    std::mutex mux;
+    // 同一窗口所有渲染器共用的顶点缓冲、采样器、Shader、管线与底图 (最先声明，最后析构)
+    // 窗口模式由 RhiPingPongItem 设置；为空时首次创建管线时建一个私有的
+    std::shared_ptr<RhiSharedContext> shared;
+    std::shared_ptr<RenderStateChannel> stateChannel;   // 与 RhiPingPongItem 共享 (无窗口模式为空)
+
+    // 以下配置只在渲染线程读写: 窗口模式由 applyPendingState() 从快照填充，无窗口模式直接设置
 
     //Shader
     QStringList MyShader;
 
     //纹理路径
-    QStringList texUrl = {
-        ":qt/qml/MyRhi/assets/others/noiseInit.png",
-        ":qt/qml/MyRhi/assets/others/picInit.jpg",
-        ":qt/qml/MyRhi/assets/others/other.png"
-    };
+    QStringList texUrl = defaultTexUrls();
 
     //核心控制变量
     int loopNum = 0;              // 总Pass数量
-    bool isReset = false;         // 重置标志
-    bool picIsReset = false;      // 图片重置标注
-    std::vector<int> inputBindOrder; //绑定关系数组
+    bool isReset = false;         // 配置变化标志 (init 与现有 Pass 对比，只重建变化的部分)
+    bool picIsReset = false;      // 强制重新加载全部底图 (路径变化会自动检测)
+    std::vector<int> inputBindOrder; //绑定关系数组 (旧接口，单输入)
+    std::vector<PassChannels> channelBindings; // 每个 Pass 的 4 个 iChannel 声明 (优先于 inputBindOrder)
+    std::vector<PassTarget> targetSpecs;       // 每个 Pass 的分辨率与格式 (缺省为视口尺寸 RGBA16F)
+    std::vector<quint32> passUsage;            // 每个 Pass 读取的随帧变化 Uniform (缺省为全部，即每帧渲染)
 
     //核心管线容器
     std::vector<std::unique_ptr<RenderPass>> renderPass;
 
-    // RHI: 通用资源
-    std::unique_ptr<QRhiBuffer> m_vBuf;
+    // RHI: 本渲染器独有的资源 (Uniform 与渲染目标随视口和帧参数变化，不共享)
     std::unique_ptr<QRhiBuffer> m_uBuf;
-    std::unique_ptr<QRhiSampler> m_sampler;
-    std::unique_ptr<QRhiTexture> m_bgTex[3];
-    std::unique_ptr<QRhiRenderPassDescriptor> rpDesc;
+    std::shared_ptr<QRhiTexture> m_bgTex[3];   // 底图，与同窗口中路径、尺寸相同的渲染器共用
+    TexturePool m_targetPool;                  // 离屏 Pass 的渲染目标 (跨 Pass 别名、跨重建复用)
+
+    // 每个 Pass 的 CPU 录制耗时与整帧 GPU 耗时 (仅渲染线程读写)
+    PassTimingStats m_timing;
 
 private:
 
-    void createPipelines(QRhi *rhi);
-    QShader getShader(const QString &name);
-    std::vector<float> m_vertexData;
-    ShaderToyUniforms m_currentUniforms;
-    bool m_isVertexUploaded = false;
+    QRhiTexture *resolveChannel(const ChannelInput &in, int parity) const;
+    QRhiSampler *resolveSampler(QRhi *rhi, const ChannelInput &in, QRhiTexture *tex);
+    QSize passOutputSize(int index) const;
+    // 第 step 个模拟步中 Pass index 的 Uniform 在缓冲中的偏移 (绘制时作为动态偏移传入)
+    quint32 uniformOffset(int step, int index) const { return quint32(step * (int)renderPass.size() + index) * m_uniformStride; }
+    void recordStep(const FrameContext &ctx, int step, bool mouseChanged);
+    // 累积模式: 检查重置条件并准备累积目标与管线，返回本帧是否累积
+    bool prepareAccumulation(const FrameContext &ctx);
+    void recordAccumulationSample(const FrameContext &ctx);
+    void invalidateTextureReaders(int textureSlot);   // 底图内容变了，读取它的缓存 Pass 需要重绘
+    static QRhiTexture::Format rhiFormat(PassFormat format);
+    // 设备可作为渲染目标的格式: 不支持请求的格式时依次退回 RGBA16F、RGBA8
+    static QRhiTexture::Format renderTargetFormat(QRhi *rhi, PassFormat format);
+    float m_dpr = 1.0f;
+    int m_parity = 0;               // 帧奇偶: 双缓冲 Pass 本帧写入的槽位
+
+    // 增量重建状态
+    QSize m_targetViewport;         // 当前渲染目标对应的视口尺寸
+    bool m_resourcesDirty = true;   // 资源有变化，需要校验各 Pass 的 SRB 与管线
+    quint32 m_uniformGeneration = 0;
+    QSize m_pendingViewport;        // 最近一次观察到的视口尺寸 (可能尚未稳定)
+    quint64 m_appliedConfigVersion = 0;   // 已应用的配置快照版本
+
+    // 静态 Pass 的脏标记: 上一次渲染时的鼠标状态 (读 iMouse 的可缓存 Pass 仅在其变化时重绘)
+    QPointF m_renderedMousePos;
+    bool m_renderedPressed = false;
+    int m_skippedPasses = 0;
+    QRect m_screenTile;             // 分块渲染的当前块 (空: 不分块)
+    bool m_screenTileYUp = true;
+    QElapsedTimer m_resizeTimer;    // 视口尺寸最后一次变化后的计时
+
+    // 底图的异步加载状态
+    struct BackgroundSlot {
+        QString path;               // 当前纹理的路径
+        QSize fitSize;              // 当前纹理的填充尺寸
+        quint64 ticket = 0;         // 等待中的加载请求 (0: 无)
+        QString pendingPath;
+        QSize pendingFit;
+        bool nativeSize = false;    // 压缩纹理保持原尺寸，视口变化时无需重载
+        std::shared_ptr<CompressedTexture> mapped;   // 上传源数据的文件映射，纹理替换前保持有效
+    };
+    BackgroundSlot m_bgSlots[3];
+    TextureLoader m_textureLoader;
+    std::vector<int> m_execOrder;   // 存活离屏 Pass 的执行顺序 (RenderGraph 拓扑序)
+    std::vector<QRhiTexture::Format> m_targetFormats;   // 每个 Pass 实际分配的格式 (设备不支持时与 target.format 不同)
+    std::vector<ShaderToyUniforms> m_passUniforms;   // 每个 Pass 一份 (iResolution/iChannelResolution 各不相同)
+    quint32 m_uniformStride = 0;                     // Uniform Buffer 中每个 Pass 的对齐步长
+    int m_uniformSteps = 1;                          // 本帧上传了几步的 Uniform (上屏 Pass 使用最后一步)
+    QRhiBuffer *m_vBuf = nullptr;     // 共享的全屏四边形 (归 shared 所有)
+    QRhiTexture *m_dummyTex = nullptr; // 未绑定通道使用的 1x1 黑色纹理 (归 shared 所有)
+    QRhiRenderPassDescriptor *m_screenRpDesc = nullptr;   // 本帧上屏 Pass 所在渲染通道 (ctx.screenRpDesc)
+
+    // 累积模式: 上屏 Shader 写入累积纹理，上屏时画累积结果
+    Accumulator m_accumulator;
+    bool m_accumulating = false;
+    bool m_accumDirty = true;       // 配置、底图或渲染目标变化，需要从头累积
+    float m_accumTime = 0.0f;       // 当前累积对应的输入 (任一变化即重置)
+    QPointF m_accumMouse;
+    bool m_accumPressed = false;
+    quint32 m_accumEpoch = 0;
+    QString m_accumShader;          // 累积管线对应的上屏 Shader
+    std::shared_ptr<QRhiGraphicsPipeline> m_accumPipeline[2];   // [0] 第一个样本直接覆盖，[1] 之后按 1/(n+1) 混合
 };
 
 #endif // MYRHIITEM_H
@@ -1,30 +1,53 @@
 #include "rhipingpongitem.h"
 #include "myrhiitem.h"
-#include <QProcess>
+#include "ShaderCache.h"
+#include <QFileInfo>
+#include <QTimer>
 
 RhiPingPongItem::RhiPingPongItem() {
     connect(this, &QQuickItem::windowChanged, this, &RhiPingPongItem::handleWindowChanged);
-    process = new QProcess(this);
-
+    m_compiler = new ShaderCompiler(this);
+    m_timingModel = new PassTimingModel(this);
+    connect(m_compiler, &ShaderCompiler::batchFinished, this, &RhiPingPongItem::handleCompileFinished);
+
+    m_clock.start();
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout, this, [this]() {
+        if (window() && !m_throttled) window()->update();
+    });
+    connect(this, &QQuickItem::visibleChanged, this, &RhiPingPongItem::updateThrottle);
 }
 
-RhiPingPongItem::~RhiPingPongItem() { releaseResources(); }
+RhiPingPongItem::~RhiPingPongItem() {
+    releaseResources();
+    ShaderCache::instance().unpin(m_liveConfig.shaders);
+}
 
 // ... (属性 Setters 保持不变) ...
 void RhiPingPongItem::setT(float t) {
     if (m_t == t) return;
+    // 外部设定的时间作为时钟的新起点
+    m_clockOffset = t - m_clock.nsecsElapsed() / 1e9;
+    m_simClock.reset(t);
+    m_pendingSteps = 0;
+    m_forceStep = true;
     m_t = t;
     emit tChanged();
+    scheduleFrame();
 }
 void RhiPingPongItem::setMousePos(QPointF p) {
     if (m_mousePos == p) return;
     m_mousePos = p;
     emit mousePosChanged();
+    scheduleFrame();
 }
 void RhiPingPongItem::setIsPressed(bool p) {
     if (m_isPressed == p) return;
     m_isPressed = p;
     emit isPressedChanged();
+    scheduleFrame();
 }
 
 // =================================================================
@@ -36,29 +59,19 @@ void RhiPingPongItem::sync() {
     if (!m_renderer) {
         m_renderer = new SquircleRenderer();
         m_renderer->m_window = window();
-        connect(window(), &QQuickWindow::beforeRendering, m_renderer, &SquircleRenderer::simulate, Qt::DirectConnection);
-        connect(window(), &QQuickWindow::beforeRenderPassRecording, m_renderer, &SquircleRenderer::render, Qt::DirectConnection);
-
-        // 【核心修复】: 刚复活时，注入之前的记忆 (缓存数据)
-        // 这样 init() 就不会因为数据为空而报错或崩溃
-        if (m_cacheLoopNum > 0 && !m_cacheShaders.isEmpty()) {
-            m_renderer->mux.lock();
-            m_renderer->loopNum = m_cacheLoopNum;
-            m_renderer->MyShader = m_cacheShaders;
-
-            // 只有当纹理缓存不为空时才覆盖默认值
-            if (!m_cacheTexUrls.isEmpty()) {
-                m_renderer->texUrl = m_cacheTexUrls;
-            }
-
-            m_renderer->inputBindOrder = m_cacheBindOrder;
-
-            // 只有当绑定数据齐全时，才标记 Reset 触发初始化
-            if (!m_cacheBindOrder.empty()) {
-                m_renderer->isReset = true;
-            }
-            m_renderer->mux.unlock();
-        }
+        // 同窗口的所有预览共用一个上下文: 共享资源与缓存，且由它按注册顺序统一驱动各渲染器
+        m_renderer->shared = RhiSharedContext::forWindow(window());
+        if (m_renderer->shared) m_renderer->shared->addRenderer(m_renderer);
+
+        m_renderer->stateChannel = m_state;
+        m_forceStep = true;
+
+        // 刚复活时重新发布最近的配置，新渲染器由此恢复 Shader、绑定与底图
+        // (sync 期间 GUI 线程阻塞，这里与 GUI 线程的 publishConfig 不会并发，仍满足单生产者)
+        PassConfigSnapshot &config = m_state->config.back();
+        config = m_liveConfig;
+        m_state->config.publish();
+        m_replayConfig = -1;    // 回放中: 下面重新发布录制的配置
     }
 
     const qreal dpr = window()->effectiveDevicePixelRatio();
@@ -66,21 +79,87 @@ void RhiPingPongItem::sync() {
     // 计算 Item 在窗口中的绝对位置
     QPointF itemPos = this->mapToScene(QPointF(0, 0));
 
-    // 赋值给 renderer 的成员变量
-    m_renderer->m_viewportX = (float)(itemPos.x() * dpr);
-    m_renderer->m_viewportY = (float)(itemPos.y() * dpr);
-    m_renderer->m_viewportW = (float)(width() * dpr);
-    m_renderer->m_viewportH = (float)(height() * dpr);
+    // 视口与参数整体写入帧快照，渲染线程在下一次 simulate() 开始时一次性取走
+    FrameSnapshot &frame = m_state->frame.back();
+    frame.viewport = QRectF(itemPos.x() * dpr, itemPos.y() * dpr, width() * dpr, height() * dpr);
+    frame.params = RenderParams();
+    if (m_accumulate) {
+        // 累积模式: iTime 停在进入累积时的时刻 (画面静止才能累积)，iFrame 继续递增作为随机数种子
+        frame.params.time = m_t;
+        frame.params.frame = m_frameIndex++;
+    } else if (m_fixedStep) {
+        // 本帧执行 [next - steps, next) 这几步；0 步时只重画上屏 Pass，Uniform 取最后完成的一步
+        if (m_forceStep && m_pendingSteps == 0) m_pendingSteps = m_simClock.advance(0.0, 1);
+        m_forceStep = false;
+        const qint64 first = m_simClock.nextStep() - std::max(1, m_pendingSteps);
+        frame.params.time = (float)m_simClock.timeAt(std::max<qint64>(0, first));
+        frame.params.timeDelta = (float)m_simClock.stepDelta();
+        frame.params.frame = (int)std::max<qint64>(0, first);
+        frame.params.simulationSteps = m_pendingSteps;
+        m_pendingSteps = 0;
+    } else {
+        frame.params.time = m_t;
+        frame.params.timeDelta = std::max(0.0f, m_t - m_lastFrameT);
+        frame.params.frame = m_frameIndex++;
+    }
+    frame.params.screenSize = window()->size();
+    frame.params.mousePos = m_mousePos;
+    frame.params.isPressed = m_isPressed;
+    frame.params.accumulate = m_accumulate;
+    frame.params.sampleBudget = m_sampleBudget;
+    frame.params.convergenceThreshold = (float)m_convergenceThreshold;
+    frame.params.accumulationEpoch = m_accumEpoch;
+
+    // 录制与回放按同样的口径采样耗时: 上一次 sync 到本次的间隔 + 最近完成的 GPU 帧
+    if (m_replayer) {
+        if (!replayFrame(frame, itemPos * dpr))
+            QMetaObject::invokeMethod(this, &RhiPingPongItem::stopReplay, Qt::QueuedConnection);
+    } else if (m_recorder) {
+        m_recorder->recordFrame(frame, sampleFrameTiming());
+    }
+    m_state->frame.publish();
+    m_lastFrameT = m_t;
+
+    // 约每半秒刷新一次统计，避免频繁重置 QML 模型
+    if (++m_syncCount % 30 == 0) {
+        const QList<PassTimingRow> rows = m_renderer->m_timing.snapshot();
+        QMetaObject::invokeMethod(m_timingModel, [model = m_timingModel, rows]() {
+            model->setRows(rows);
+        }, Qt::QueuedConnection);
+    }
+}
 
+FrameTiming RhiPingPongItem::sampleFrameTiming()
+{
+    FrameTiming timing;
+    if (m_syncTimer.isValid()) timing.frameMs = m_syncTimer.nsecsElapsed() / 1e6;
+    m_syncTimer.start();
+    timing.gpuMs = m_renderer->m_timing.lastGpuFrameMs();
+    return timing;
+}
 
-    RenderParams params;
-    params.time = m_t;
-    params.frame = (int)(m_t * 60.0f);
-    params.screenSize = window()->size();
-    params.mousePos = m_mousePos;
-    params.isPressed = m_isPressed;
+bool RhiPingPongItem::replayFrame(FrameSnapshot &frame, const QPointF &origin)
+{
+    const FrameTiming timing = sampleFrameTiming();
+    if (m_replayer->atEnd()) return false;
+
+    const PassConfigSnapshot *changed = nullptr;
+    const RecordedFrame &recorded = m_replayer->next(&changed);
+    m_replayer->recordTiming(m_replayer->position() - 1, timing);
+
+    // 录制的配置变化 (或渲染器重建) 时整体发布；版本号沿用 Item 的计数，保证单调递增
+    if (recorded.config != m_replayConfig) {
+        m_replayConfig = recorded.config;
+        PassConfigSnapshot &config = m_state->config.back();
+        config = m_replayer->config(recorded.config);
+        config.version = ++m_liveConfig.version;
+        m_state->config.publish();
+    }
 
-    m_renderer->setParams(params);
+    // 视口只取录制时的尺寸，位置跟随当前的 Item
+    frame.viewport = QRectF(origin, recorded.frame.viewport.size());
+    frame.params = recorded.frame.params;
+    return true;
 }
 
 // ... (cleanup, handleWindowChanged, releaseResources 保持不变) ...
@@ -92,8 +171,13 @@ void RhiPingPongItem::handleWindowChanged(QQuickWindow *win) {
     if (win) {
         connect(win, &QQuickWindow::beforeSynchronizing, this, &RhiPingPongItem::sync, Qt::DirectConnection);
         connect(win, &QQuickWindow::sceneGraphInvalidated, this, &RhiPingPongItem::cleanup, Qt::DirectConnection);
+        // 帧调度: 出帧前推进时钟，帧完成后 (渲染线程发出，排队到 GUI 线程) 决定是否需要下一帧
+        connect(win, &QQuickWindow::afterAnimating, this, &RhiPingPongItem::advanceClock);
+        connect(win, &QQuickWindow::frameSwapped, this, &RhiPingPongItem::handleFrameSwapped, Qt::QueuedConnection);
+        connect(win, &QWindow::visibilityChanged, this, &RhiPingPongItem::updateThrottle);
         win->setColor(Qt::black);
     }
+    updateThrottle();
 }
 void RhiPingPongItem::releaseResources() {
     if (window() && m_renderer) {
@@ -108,39 +192,6 @@ void RhiPingPongItem::releaseResources() {
     }
 }
 
-// ... (convertToQsb 保持不变) ...
-QString RhiPingPongItem::convertToQsb(const QString &fileUrl) {
-    QString appDir = QCoreApplication::applicationDirPath();
-    QString qsbPath = appDir + "/compiler/qsb.exe";
-    if (!QFile::exists(qsbPath)) return QString();
-
-    QString localInputPath;
-    if (fileUrl.startsWith("file:")) localInputPath = QUrl(fileUrl).toLocalFile();
-    else localInputPath = fileUrl;
-
-    if (!QFile::exists(localInputPath)) return QString();
-
-    QString outPutDir = appDir + "/qsbfile/";
-    QDir outputDir(outPutDir);
-    if (!outputDir.exists()) outputDir.mkpath(".");
-
-    QString filename = QFileInfo(localInputPath).fileName();
-    QString finalOutputPath = outPutDir + filename + ".qsb";
-
-    QStringList args;
-    args << "--glsl" << "310 es,440" << "--hlsl" << "50" << "--msl" << "12";
-    args << "-o" << finalOutputPath << localInputPath;
-
-    process->setWorkingDirectory(QFileInfo(qsbPath).absolutePath());
-    process->setProgram(qsbPath);
-    process->setArguments(args);
-    process->start();
-
-    if (!process->waitForFinished(5000)) return QString();
-    if (process->exitCode() == 0) return finalOutputPath;
-    else return QString();
-}
-
 // =================================================================
 // 交互函数 (修改：总是更新缓存)
 // =================================================================
@@ -150,32 +201,56 @@ void RhiPingPongItem::getFile(const QStringList &fileList)
     // 不再检查 !m_renderer，允许在关闭状态下编译
     if (fileList.count() < 1) return;
 
-    int newLoopNum = fileList.count();
-    QStringList finalPaths;
+    // 新的 Shader 来了，旧绑定失效 (随后的 getArr/getChannels/getTargets 会重新填充)
+    m_cacheBindOrder.clear();
+    m_cacheChannels.clear();
+    m_cacheTargets.clear();
+
+    // 投递到线程池并行编译，结果在 handleCompileFinished 中生效
+    // 旧批次若尚未完成，其结果会因批次号不匹配而被丢弃
+    const bool wasCompiling = compiling();
+    m_pendingSources = fileList;
+    m_compileBatchId = m_compiler->compileAll(fileList);
+    if (!wasCompiling) emit compilingChanged();
+}
 
-    for (const QString &path : fileList) {
-        QString result = convertToQsb(path);
-        if (!result.isEmpty()) finalPaths.append(result);
-        else return;
+void RhiPingPongItem::handleCompileFinished(int batchId, const QList<ShaderCompileResult> &results)
+{
+    if (batchId != m_compileBatchId) return;
+    m_compileBatchId = 0;
+    emit compilingChanged();
+
+    const ShaderCache &cache = ShaderCache::instance();
+    qDebug() << "[ShaderCache] hits:" << cache.hits() << "misses:" << cache.misses()
+             << "size:" << cache.totalBytes() << "/" << cache.maxBytes();
+    emit shaderCacheStatsChanged();
+
+    QStringList finalPaths;
+    for (const ShaderCompileResult &r : results) {
+        if (r.ok()) finalPaths.append(r.qsbPath);
+        else emit shaderError(r.passIndex, r.sourcePath, r.errorMessage);
     }
 
-    if (finalPaths.count() != fileList.count()) return;
+    // 任意一个 Pass 失败则保留旧的管线
+    if (finalPaths.isEmpty() || finalPaths.count() != results.count()) {
+        emit shadersCompiled(false);
+        return;
+    }
 
     // 1. 更新缓存
-    m_cacheLoopNum = newLoopNum;
+    m_cacheLoopNum = finalPaths.count();
     m_cacheShaders = finalPaths;
-    m_cacheBindOrder.clear(); // 新的 Shader 来了，旧绑定失效
 
-    // 2. 如果 Renderer 活着，同步更新它
-    if (m_renderer) {
-        m_renderer->mux.lock();
-        m_renderer->loopNum = newLoopNum;
-        m_renderer->MyShader = finalPaths;
-        m_renderer->inputBindOrder.clear();
-        m_renderer->isReset = true;
-        m_renderer->mux.unlock();
-        window()->update();
-    }
+    QStringList passNames;
+    for (const QString &src : m_pendingSources) passNames.append(QFileInfo(src).fileName());
+    m_timingModel->setPassNames(passNames);
+
+    // 2. 发布新配置 (编译期间到达的 getArr/getChannels/getTargets 也在这里一起生效)
+    m_cacheUsage.clear();
+    for (const ShaderCompileResult &r : results) m_cacheUsage.push_back(r.uniformUsage);
+    publishConfig(true);
+
+    emit shadersCompiled(true);
 }
 
 void RhiPingPongItem::getArr(const QList<int> &arr)
@@ -185,15 +260,58 @@ void RhiPingPongItem::getArr(const QList<int> &arr)
     for(int i=0; i<arr.count(); i++) {
         m_cacheBindOrder.push_back(arr[i]);
     }
+    m_cacheChannels.clear();
 
-    // 2. 如果 Renderer 活着，同步更新它
-    if (m_renderer) {
-        m_renderer->mux.lock();
-        m_renderer->inputBindOrder = m_cacheBindOrder;
-        m_renderer->isReset = true;
-        m_renderer->mux.unlock();
-        window()->update();
+    // 2. 如果 Renderer 活着，同步更新它 (编译中则等编译完成后一起生效)
+    if (!compiling()) publishConfig(true);
+}
+
+void RhiPingPongItem::getChannels(const QVariantList &passChannels)
+{
+    // 1. 解析并更新缓存
+    m_cacheChannels.clear();
+    for (const QVariant &passVar : passChannels) {
+        PassChannels channels;
+        const QVariantList list = passVar.toList();
+        for (int c = 0; c < kMaxChannels && c < list.count(); ++c) {
+            const QVariantMap m = list[c].toMap();
+            const QString type = m.value("type").toString();
+            ChannelInput &in = channels[c];
+            in.index = m.value("index", -1).toInt();
+            if (type == "pass") in.source = ChannelSource::Pass;
+            else if (type == "prev") in.source = ChannelSource::PreviousFrame;
+            else if (type == "texture") in.source = ChannelSource::Texture;
+            else in = ChannelInput();
+            // 未指定或无法识别时保持默认 (linear / clamp)
+            ChannelInput::parseFilter(m.value("filter").toString(), &in.filter);
+            ChannelInput::parseWrap(m.value("wrap").toString(), &in.wrap);
+        }
+        m_cacheChannels.push_back(channels);
+    }
+
+    // 2. 发布给渲染线程 (编译中则等编译完成后一起生效)
+    if (!compiling()) publishConfig(true);
+}
+
+void RhiPingPongItem::getTargets(const QVariantList &passTargets)
+{
+    // 1. 解析并更新缓存
+    m_cacheTargets.clear();
+    for (const QVariant &v : passTargets) {
+        const QVariantMap m = v.toMap();
+        PassTarget target;
+        target.scale = std::clamp(m.value("scale", 1.0).toFloat(), 1.0f / 16.0f, 4.0f);
+        const int w = m.value("width", 0).toInt();
+        const int h = m.value("height", 0).toInt();
+        if (w > 0 && h > 0) target.fixedSize = QSize(w, h);
+        const QString format = m.value("format", "rgba16f").toString();
+        if (!PassTarget::parseFormat(format, &target.format))
+            qWarning() << "[Target] Unknown format" << format << ", using rgba16f.";
+        m_cacheTargets.push_back(target);
     }
+
+    // 2. 发布给渲染线程 (编译中则等编译完成后一起生效)
+    if (!compiling()) publishConfig(true);
 }
 
 void RhiPingPongItem::getTexUrl(const QStringList &texUrl)
@@ -201,23 +319,340 @@ void RhiPingPongItem::getTexUrl(const QStringList &texUrl)
     // 1. 更新缓存
     m_cacheTexUrls = texUrl;
 
-    // 2. 如果 Renderer 活着，同步更新它
-    if (m_renderer) {
-        m_renderer->mux.lock();
-        m_renderer->texUrl = texUrl;
-        m_renderer->picIsReset = true;
-        m_renderer->isReset = true;
-        m_renderer->mux.unlock();
+    // 2. 发布给渲染线程 (只有路径变化的底图会重新加载，Pass 与管线不受影响)
+    //    编译进行中也立即生效，Pass 部分沿用上一次发布的配置
+    publishConfig(false);
+}
+
+void RhiPingPongItem::publishConfig(bool includePasses)
+{
+    if (includePasses) {
+        // 已发布的 .qsb 保持 pin，渲染器重建或配置重发时仍能从缓存目录加载
+        ShaderCache::instance().pin(m_cacheShaders);
+        ShaderCache::instance().unpin(m_liveConfig.shaders);
+        m_liveConfig.loopNum = m_cacheLoopNum;
+        m_liveConfig.shaders = m_cacheShaders;
+        m_liveConfig.bindOrder = m_cacheBindOrder;
+        m_liveConfig.channels = m_cacheChannels;
+        m_liveConfig.targets = m_cacheTargets;
+        m_liveConfig.uniformUsage = m_cacheUsage;
+        m_forceStep = true;
+    }
+    m_liveConfig.texUrls = m_cacheTexUrls;
+    m_liveConfig.version++;
+
+    // 回放期间只更新缓存，结束回放时再发布
+    if (m_replayer) {
+        updateAnimated();
+        return;
+    }
+    if (m_recorder) m_recorder->recordConfig(m_liveConfig);
+
+    // GUI 线程只写自己的槽位，渲染线程正在使用的快照不受影响
+    m_state->config.back() = m_liveConfig;
+    m_state->config.publish();
+
+    updateAnimated();
+    scheduleFrame();
+}
+
+int RhiPingPongItem::shaderCacheHits() const
+{
+    return (int)ShaderCache::instance().hits();
+}
+
+int RhiPingPongItem::shaderCacheMisses() const
+{
+    return (int)ShaderCache::instance().misses();
+}
+
+bool RhiPingPongItem::dumpTimingsCsv(const QString &filePath) const
+{
+    return m_timingModel->dumpCsv(filePath);
+}
+
+bool RhiPingPongItem::startRecording(const QString &filePath)
+{
+    if (m_replayer) {
+        qWarning() << "[Record] Cannot record while replaying.";
+        return false;
+    }
+    auto recorder = std::make_unique<InputRecorder>();
+    QString error;
+    if (!recorder->open(filePath, &error)) {
+        qWarning() << "[Record] Cannot open" << filePath << error;
+        return false;
+    }
+    // 当前工程作为第一条配置，之后的变化在 publishConfig 中追加
+    recorder->recordConfig(m_liveConfig);
+    const bool wasRecording = recording();
+    m_recorder = std::move(recorder);
+    m_syncTimer.invalidate();
+    if (!wasRecording) emit recordingChanged();
+    scheduleFrame();
+    return true;
+}
+
+void RhiPingPongItem::stopRecording()
+{
+    if (!m_recorder) return;
+    m_recorder.reset();
+    emit recordingChanged();
+}
+
+bool RhiPingPongItem::startReplay(const QString &filePath, const QString &timingsCsv)
+{
+    auto replayer = std::make_unique<InputReplayer>();
+    QString error;
+    if (!replayer->open(filePath, &error)) {
+        qWarning() << "[Replay] Cannot open" << filePath << error;
+        return false;
     }
+    stopRecording();
+    stopReplay();
+    m_replayer = std::move(replayer);
+    m_replayTimingsPath = timingsCsv;
+    m_replayConfig = -1;
+    m_syncTimer.invalidate();
+    m_frameTimer->stop();
+    emit replayingChanged();
+    scheduleFrame();
+    return true;
+}
+
+void RhiPingPongItem::stopReplay()
+{
+    if (!m_replayer) return;
+    const bool complete = m_replayer->atEnd();
+    const QString summary = m_replayer->summary();
+    qDebug() << "[Replay]" << (complete ? "Finished:" : "Stopped:") << summary;
+    if (!m_replayTimingsPath.isEmpty() && !m_replayer->dumpTimingsCsv(m_replayTimingsPath))
+        qWarning() << "[Replay] Cannot write timings to" << m_replayTimingsPath;
+    m_replayer.reset();
+    m_replayConfig = -1;
+    emit replayingChanged();
+
+    // 恢复回放前 (及回放期间更新) 的工程
+    publishConfig(false);
+    emit replayFinished(complete, summary);
 }
 
 void RhiPingPongItem::setRunning(bool r) {
     if (m_running == r) return;
     m_running = r;
     if (m_running) {
+        restartWallClock();
         update(); // 唤醒，触发 sync，注入缓存
     } else {
+        m_frameTimer->stop();
         releaseResources(); // 销毁
     }
     emit runningChanged();
 }
+
+// =================================================================
+// 帧调度
+// =================================================================
+void RhiPingPongItem::setRenderMode(RenderMode mode) {
+    if (m_renderMode == mode) return;
+    m_renderMode = mode;
+    m_frameTimer->stop();
+    qDebug() << "[Render] Mode:" << mode;
+    emit renderModeChanged();
+    scheduleFrame();
+}
+
+void RhiPingPongItem::setMaxFps(int fps) {
+    fps = std::clamp(fps, 1, 240);
+    if (m_maxFps == fps) return;
+    m_maxFps = fps;
+    emit maxFpsChanged();
+}
+
+void RhiPingPongItem::setFixedStep(bool enabled) {
+    if (m_fixedStep == enabled) return;
+    m_fixedStep = enabled;
+    // 两种时钟互相接续: 开启时从当前 t 所在的步开始，关闭时自由时钟从模拟时间继续
+    if (enabled) {
+        m_simClock.reset(m_t);
+        m_lastWallTime = -1.0;
+        m_pendingSteps = 0;
+        m_forceStep = true;
+    } else {
+        m_clockOffset = m_simClock.time() - m_clock.nsecsElapsed() / 1e9;
+        m_lastFrameT = m_t;
+    }
+    qDebug() << "[Render] Fixed step:" << enabled << "at" << m_simClock.stepRate() << "Hz";
+    emit fixedStepChanged();
+    scheduleFrame();
+}
+
+void RhiPingPongItem::setStepRate(double hz) {
+    const double before = m_simClock.stepRate();
+    m_simClock.setStepRate(hz);
+    if (m_simClock.stepRate() != before) emit stepRateChanged();
+}
+
+void RhiPingPongItem::setMaxStepsPerFrame(int steps) {
+    const int before = m_simClock.maxStepsPerFrame();
+    m_simClock.setMaxStepsPerFrame(steps);
+    if (m_simClock.maxStepsPerFrame() != before) emit maxStepsPerFrameChanged();
+}
+
+void RhiPingPongItem::setAccumulate(bool enabled) {
+    if (m_accumulate == enabled) return;
+    m_accumulate = enabled;
+    if (!enabled) {
+        // 时钟从累积期间停住的 t 继续
+        m_clockOffset = m_t - m_clock.nsecsElapsed() / 1e9;
+        m_simClock.reset(m_t);
+        m_lastWallTime = -1.0;
+        m_lastFrameT = m_t;
+        m_forceStep = true;
+    }
+    qDebug() << "[Render] Accumulation:" << enabled;
+    emit accumulateChanged();
+    scheduleFrame();
+}
+
+void RhiPingPongItem::setSampleBudget(int samples) {
+    samples = std::max(0, samples);
+    if (m_sampleBudget == samples) return;
+    m_sampleBudget = samples;
+    emit sampleBudgetChanged();
+    scheduleFrame();   // 上限提高后继续累积
+}
+
+void RhiPingPongItem::setConvergenceThreshold(double threshold) {
+    threshold = std::max(0.0, threshold);
+    if (m_convergenceThreshold == threshold) return;
+    m_convergenceThreshold = threshold;
+    emit convergenceThresholdChanged();
+    scheduleFrame();
+}
+
+void RhiPingPongItem::restartAccumulation() {
+    m_accumEpoch++;
+    scheduleFrame();
+}
+
+void RhiPingPongItem::updateAccumulationProgress() {
+    const int samples = m_state->accumulatedSamples.load(std::memory_order_relaxed);
+    const bool done = m_state->accumulationFinished.load(std::memory_order_acquire);
+    if (samples == m_sampleCount && done == m_accumulationDone) return;
+    if (done && !m_accumulationDone) qDebug() << "[Render] Accumulation finished at" << samples << "samples, frames paused.";
+    m_sampleCount = samples;
+    m_accumulationDone = done;
+    emit accumulationProgressChanged();
+}
+
+void RhiPingPongItem::advanceClock() {
+    if (!m_running || m_throttled) return;   // 隐藏时窗口里的其他 Item 仍可能出帧
+    if (m_accumulate) {
+        m_sinceLastFrame.start();
+        return;
+    }
+    float now = (float)(m_clockOffset + m_clock.nsecsElapsed() / 1e9);
+    if (m_fixedStep) {
+        // 真实时间只决定步数，t 显示为已完成的模拟时间
+        const double wall = m_clock.nsecsElapsed() / 1e9;
+        const double elapsed = m_lastWallTime < 0.0 ? 0.0 : wall - m_lastWallTime;
+        m_lastWallTime = wall;
+        const qint64 dropped = m_simClock.droppedSteps();
+        m_pendingSteps += m_simClock.advance(elapsed);
+        if (m_simClock.droppedSteps() != dropped) emit droppedStepsChanged();
+        now = (float)m_simClock.time();
+    }
+    if (now != m_t) {
+        m_t = now;
+        emit tChanged();
+    }
+    m_sinceLastFrame.start();
+}
+
+void RhiPingPongItem::restartWallClock() {
+    // 暂停、隐藏或按需模式空闲期间没有出帧，这段时间不是模拟落后，不能整段补进时钟
+    m_lastWallTime = -1.0;
+    m_simClock.resync();
+}
+
+void RhiPingPongItem::handleFrameSwapped() {
+    updateAccumulationProgress();
+    if (wantsNextFrame()) scheduleFrame();
+    else restartWallClock();   // 空闲: 下一次被唤醒时重新计时
+}
+
+bool RhiPingPongItem::wantsNextFrame() {
+    // 渲染器还有未完成的工作 (视口尚未稳定、底图仍在加载) 时总要补帧
+    const bool rendererBusy = m_state->redrawRequested.exchange(false, std::memory_order_acq_rel);
+    // 回放: 逐帧送完整个录制，与渲染模式无关
+    if (m_replayer) return true;
+    // 累积模式: 收敛或达到样本上限之前逐帧累积，之后与渲染模式无关地停止出帧
+    if (m_accumulate) return rendererBusy || !m_accumulationDone;
+    if (m_renderMode != OnDemand) return true;
+    return m_animated || rendererBusy;
+}
+
+void RhiPingPongItem::scheduleFrame() {
+    QQuickWindow *win = window();
+    if (!win || !m_running || m_throttled) return;
+
+    // 回放不受帧率上限限制，测到的间隔只剩渲染本身与垂直同步
+    if (m_renderMode == CappedFps && m_sinceLastFrame.isValid() && !m_replayer) {
+        const qint64 remaining = 1000 / m_maxFps - m_sinceLastFrame.elapsed();
+        if (remaining > 0) {
+            if (!m_frameTimer->isActive()) m_frameTimer->start((int)remaining);
+            return;
+        }
+    }
+    win->update();
+}
+
+void RhiPingPongItem::updateThrottle() {
+    QQuickWindow *win = window();
+    const bool hidden = !isVisible() || !win || !win->isVisible()
+        || win->visibility() == QWindow::Minimized || win->visibility() == QWindow::Hidden;
+    if (hidden == m_throttled) return;
+
+    m_throttled = hidden;
+    qDebug() << "[Render]" << (hidden ? "Hidden, pausing frames." : "Visible again, resuming frames.");
+    emit throttledChanged();
+    if (hidden) {
+        m_frameTimer->stop();
+    } else {
+        restartWallClock();
+        scheduleFrame();
+    }
+}
+
+void RhiPingPongItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) {
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size()) scheduleFrame();
+}
+
+void RhiPingPongItem::updateAnimated() {
+    // 读取上一帧的 Pass 每帧结果都不同，与是否使用时间无关
+    bool readsPreviousFrame = false;
+    if (!m_liveConfig.channels.empty()) {
+        for (const PassChannels &channels : m_liveConfig.channels) {
+            for (const ChannelInput &in : channels)
+                readsPreviousFrame |= in.source == ChannelSource::PreviousFrame;
+        }
+    } else {
+        // 旧接口: 指向自身或更晚的 Pass 读到的是上一帧
+        const int count = m_liveConfig.loopNum;
+        for (int i = 0; i < (int)m_liveConfig.bindOrder.size(); ++i) {
+            const int idx = m_liveConfig.bindOrder[i];
+            readsPreviousFrame |= idx >= i && idx < count - 1;
+        }
+    }
+
+    bool usesTime = m_liveConfig.uniformUsage.empty() && m_liveConfig.loopNum > 0;
+    for (quint32 usage : m_liveConfig.uniformUsage) usesTime |= (usage & UsesPerFrameUniforms) != 0;
+
+    const bool animated = usesTime || readsPreviousFrame;
+    if (animated == m_animated) return;
+    m_animated = animated;
+    qDebug() << "[Render] Content is" << (animated ? "animated." : "static, on-demand mode will idle.");
+    emit animatedChanged();
+}
@@ -2,9 +2,17 @@
 #define RHIPINGPONGITEM_H
 #include <QObject>
 #include <QQuickItem>
+#include <QElapsedTimer>
+#include "ShaderCompiler.h"
+#include "PassTiming.h"
+#include "StructModel.h"
+#include "RenderState.h"
+#include "SimulationClock.h"
+#include "InputRecording.h"
+#include <memory>
 
 class SquircleRenderer;
-class QProcess;
+class QTimer;
 
 class RhiPingPongItem : public QQuickItem {
     Q_OBJECT
@@ -14,8 +22,42 @@ class RhiPingPongItem : public QQuickItem {
     Q_PROPERTY(bool isPressed READ isPressed WRITE setIsPressed NOTIFY isPressedChanged)
     // 运行控制属性
     Q_PROPERTY(bool running READ running WRITE setRunning NOTIFY runningChanged)
+    // 编译状态 (异步编译进行中)
+    Q_PROPERTY(bool compiling READ compiling NOTIFY compilingChanged)
+    // .qsb 磁盘缓存统计
+    Q_PROPERTY(int shaderCacheHits READ shaderCacheHits NOTIFY shaderCacheStatsChanged)
+    Q_PROPERTY(int shaderCacheMisses READ shaderCacheMisses NOTIFY shaderCacheStatsChanged)
+    // 每个 Pass 的耗时统计 (avg/min/max/p50/p95)
+    Q_PROPERTY(QAbstractItemModel *passTimings READ passTimings CONSTANT)
+    // 帧调度: 连续 / 限帧 / 按需
+    Q_PROPERTY(RenderMode renderMode READ renderMode WRITE setRenderMode NOTIFY renderModeChanged)
+    Q_PROPERTY(int maxFps READ maxFps WRITE setMaxFps NOTIFY maxFpsChanged)
+    // 当前工程的画面是否随时间变化 (使用 iTime/iTimeDelta/iFrame/iDate 或读取上一帧)
+    Q_PROPERTY(bool animated READ animated NOTIFY animatedChanged)
+    // Item 不可见或窗口最小化时暂停出帧
+    Q_PROPERTY(bool throttled READ throttled NOTIFY throttledChanged)
+    // 固定步长模拟: iTime/iFrame 按 stepRate 的整步推进，与显示帧率无关，结果可复现
+    Q_PROPERTY(bool fixedStep READ fixedStep WRITE setFixedStep NOTIFY fixedStepChanged)
+    Q_PROPERTY(double stepRate READ stepRate WRITE setStepRate NOTIFY stepRateChanged)
+    Q_PROPERTY(int maxStepsPerFrame READ maxStepsPerFrame WRITE setMaxStepsPerFrame NOTIFY maxStepsPerFrameChanged)
+    Q_PROPERTY(int droppedSteps READ droppedSteps NOTIFY droppedStepsChanged)
+    // 累积模式 (渐进式路径追踪): 上屏结果逐帧平均，收敛或达到样本上限后停止出帧
+    Q_PROPERTY(bool accumulate READ accumulate WRITE setAccumulate NOTIFY accumulateChanged)
+    Q_PROPERTY(int sampleBudget READ sampleBudget WRITE setSampleBudget NOTIFY sampleBudgetChanged)
+    Q_PROPERTY(double convergenceThreshold READ convergenceThreshold WRITE setConvergenceThreshold NOTIFY convergenceThresholdChanged)
+    Q_PROPERTY(int sampleCount READ sampleCount NOTIFY accumulationProgressChanged)
+    Q_PROPERTY(bool accumulationDone READ accumulationDone NOTIFY accumulationProgressChanged)
+    // 输入录制与回放: 逐帧记录 RenderParams、视口与配置变化，回放时原样送回并记录耗时
+    Q_PROPERTY(bool recording READ recording NOTIFY recordingChanged)
+    Q_PROPERTY(bool replaying READ replaying NOTIFY replayingChanged)
 
 public:
+    // Continuous: 每个 vsync 出一帧 (原行为)
+    // CappedFps:  最多 maxFps 帧/秒
+    // OnDemand:   画面随时间变化时逐帧渲染，否则只在输入、配置或尺寸变化时重绘
+    enum RenderMode { Continuous, CappedFps, OnDemand };
+    Q_ENUM(RenderMode)
+
     RhiPingPongItem();
     ~RhiPingPongItem();
 
@@ -31,19 +73,89 @@ public:
     bool running() const { return m_running; }
     void setRunning(bool r);
 
-    QString convertToQsb(const QString &fileUrl);
+    bool compiling() const { return m_compileBatchId != 0; }
+    int shaderCacheHits() const;
+    int shaderCacheMisses() const;
+    QAbstractItemModel *passTimings() const { return m_timingModel; }
+
+    RenderMode renderMode() const { return m_renderMode; }
+    void setRenderMode(RenderMode mode);
+    int maxFps() const { return m_maxFps; }
+    void setMaxFps(int fps);
+    bool animated() const { return m_animated; }
+    bool throttled() const { return m_throttled; }
+
+    bool fixedStep() const { return m_fixedStep; }
+    void setFixedStep(bool enabled);
+    double stepRate() const { return m_simClock.stepRate(); }
+    void setStepRate(double hz);
+    int maxStepsPerFrame() const { return m_simClock.maxStepsPerFrame(); }
+    void setMaxStepsPerFrame(int steps);
+    int droppedSteps() const { return (int)m_simClock.droppedSteps(); }
+
+    bool accumulate() const { return m_accumulate; }
+    void setAccumulate(bool enabled);
+    int sampleBudget() const { return m_sampleBudget; }
+    void setSampleBudget(int samples);
+    double convergenceThreshold() const { return m_convergenceThreshold; }
+    void setConvergenceThreshold(double threshold);
+    int sampleCount() const { return m_sampleCount; }
+    bool accumulationDone() const { return m_accumulationDone; }
+
+    // 相机等外部参数变化后调用，丢弃已累积的样本重新开始
+    Q_INVOKABLE void restartAccumulation();
+
+    bool recording() const { return m_recorder != nullptr; }
+    bool replaying() const { return m_replayer != nullptr; }
+
+    // 开始录制到 filePath (.srec)，当前配置作为第一条记录
+    Q_INVOKABLE bool startRecording(const QString &filePath);
+    Q_INVOKABLE void stopRecording();
+    // 回放录制文件: 期间忽略本地的时间、鼠标与配置变化，结束后恢复当前工程
+    // timingsCsv 非空时在结束后写出逐帧的录制/回放耗时
+    Q_INVOKABLE bool startReplay(const QString &filePath, const QString &timingsCsv = QString());
+    Q_INVOKABLE void stopReplay();
+
+    // 请求重绘一帧 (按需模式下外部状态变化时调用)
+    Q_INVOKABLE void requestRedraw() { scheduleFrame(); }
+
+    Q_INVOKABLE bool dumpTimingsCsv(const QString &filePath) const;
 
     Q_INVOKABLE void getFile(const QStringList &fileList);
     Q_INVOKABLE void getTexUrl(const QStringList &texUrl);
     Q_INVOKABLE void getArr(const QList<int> &arr);
-
-    QProcess *process = nullptr;
+    // 每个 Pass 最多 4 个 iChannel: [[{type: "pass"|"prev"|"texture"|"none", index: n}, ...], ...]
+    Q_INVOKABLE void getChannels(const QVariantList &passChannels);
+    // 每个 Pass 的渲染目标: [{scale: 0.5, width: 0, height: 0, format: "rgba16f"}, ...]
+    // width/height 均大于 0 时使用固定尺寸，否则按 scale 缩放视口
+    Q_INVOKABLE void getTargets(const QVariantList &passTargets);
 
 signals:
     void tChanged();
     void mousePosChanged();
     void isPressedChanged();
     void runningChanged();
+    void compilingChanged();
+    void shaderCacheStatsChanged();
+    void renderModeChanged();
+    void maxFpsChanged();
+    void animatedChanged();
+    void throttledChanged();
+    void fixedStepChanged();
+    void stepRateChanged();
+    void maxStepsPerFrameChanged();
+    void droppedStepsChanged();
+    void accumulateChanged();
+    void sampleBudgetChanged();
+    void convergenceThresholdChanged();
+    void accumulationProgressChanged();
+    void recordingChanged();
+    void replayingChanged();
+    // 回放结束 (complete: 全部帧均已回放)；summary 为录制与回放耗时的汇总
+    void replayFinished(bool complete, const QString &summary);
+    // 编译结果: 每个失败的 Pass 单独上报，整批结束后发出 shadersCompiled
+    void shaderError(int passIndex, const QString &path, const QString &message);
+    void shadersCompiled(bool success);
 
 public slots:
     void sync();
@@ -51,24 +163,93 @@ public slots:
 
 private slots:
     void handleWindowChanged(QQuickWindow *win);
+    void handleCompileFinished(int batchId, const QList<ShaderCompileResult> &results);
+    void advanceClock();        // 每帧开始前 (GUI 线程): 推进 t
+    void restartWallClock();    // 出帧中断后恢复: 固定步长时钟从下一帧重新计时
+    void handleFrameSwapped();  // 一帧完成后 (由渲染线程投递): 决定是否需要下一帧
+    void updateThrottle();
+
+protected:
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
 
 private:
+    void scheduleFrame();
+    bool wantsNextFrame();
+    void updateAnimated();
+    void updateAccumulationProgress();
+    // 距上一次 sync 的间隔与最近的 GPU 帧耗时 (录制与回放按同样的口径采样)
+    FrameTiming sampleFrameTiming();
+    // 用下一条录制帧覆盖本帧的快照；已全部回放时返回 false
+    bool replayFrame(FrameSnapshot &frame, const QPointF &origin);
+
     void releaseResources();
+    // 由缓存生成一份完整配置并发布给渲染线程 (编译进行中时 Shader 与绑定保持旧的一致组合)
+    void publishConfig(bool includePasses);
     SquircleRenderer *m_renderer = nullptr;
 
+    // 与渲染线程的无锁交接: 配置与帧参数各一个三缓冲快照
+    std::shared_ptr<RenderStateChannel> m_state = std::make_shared<RenderStateChannel>();
+    PassConfigSnapshot m_liveConfig;    // 最近一次发布的配置
+
     float m_t = 0.0f;
     QPointF m_mousePos;
     bool m_isPressed = false;
     bool m_running = true;
 
+    // 帧调度与时钟 (t 由 Item 自己的时钟驱动，只在 GUI 线程推进)
+    RenderMode m_renderMode = Continuous;
+    int m_maxFps = 30;
+    bool m_animated = true;
+    bool m_throttled = false;
+    QElapsedTimer m_clock;
+    double m_clockOffset = 0.0;     // setT() 设定的时间与时钟之差
+    float m_lastFrameT = 0.0f;
+    int m_frameIndex = 0;
+    QElapsedTimer m_sinceLastFrame;
+    QTimer *m_frameTimer = nullptr; // 限帧模式下延后的下一帧
+
+    // 固定步长: advanceClock 按真实时间累计应走的步数，sync 一次交给渲染线程
+    bool m_fixedStep = false;
+    SimulationClock m_simClock;
+    double m_lastWallTime = -1.0;   // 上一次 advanceClock 的真实时间 (< 0: 尚未开始)
+    int m_pendingSteps = 0;         // 已到期、尚未交给渲染线程的步数
+    bool m_forceStep = true;        // 渲染器新建或 Pass 变化后至少执行一步，保证第一帧有内容
+
+    // 累积模式: t 停止推进；进度由渲染线程写入 m_state，出帧后读取
+    bool m_accumulate = false;
+    int m_sampleBudget = 1024;
+    double m_convergenceThreshold = 1e-5;
+    quint32 m_accumEpoch = 0;
+    int m_sampleCount = 0;
+    bool m_accumulationDone = false;
+
+    // 录制与回放: 录制器在 publishConfig (GUI 线程) 与 sync (GUI 线程阻塞) 中写入，不会并发
+    std::unique_ptr<InputRecorder> m_recorder;
+    std::unique_ptr<InputReplayer> m_replayer;
+    QString m_replayTimingsPath;
+    int m_replayConfig = -1;        // 已发布给渲染线程的录制配置
+    QElapsedTimer m_syncTimer;
+
+    // 异步编译
+    ShaderCompiler *m_compiler = nullptr;
+    int m_compileBatchId = 0;       // 正在等待的批次 (0 表示空闲)
+    QStringList m_pendingSources;   // 正在编译的源文件 (用于耗时统计中的 Pass 名称)
+
+    // 耗时统计: 渲染线程在 sync 中定期取快照，投递到 GUI 线程的模型
+    PassTimingModel *m_timingModel = nullptr;
+    int m_syncCount = 0;
+
     // ==========================================
     // 【新增】数据缓存 (Cache)
     // 即使 m_renderer 被销毁，这些数据也会保留
     // ==========================================
     int m_cacheLoopNum = 0;
     QStringList m_cacheShaders;     // 存储编译后的 .qsb 路径
-    QStringList m_cacheTexUrls;     // 存储纹理路径
+    QStringList m_cacheTexUrls = defaultTexUrls(); // 存储纹理路径
     std::vector<int> m_cacheBindOrder; // 存储绑定数组
+    std::vector<PassChannels> m_cacheChannels; // 存储 4 通道绑定 (优先于绑定数组)
+    std::vector<PassTarget> m_cacheTargets;    // 存储每个 Pass 的分辨率与格式
+    std::vector<quint32> m_cacheUsage;         // 每个 Pass 源码读取的随帧变化 Uniform (UniformUsage)
 };
 
 #endif // RHIPINGPONGITEM_H
@@ -0,0 +1,71 @@
+#include <QtTest>
+#include <rhi/qrhi.h>
+#include <memory>
+#include "Accumulator.h"
+
+// ================================================================
+// Accumulator: 混合权重、样本计数与累积目标的分配
+// 使用 QRhi Null 后端，不需要 GPU
+// ================================================================
+class tst_Accumulator : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        QRhiNullInitParams params;
+        m_rhi.reset(QRhi::create(QRhi::Null, &params));
+        QVERIFY(m_rhi);
+    }
+
+    void cleanupTestCase() { m_rhi.reset(); }
+
+    void blendWeights()
+    {
+        // 第 n+1 个样本的权重为 1/(n+1)，纹理中始终是全部样本的平均值
+        Accumulator acc;
+        QCOMPARE(acc.sampleCount(), 0);
+        QCOMPARE(acc.blendConstant().redF(), 1.0f);
+        for (int n = 1; n <= 7; ++n) {
+            acc.sampleAdded();
+            QCOMPARE(acc.sampleCount(), n);
+            // QColor 以 16 位定点保存各通道
+            QVERIFY(qAbs(acc.blendConstant().alphaF() - 1.0f / float(n + 1)) < 1e-4f);
+        }
+        acc.reset();
+        QCOMPARE(acc.sampleCount(), 0);
+        QCOMPARE(acc.blendConstant().greenF(), 1.0f);
+        QVERIFY(!acc.converged());
+        QVERIFY(acc.perSampleDelta() < 0.0);
+    }
+
+    void targetAllocation()
+    {
+        Accumulator acc;
+        QVERIFY(!acc.isReady());
+        QVERIFY(acc.ensureTarget(m_rhi.get(), QSize(64, 32)));
+        QVERIFY(acc.isReady());
+        QVERIFY(acc.renderPassDescriptor());
+
+        // Null 后端不保证 32 位浮点混合: 默认使用 RGBA16F
+        QRhiTexture *texture = acc.renderTarget()->description().colorAttachmentAt(0)->texture();
+        QCOMPARE(texture->format(), QRhiTexture::RGBA16F);
+        QCOMPARE(texture->pixelSize(), QSize(64, 32));
+
+        // 尺寸不变不重新分配，样本保留；尺寸变化时重新分配并清空样本
+        acc.sampleAdded();
+        QVERIFY(!acc.ensureTarget(m_rhi.get(), QSize(64, 32)));
+        QCOMPARE(acc.sampleCount(), 1);
+        QVERIFY(acc.ensureTarget(m_rhi.get(), QSize(32, 32)));
+        QCOMPARE(acc.sampleCount(), 0);
+
+        acc.release();
+        QVERIFY(!acc.isReady());
+    }
+
+private:
+    std::unique_ptr<QRhi> m_rhi;
+};
+
+QTEST_MAIN(tst_Accumulator)
+#include "tst_accumulator.moc"
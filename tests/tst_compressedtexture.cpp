@@ -0,0 +1,361 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include "CompressedTexture.h"
+
+// ================================================================
+// CompressedTexture: KTX / KTX2 / DDS 文件头解析
+// 测试文件在临时目录中按字节拼出，只检查解析结果，不上传
+// ================================================================
+
+namespace {
+
+void putU32(QByteArray &bytes, quint32 v)
+{
+    char buf[4];
+    qToLittleEndian(v, buf);
+    bytes.append(buf, 4);
+}
+
+void putU64(QByteArray &bytes, quint64 v)
+{
+    char buf[8];
+    qToLittleEndian(v, buf);
+    bytes.append(buf, 8);
+}
+
+// ---------------- KTX1 ----------------
+struct KtxDesc {
+    quint32 internalFormat = 0x83F0;    // BC1
+    quint32 width = 8;
+    quint32 height = 8;
+    quint32 faces = 1;
+    quint32 mipLevels = 1;
+    std::vector<quint32> levelBytes;    // 实际写入的各级数据 (可少于 mipLevels 模拟截断)
+};
+
+QByteArray ktx(const KtxDesc &d)
+{
+    static const char id[12] = { char(0xAB), 'K', 'T', 'X', ' ', '1', '1', char(0xBB), '\r', '\n', 0x1A, '\n' };
+    QByteArray bytes(id, 12);
+    putU32(bytes, 0x04030201);      // endianness
+    putU32(bytes, 0);               // glType
+    putU32(bytes, 1);               // glTypeSize
+    putU32(bytes, 0);               // glFormat
+    putU32(bytes, d.internalFormat);
+    putU32(bytes, 0);               // glBaseInternalFormat
+    putU32(bytes, d.width);
+    putU32(bytes, d.height);
+    putU32(bytes, 0);               // depth
+    putU32(bytes, 0);               // arrayElements
+    putU32(bytes, d.faces);
+    putU32(bytes, d.mipLevels);
+    putU32(bytes, 0);               // bytesOfKeyValueData
+    for (quint32 size : d.levelBytes) {
+        putU32(bytes, size);
+        bytes.append(QByteArray(int((size + 3) & ~3u), '\x7f'));
+    }
+    return bytes;
+}
+
+// ---------------- KTX2 ----------------
+struct Ktx2Desc {
+    quint32 vkFormat = 145;             // BC7
+    quint32 width = 4;
+    quint32 height = 4;
+    quint32 faces = 1;
+    quint32 supercompression = 0;
+    std::vector<quint64> levelBytes = { 16 };
+    qint64 dataShortBy = 0;             // 末尾少写的字节数
+};
+
+QByteArray ktx2(const Ktx2Desc &d)
+{
+    static const char id[12] = { char(0xAB), 'K', 'T', 'X', ' ', '2', '0', char(0xBB), '\r', '\n', 0x1A, '\n' };
+    QByteArray bytes(id, 12);
+    putU32(bytes, d.vkFormat);
+    putU32(bytes, 1);               // typeSize
+    putU32(bytes, d.width);
+    putU32(bytes, d.height);
+    putU32(bytes, 0);               // pixelDepth
+    putU32(bytes, 0);               // layerCount
+    putU32(bytes, d.faces);
+    putU32(bytes, quint32(d.levelBytes.size()));
+    putU32(bytes, d.supercompression);
+    for (int i = 0; i < 4; ++i) putU32(bytes, 0);   // dfd / kvd
+    putU64(bytes, 0);               // sgdByteOffset
+    putU64(bytes, 0);               // sgdByteLength
+
+    quint64 offset = 80 + 24 * d.levelBytes.size();
+    for (quint64 size : d.levelBytes) {
+        putU64(bytes, offset);
+        putU64(bytes, size);
+        putU64(bytes, size);
+        offset += size;
+    }
+    quint64 total = 0;
+    for (quint64 size : d.levelBytes) total += size;
+    bytes.append(QByteArray(int(total - d.dataShortBy), '\x7f'));
+    return bytes;
+}
+
+// ---------------- DDS ----------------
+struct DdsDesc {
+    quint32 fourCC = 0x31545844;        // "DXT1"
+    quint32 width = 8;
+    quint32 height = 8;
+    quint32 mipCount = 1;
+    quint32 caps2 = 0;
+    bool dx10 = false;
+    quint32 dxgiFormat = 98;            // BC7
+    quint32 dimension = 3;              // TEXTURE2D
+    quint32 miscFlag = 0;
+    int dataBytes = 32;
+};
+
+QByteArray dds(const DdsDesc &d)
+{
+    QByteArray bytes("DDS ", 4);
+    putU32(bytes, 124);             // dwSize
+    putU32(bytes, 0x1007);          // dwFlags
+    putU32(bytes, d.height);
+    putU32(bytes, d.width);
+    putU32(bytes, 0);               // dwPitchOrLinearSize
+    putU32(bytes, 0);               // dwDepth
+    putU32(bytes, d.mipCount);
+    for (int i = 0; i < 11; ++i) putU32(bytes, 0);
+    putU32(bytes, 32);              // ddspf.dwSize
+    putU32(bytes, 0x4);             // DDPF_FOURCC
+    putU32(bytes, d.dx10 ? 0x30315844 : d.fourCC);  // "DX10"
+    for (int i = 0; i < 5; ++i) putU32(bytes, 0);
+    putU32(bytes, 0x1000);          // dwCaps
+    putU32(bytes, d.caps2);
+    for (int i = 0; i < 3; ++i) putU32(bytes, 0);
+    if (d.dx10) {
+        putU32(bytes, d.dxgiFormat);
+        putU32(bytes, d.dimension);
+        putU32(bytes, d.miscFlag);
+        putU32(bytes, 1);           // arraySize
+        putU32(bytes, 0);           // miscFlags2
+    }
+    bytes.append(QByteArray(d.dataBytes, '\x7f'));
+    return bytes;
+}
+
+} // namespace
+
+class tst_CompressedTexture : public QObject {
+    Q_OBJECT
+
+private:
+    QString write(const QString &name, const QByteArray &bytes)
+    {
+        const QString path = m_dir.filePath(name);
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(bytes) != bytes.size()) return QString();
+        return path;
+    }
+
+    std::shared_ptr<CompressedTexture> open(const QString &name, const QByteArray &bytes, QString *error = nullptr)
+    {
+        const QString path = write(name, bytes);
+        if (path.isEmpty()) return nullptr;
+        return CompressedTexture::open(path, error);
+    }
+
+    QTemporaryDir m_dir;
+
+private slots:
+    void initTestCase() { QVERIFY(m_dir.isValid()); }
+
+    void isTextureFile()
+    {
+        QVERIFY(CompressedTexture::isTextureFile("a/b.KTX"));
+        QVERIFY(CompressedTexture::isTextureFile("b.ktx2"));
+        QVERIFY(CompressedTexture::isTextureFile("c.dds"));
+        QVERIFY(!CompressedTexture::isTextureFile("d.png"));
+    }
+
+    void ktxFullMipChain()
+    {
+        KtxDesc d;
+        d.mipLevels = 4;
+        d.levelBytes = { 32, 8, 8, 8 };     // 8x8, 4x4, 2x2 (不足一块按整块), 1x1
+        auto tex = open("full.ktx", ktx(d));
+        QVERIFY(tex);
+        QCOMPARE(tex->format(), QRhiTexture::BC1);
+        QCOMPARE(tex->size(), QSize(8, 8));
+        QCOMPARE(tex->levelCount(), 4);
+        QCOMPARE(tex->level(2).pixelSize, QSize(2, 2));
+        QVERIFY(tex->flags().testFlag(QRhiTexture::MipMapped));
+        QCOMPARE(tex->totalBytes(), qint64(56));
+    }
+
+    void ktxPartialMipChainUsesLevelZero()
+    {
+        KtxDesc d;
+        d.mipLevels = 2;
+        d.levelBytes = { 32, 8 };
+        auto tex = open("partial.ktx", ktx(d));
+        QVERIFY(tex);
+        QCOMPARE(tex->levelCount(), 1);
+        QVERIFY(!tex->flags().testFlag(QRhiTexture::MipMapped));
+    }
+
+    void ktxTruncatedMipChain()
+    {
+        KtxDesc d;
+        d.mipLevels = 4;
+        d.levelBytes = { 32, 8 };           // 声明 4 级，只写了 2 级
+        QString error;
+        QVERIFY(!open("truncated_chain.ktx", ktx(d), &error));
+        QVERIFY(error.contains("mip chain"));
+    }
+
+    void ktxTruncatedLevel()
+    {
+        // 级别中声明的 imageSize 超出文件
+        KtxDesc d;
+        d.levelBytes = { 32 };
+        QByteArray bytes = ktx(d);
+        bytes.chop(8);
+        QVERIFY(!open("truncated_level.ktx", bytes));
+    }
+
+    void ktxLevelSmallerThanSize()
+    {
+        KtxDesc d;
+        d.levelBytes = { 16 };              // 8x8 BC1 需要 32 字节
+        QVERIFY(!open("short_level.ktx", ktx(d)));
+    }
+
+    void ktxOddSizedBlockCompressed()
+    {
+        KtxDesc d;
+        d.width = 6;
+        d.height = 6;
+        d.levelBytes = { 32 };
+        QString error;
+        QVERIFY(!open("odd.ktx", ktx(d), &error));
+        QVERIFY(error.contains("multiple"));
+    }
+
+    void ktxOddSizedUncompressed()
+    {
+        KtxDesc d;
+        d.internalFormat = 0x8058;          // RGBA8
+        d.width = 3;
+        d.height = 3;
+        d.levelBytes = { 36 };
+        auto tex = open("odd_rgba.ktx", ktx(d));
+        QVERIFY(tex);
+        QCOMPARE(tex->format(), QRhiTexture::RGBA8);
+        QCOMPARE(tex->size(), QSize(3, 3));
+    }
+
+    void ktxCubeMapRejected()
+    {
+        KtxDesc d;
+        d.faces = 6;
+        d.levelBytes = { 32, 32, 32, 32, 32, 32 };
+        QVERIFY(!open("cube.ktx", ktx(d)));
+    }
+
+    void ktx2Basic()
+    {
+        auto tex = open("basic.ktx2", ktx2({}));
+        QVERIFY(tex);
+        QCOMPARE(tex->format(), QRhiTexture::BC7);
+        QCOMPARE(tex->size(), QSize(4, 4));
+        QCOMPARE(tex->levelCount(), 1);
+    }
+
+    void ktx2Rejected_data()
+    {
+        QTest::addColumn<QByteArray>("bytes");
+        Ktx2Desc cube;
+        cube.faces = 6;
+        Ktx2Desc truncated;
+        truncated.dataShortBy = 1;
+        Ktx2Desc supercompressed;
+        supercompressed.supercompression = 1;
+        Ktx2Desc odd;
+        odd.width = 5;
+        odd.height = 5;
+        odd.levelBytes = { 64 };
+        QTest::newRow("cube") << ktx2(cube);
+        QTest::newRow("truncated data") << ktx2(truncated);
+        QTest::newRow("truncated index") << ktx2({}).left(90);
+        QTest::newRow("supercompressed") << ktx2(supercompressed);
+        QTest::newRow("odd size") << ktx2(odd);
+    }
+
+    void ktx2Rejected()
+    {
+        QFETCH(QByteArray, bytes);
+        QVERIFY(!open("rejected.ktx2", bytes));
+    }
+
+    void ddsLegacy()
+    {
+        DdsDesc d;
+        d.mipCount = 4;
+        d.dataBytes = 32 + 8 + 8 + 8;
+        auto tex = open("legacy.dds", dds(d));
+        QVERIFY(tex);
+        QCOMPARE(tex->format(), QRhiTexture::BC1);
+        QCOMPARE(tex->levelCount(), 4);
+        QCOMPARE(tex->level(1).offset, qint64(128 + 32));
+    }
+
+    void ddsDx10()
+    {
+        DdsDesc d;
+        d.dx10 = true;
+        d.dataBytes = 64;                   // 8x8 BC7: 4 块 x 16 字节
+        auto tex = open("dx10.dds", dds(d));
+        QVERIFY(tex);
+        QCOMPARE(tex->format(), QRhiTexture::BC7);
+        QCOMPARE(tex->level(0).offset, qint64(148));
+    }
+
+    void ddsRejected_data()
+    {
+        QTest::addColumn<QByteArray>("bytes");
+        DdsDesc cube;
+        cube.caps2 = 0x200 | 0xFC00;
+        DdsDesc dx10Cube;
+        dx10Cube.dx10 = true;
+        dx10Cube.miscFlag = 0x4;
+        dx10Cube.dataBytes = 64 * 6;
+        DdsDesc dx10Volume;
+        dx10Volume.dx10 = true;
+        dx10Volume.dimension = 4;
+        dx10Volume.dataBytes = 64;
+        DdsDesc odd;
+        odd.fourCC = 0x35545844;            // "DXT5"
+        odd.width = 10;
+        odd.height = 10;
+        odd.dataBytes = 9 * 16;
+        DdsDesc dx10Short;
+        dx10Short.dx10 = true;
+        DdsDesc truncated;
+        truncated.mipCount = 4;             // 需要 56 字节，只有 32
+        QTest::newRow("cube") << dds(cube);
+        QTest::newRow("dx10 cube") << dds(dx10Cube);
+        QTest::newRow("dx10 volume") << dds(dx10Volume);
+        QTest::newRow("dx10 truncated header") << dds(dx10Short).left(140);
+        QTest::newRow("odd size") << dds(odd);
+        QTest::newRow("truncated data") << dds(truncated);
+        QTest::newRow("truncated header") << dds({}).left(100);
+    }
+
+    void ddsRejected()
+    {
+        QFETCH(QByteArray, bytes);
+        QVERIFY(!open("rejected.dds", bytes));
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_CompressedTexture)
+#include "tst_compressedtexture.moc"
@@ -0,0 +1,268 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include "InputRecording.h"
+
+// ================================================================
+// InputRecorder / InputReplayer: .srec 写入后读回、内嵌文件、截断与耗时统计
+// ================================================================
+namespace {
+
+bool writeFile(const QString &path, const QByteArray &bytes)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(bytes) == bytes.size();
+}
+
+QByteArray readFile(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+// 浮点按单精度写入，测试值都取能被 float 精确表示的数
+RenderParams params(int frame)
+{
+    RenderParams p;
+    p.time = 0.5f * frame;
+    p.timeDelta = 0.5f;
+    p.frame = frame;
+    p.simulationSteps = 2;
+    p.screenSize = QSize(320, 200);
+    p.mousePos = QPointF(10.5, 20.25);
+    p.mousePressOrigin = QPointF(1.0, 2.0);
+    p.isPressed = frame % 2 == 1;
+    p.date = QVector4D(2026.0f, 10.0f, 17.0f, 3600.5f);
+    p.accumulate = frame > 2;
+    p.sampleBudget = 64;
+    p.convergenceThreshold = 0.125f;
+    p.accumulationEpoch = 3;
+    return p;
+}
+
+} // namespace
+
+class tst_InputRecording : public QObject {
+    Q_OBJECT
+
+private:
+    PassConfigSnapshot config(const QString &shader, const QString &texture) const
+    {
+        PassConfigSnapshot c;
+        c.loopNum = 2;
+        c.shaders = { shader, shader };
+        c.bindOrder = { -1, 0 };
+        c.channels.resize(2);
+        c.channels[1][0] = { ChannelSource::Pass, 0, ChannelFilter::Mipmap, ChannelWrap::Repeat };
+        c.channels[1][2] = { ChannelSource::Texture, 0, ChannelFilter::Nearest, ChannelWrap::Mirror };
+        c.targets.resize(2);
+        c.targets[0].scale = 0.5f;
+        c.targets[0].format = PassFormat::RGBA32F;
+        c.targets[1].fixedSize = QSize(64, 32);
+        c.uniformUsage = { UsesTime, UsesMouse | UsesFrame };
+        c.texUrls = { texture, QString(), QStringLiteral(":qt/qml/MyRhi/assets/others/other.png") };
+        return c;
+    }
+
+    QTemporaryDir m_dir;
+    QString m_shader;
+    QString m_texture;
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+        m_shader = m_dir.filePath("0123abcd.frag.qsb");
+        m_texture = m_dir.filePath("channel.png");
+        QVERIFY(writeFile(m_shader, "qsb payload"));
+        QVERIFY(writeFile(m_texture, "png payload"));
+    }
+
+    void roundTrip()
+    {
+        const QString path = m_dir.filePath("roundtrip.srec");
+        const PassConfigSnapshot first = config(m_shader, m_texture);
+        PassConfigSnapshot second = first;
+        second.loopNum = 1;
+        second.texUrls[0] = QUrl::fromLocalFile(m_texture).toString();   // QML 传入的 file:// URL
+
+        {
+            InputRecorder recorder;
+            QVERIFY(recorder.open(path));
+            recorder.recordConfig(first);
+            for (int f = 0; f < 3; ++f)
+                recorder.recordFrame({ QRectF(0, 0, 320, 200), params(f) }, { 16.5, 2.25 });
+            recorder.recordConfig(second);
+            for (int f = 3; f < 5; ++f)
+                recorder.recordFrame({ QRectF(0, 0, 320, 200), params(f) }, { 8.0, 1.0 });
+            QCOMPARE(recorder.framesRecorded(), 5);
+        }
+
+        InputReplayer replayer;
+        QString error;
+        QVERIFY2(replayer.open(path, &error), qPrintable(error));
+        QCOMPARE(replayer.frameCount(), 5);
+
+        for (int f = 0; f < 5; ++f) {
+            const PassConfigSnapshot *changed = nullptr;
+            const RecordedFrame &frame = replayer.next(&changed);
+            // 配置只在变化的那一帧给出
+            QCOMPARE(changed != nullptr, f == 0 || f == 3);
+            QCOMPARE(frame.config, f < 3 ? 0 : 1);
+            QCOMPARE(frame.frame.viewport, QRectF(0, 0, 320, 200));
+            QCOMPARE(frame.recorded.frameMs, f < 3 ? 16.5 : 8.0);
+
+            const RenderParams expected = params(f);
+            const RenderParams &p = frame.frame.params;
+            QCOMPARE(p.time, expected.time);
+            QCOMPARE(p.timeDelta, expected.timeDelta);
+            QCOMPARE(p.frame, expected.frame);
+            QCOMPARE(p.simulationSteps, expected.simulationSteps);
+            QCOMPARE(p.screenSize, expected.screenSize);
+            QCOMPARE(p.mousePos, expected.mousePos);
+            QCOMPARE(p.mousePressOrigin, expected.mousePressOrigin);
+            QCOMPARE(p.isPressed, expected.isPressed);
+            QCOMPARE(p.date, expected.date);
+            QCOMPARE(p.accumulate, expected.accumulate);
+            QCOMPARE(p.sampleBudget, expected.sampleBudget);
+            QCOMPARE(p.convergenceThreshold, expected.convergenceThreshold);
+            QCOMPARE(p.accumulationEpoch, expected.accumulationEpoch);
+        }
+        QVERIFY(replayer.atEnd());
+
+        // 配置逐项一致；.qsb 与贴图指向解出的文件，内容不变；空路径与内置资源原样保留
+        const PassConfigSnapshot &c = replayer.config(0);
+        QCOMPARE(c.loopNum, first.loopNum);
+        QVERIFY(c.bindOrder == first.bindOrder);
+        QVERIFY(c.channels == first.channels);
+        QVERIFY(c.targets == first.targets);
+        QVERIFY(c.uniformUsage == first.uniformUsage);
+        QCOMPARE(c.shaders.size(), 2);
+        QVERIFY(c.shaders[0] != m_shader);
+        QCOMPARE(c.shaders[1], c.shaders[0]);
+        QCOMPARE(readFile(c.shaders[0]), QByteArray("qsb payload"));
+        QCOMPARE(c.texUrls.size(), 3);
+        QVERIFY(c.texUrls[0] != m_texture);
+        QCOMPARE(readFile(c.texUrls[0]), QByteArray("png payload"));
+        QVERIFY(c.texUrls[1].isEmpty());
+        QCOMPARE(c.texUrls[2], first.texUrls[2]);
+        QVERIFY(c.texUrls[0].endsWith(".png"));
+
+        const PassConfigSnapshot &c2 = replayer.config(1);
+        QCOMPARE(c2.loopNum, 1);
+        QCOMPARE(readFile(c2.texUrls[0]), QByteArray("png payload"));
+    }
+
+    void truncatedFrameKeepsEarlierFrames()
+    {
+        const QString path = m_dir.filePath("truncated.srec");
+        {
+            InputRecorder recorder;
+            QVERIFY(recorder.open(path));
+            recorder.recordConfig(config(m_shader, m_texture));
+            for (int f = 0; f < 4; ++f) recorder.recordFrame({ QRectF(0, 0, 320, 200), params(f) }, {});
+        }
+        QByteArray bytes = readFile(path);
+        bytes.chop(5);
+        QVERIFY(writeFile(path, bytes));
+
+        InputReplayer replayer;
+        QVERIFY(replayer.open(path));
+        QCOMPARE(replayer.frameCount(), 3);
+    }
+
+    void truncatedShaderRecordIsNotExtracted()
+    {
+        // 录制在写 Shader 记录时中断: 没有可回放的帧，也不会写出不完整的 .qsb
+        const QString shader = m_dir.filePath("large.frag.qsb");
+        QVERIFY(writeFile(shader, QByteArray(4096, 'q')));
+        const QString path = m_dir.filePath("truncated_shader.srec");
+        {
+            InputRecorder recorder;
+            QVERIFY(recorder.open(path));
+            recorder.recordConfig(config(shader, QString()));
+            recorder.recordFrame({ QRectF(0, 0, 320, 200), params(0) }, {});
+        }
+        QVERIFY(writeFile(path, readFile(path).left(1024)));
+
+        InputReplayer replayer;
+        QString error;
+        QVERIFY(!replayer.open(path, &error));
+        QVERIFY(error.contains("no frames"));
+    }
+
+    void missingTextureFailsReplay()
+    {
+        const QString path = m_dir.filePath("missing_texture.srec");
+        {
+            InputRecorder recorder;
+            QVERIFY(recorder.open(path));
+            recorder.recordConfig(config(m_shader, m_dir.filePath("does_not_exist.png")));
+            recorder.recordFrame({ QRectF(0, 0, 320, 200), params(0) }, {});
+        }
+        InputReplayer replayer;
+        QString error;
+        QVERIFY(!replayer.open(path, &error));
+        QVERIFY(error.contains("does_not_exist.png"));
+    }
+
+    void notARecording()
+    {
+        const QString path = m_dir.filePath("garbage.srec");
+        QVERIFY(writeFile(path, "definitely not a recording"));
+        InputReplayer replayer;
+        QVERIFY(!replayer.open(path));
+    }
+
+    void timingsCsv()
+    {
+        const QString path = m_dir.filePath("timings.srec");
+        {
+            InputRecorder recorder;
+            QVERIFY(recorder.open(path));
+            recorder.recordConfig(config(m_shader, m_texture));
+            for (int f = 0; f < 2; ++f) recorder.recordFrame({ QRectF(0, 0, 32, 32), params(f) }, { 16.0, 2.0 });
+        }
+        InputReplayer replayer;
+        QVERIFY(replayer.open(path));
+        replayer.setReplayMetric(QStringLiteral("render_readback"));
+        replayer.recordTiming(0, { 4.0, 1.0 });
+        replayer.recordTiming(1, { 6.0, 1.5 });
+
+        const QString csv = m_dir.filePath("timings.csv");
+        QVERIFY(replayer.dumpTimingsCsv(csv));
+        const QList<QByteArray> lines = readFile(csv).trimmed().split('\n');
+        QCOMPARE(lines.size(), 3);
+        QCOMPARE(lines[0], QByteArray("frame,recorded_sync_interval_ms,replay_render_readback_ms,recorded_gpu_ms,replay_gpu_ms"));
+        QCOMPARE(lines[2], QByteArray("1,16,6,2,1.5"));
+        QVERIFY(replayer.summary().contains("replay_render_readback_avg_ms=5.000"));
+    }
+
+    void percentile_data()
+    {
+        QTest::addColumn<QList<double>>("values");
+        QTest::addColumn<double>("p");
+        QTest::addColumn<double>("expected");
+
+        QTest::newRow("empty") << QList<double>() << 0.95 << 0.0;
+        QTest::newRow("single") << QList<double> { 7.0 } << 0.95 << 7.0;
+        QTest::newRow("min") << QList<double> { 3.0, 1.0, 2.0 } << 0.0 << 1.0;
+        QTest::newRow("max") << QList<double> { 3.0, 1.0, 2.0 } << 1.0 << 3.0;
+        QTest::newRow("median") << QList<double> { 5.0, 1.0, 4.0, 2.0, 3.0 } << 0.5 << 3.0;
+        // 最近秩: 0.95 x 19 = 18.05，取第 18 个 (从 0 起)
+        QList<double> ramp;
+        for (int i = 1; i <= 20; ++i) ramp.append(double(i));
+        QTest::newRow("p95 of 1..20") << ramp << 0.95 << 19.0;
+        QTest::newRow("out of range") << QList<double> { 1.0, 2.0 } << 2.0 << 2.0;
+    }
+
+    void percentile()
+    {
+        QFETCH(QList<double>, values);
+        QFETCH(double, p);
+        QFETCH(double, expected);
+        QCOMPARE(InputReplayer::percentile(std::vector<double>(values.begin(), values.end()), p), expected);
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_InputRecording)
+#include "tst_inputrecording.moc"
@@ -0,0 +1,84 @@
+#include <QtTest>
+#include <rhi/qrhi.h>
+#include <memory>
+#include "SamplerCache.h"
+
+// ================================================================
+// SamplerCache: (filter, wrap) 到 QRhiSampler 参数的映射与共享
+// 使用 QRhi Null 后端，不需要 GPU
+// ================================================================
+class tst_SamplerCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        QRhiNullInitParams params;
+        m_rhi.reset(QRhi::create(QRhi::Null, &params));
+        QVERIFY(m_rhi);
+    }
+
+    void cleanupTestCase()
+    {
+        m_cache.releaseAll();
+        m_rhi.reset();
+    }
+
+    void mapping_data()
+    {
+        QTest::addColumn<int>("filter");
+        QTest::addColumn<int>("wrap");
+        QTest::addColumn<int>("texFilter");
+        QTest::addColumn<int>("mipFilter");
+        QTest::addColumn<int>("address");
+
+        QTest::newRow("nearest clamp") << int(ChannelFilter::Nearest) << int(ChannelWrap::Clamp)
+                                       << int(QRhiSampler::Nearest) << int(QRhiSampler::None) << int(QRhiSampler::ClampToEdge);
+        QTest::newRow("linear repeat") << int(ChannelFilter::Linear) << int(ChannelWrap::Repeat)
+                                       << int(QRhiSampler::Linear) << int(QRhiSampler::None) << int(QRhiSampler::Repeat);
+        QTest::newRow("mipmap mirror") << int(ChannelFilter::Mipmap) << int(ChannelWrap::Mirror)
+                                       << int(QRhiSampler::Linear) << int(QRhiSampler::Linear) << int(QRhiSampler::Mirror);
+        QTest::newRow("mipmap clamp") << int(ChannelFilter::Mipmap) << int(ChannelWrap::Clamp)
+                                      << int(QRhiSampler::Linear) << int(QRhiSampler::Linear) << int(QRhiSampler::ClampToEdge);
+    }
+
+    void mapping()
+    {
+        QFETCH(int, filter);
+        QFETCH(int, wrap);
+        QFETCH(int, texFilter);
+        QFETCH(int, mipFilter);
+        QFETCH(int, address);
+
+        QRhiSampler *sampler = m_cache.get(m_rhi.get(), ChannelFilter(filter), ChannelWrap(wrap));
+        QVERIFY(sampler);
+        QCOMPARE(int(sampler->magFilter()), texFilter);
+        QCOMPARE(int(sampler->minFilter()), texFilter);
+        QCOMPARE(int(sampler->mipmapMode()), mipFilter);
+        QCOMPARE(int(sampler->addressU()), address);
+        QCOMPARE(int(sampler->addressV()), address);
+    }
+
+    void shared()
+    {
+        SamplerCache cache;
+        QRhiSampler *a = cache.get(m_rhi.get(), ChannelFilter::Linear, ChannelWrap::Clamp);
+        QCOMPARE(cache.get(m_rhi.get(), ChannelFilter::Linear, ChannelWrap::Clamp), a);
+        QCOMPARE(cache.count(), 1);
+
+        // 全部 9 种组合各一个
+        for (int f = 0; f < 3; ++f) {
+            for (int w = 0; w < 3; ++w) cache.get(m_rhi.get(), ChannelFilter(f), ChannelWrap(w));
+        }
+        QCOMPARE(cache.count(), 9);
+        cache.releaseAll();
+        QCOMPARE(cache.count(), 0);
+    }
+
+private:
+    std::unique_ptr<QRhi> m_rhi;
+    SamplerCache m_cache;
+};
+
+QTEST_MAIN(tst_SamplerCache)
+#include "tst_samplercache.moc"
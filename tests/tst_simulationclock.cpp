@@ -0,0 +1,113 @@
+#include <QtTest>
+#include "SimulationClock.h"
+
+// ================================================================
+// SimulationClock: 固定步长的步数计算、追赶上限与丢步统计
+// ================================================================
+class tst_SimulationClock : public QObject {
+    Q_OBJECT
+
+private slots:
+    void exactFrames()
+    {
+        // 帧间隔恰好一步: 浮点累加误差不能让步数在 0/1/2 之间抖动
+        SimulationClock clock;
+        int total = 0;
+        for (int i = 0; i < 600; ++i) {
+            const int steps = clock.advance(1.0 / 60.0);
+            QCOMPARE(steps, 1);
+            total += steps;
+        }
+        QCOMPARE(total, 600);
+        QCOMPARE(clock.nextStep(), qint64(600));
+        QCOMPARE(clock.time(), 10.0);
+        QCOMPARE(clock.droppedSteps(), qint64(0));
+    }
+
+    void fasterDisplay()
+    {
+        // 120 Hz 显示、60 Hz 模拟: 每两帧一步，总步数与真实时间一致
+        SimulationClock clock;
+        int total = 0;
+        for (int i = 0; i < 120; ++i) {
+            const int steps = clock.advance(1.0 / 120.0);
+            QVERIFY(steps == 0 || steps == 1);
+            total += steps;
+        }
+        QCOMPARE(total, 60);
+    }
+
+    void catchUpIsClamped()
+    {
+        SimulationClock clock;
+        clock.setMaxStepsPerFrame(4);
+        QCOMPARE(clock.advance(3.0 / 60.0), 3);
+        QCOMPARE(clock.droppedSteps(), qint64(0));
+
+        // 落后 600 步: 只走 4 步，其余计入丢步，积压清空
+        QCOMPARE(clock.advance(10.0), 4);
+        QCOMPARE(clock.droppedSteps(), qint64(596));
+        QCOMPARE(clock.nextStep(), qint64(7));
+        QCOMPARE(clock.advance(0.0), 0);
+        QCOMPARE(clock.advance(1.0 / 60.0), 1);
+    }
+
+    void minSteps()
+    {
+        SimulationClock clock;
+        QCOMPARE(clock.advance(0.0, 1), 1);
+        // 强制的步数同样受上限约束
+        clock.setMaxStepsPerFrame(2);
+        QCOMPARE(clock.advance(0.0, 8), 2);
+        QCOMPARE(clock.advance(0.0, -3), 0);
+        QCOMPARE(clock.droppedSteps(), qint64(0));
+    }
+
+    void negativeTimeIgnored()
+    {
+        SimulationClock clock;
+        QCOMPARE(clock.advance(-1.0), 0);
+        QCOMPARE(clock.advance(1.0 / 60.0), 1);
+    }
+
+    void resyncDropsAccumulatedTime()
+    {
+        SimulationClock clock;
+        QCOMPARE(clock.advance(0.75 / 60.0), 0);
+        clock.resync();
+        // 暂停前积累的 3/4 步被丢弃，步序号不变，也不算丢步
+        QCOMPARE(clock.advance(0.5 / 60.0), 0);
+        QCOMPARE(clock.advance(0.5 / 60.0), 1);
+        QCOMPARE(clock.nextStep(), qint64(1));
+        QCOMPARE(clock.droppedSteps(), qint64(0));
+    }
+
+    void limits()
+    {
+        SimulationClock clock;
+        clock.setMaxStepsPerFrame(0);
+        QCOMPARE(clock.maxStepsPerFrame(), 1);
+        clock.setMaxStepsPerFrame(100000);
+        QCOMPARE(clock.maxStepsPerFrame(), 1024);
+        clock.setStepRate(0.0);
+        QCOMPARE(clock.stepRate(), 1.0);
+    }
+
+    void stepRateKeepsTime()
+    {
+        SimulationClock clock;
+        clock.reset(2.0);
+        QCOMPARE(clock.nextStep(), qint64(120));
+        clock.setStepRate(240.0);
+        QCOMPARE(clock.time(), 2.0);
+        QCOMPARE(clock.nextStep(), qint64(480));
+        QCOMPARE(clock.stepDelta(), 1.0 / 240.0);
+
+        // reset 对齐到步边界，负数按 0 处理
+        clock.reset(-5.0);
+        QCOMPARE(clock.nextStep(), qint64(0));
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_SimulationClock)
+#include "tst_simulationclock.moc"
@@ -0,0 +1,99 @@
+#include <QtTest>
+#include <atomic>
+#include <thread>
+#include "RenderState.h"
+
+// ================================================================
+// TripleBuffer: 单生产者 / 单消费者的快照交接
+// ================================================================
+class tst_TripleBuffer : public QObject {
+    Q_OBJECT
+
+private slots:
+    void nothingPublished()
+    {
+        TripleBuffer<int> buffer;
+        QVERIFY(!buffer.fetch());
+    }
+
+    void fetchTakesLatest()
+    {
+        TripleBuffer<int> buffer;
+        for (int i = 1; i <= 3; ++i) {
+            buffer.back() = i;
+            buffer.publish();
+        }
+        // 连续发布多次，消费者只拿到最新的一份，之后没有新快照
+        QVERIFY(buffer.fetch());
+        QCOMPARE(buffer.front(), 3);
+        QVERIFY(!buffer.fetch());
+        QCOMPARE(buffer.front(), 3);
+
+        buffer.back() = 4;
+        buffer.publish();
+        QVERIFY(buffer.fetch());
+        QCOMPARE(buffer.front(), 4);
+    }
+
+    void frontStableWhileProducing()
+    {
+        TripleBuffer<int> buffer;
+        buffer.back() = 1;
+        buffer.publish();
+        QVERIFY(buffer.fetch());
+
+        // 生产者写入与发布都不会改动消费者手中的 front()
+        for (int i = 2; i < 10; ++i) {
+            buffer.back() = i;
+            QCOMPARE(buffer.front(), 1);
+            buffer.publish();
+            QCOMPARE(buffer.front(), 1);
+        }
+        QVERIFY(buffer.fetch());
+        QCOMPARE(buffer.front(), 9);
+    }
+
+    void concurrentSnapshotsAreComplete()
+    {
+        // 每份快照的各字段由同一个序号算出，读到混合的内容说明交接不完整
+        struct Snapshot {
+            int sequence = 0;
+            std::array<int, 16> payload {};
+        };
+        TripleBuffer<Snapshot> buffer;
+        constexpr int kCount = 200000;
+        std::atomic<bool> done { false };
+
+        std::thread producer([&]() {
+            for (int i = 1; i <= kCount; ++i) {
+                Snapshot &s = buffer.back();
+                s.sequence = i;
+                for (int k = 0; k < (int)s.payload.size(); ++k) s.payload[k] = i * 31 + k;
+                buffer.publish();
+            }
+            done = true;
+        });
+
+        int last = 0;
+        bool torn = false, backwards = false;
+        for (;;) {
+            const bool finished = done.load();
+            if (!buffer.fetch()) {
+                if (finished) break;    // 生产者结束之后也没有新快照: front() 就是最后一份
+                continue;
+            }
+            const Snapshot &s = buffer.front();
+            for (int k = 0; k < (int)s.payload.size(); ++k) torn |= s.payload[k] != s.sequence * 31 + k;
+            backwards |= s.sequence <= last;
+            last = s.sequence;
+        }
+        producer.join();
+
+        QVERIFY(!torn);
+        QVERIFY(!backwards);
+        QCOMPARE(buffer.front().sequence, kCount);
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_TripleBuffer)
+#include "tst_triplebuffer.moc"
@@ -0,0 +1,134 @@
+#include <QtTest>
+#include <vector>
+#include "FrameExporter.h"
+
+// ================================================================
+// FrameExporter::toY4mFrame: RGBA8 → YUV 4:2:0 (BT.709 有限范围)
+// ================================================================
+namespace {
+
+struct Rgb { uchar r, g, b; };
+
+// w x h 的 RGBA8，每行末尾追加 padding 字节的垃圾数据 (读回的行距常大于紧密排列)
+QByteArray image(int w, int h, int padding, const std::vector<Rgb> &pixels)
+{
+    const int stride = w * 4 + padding;
+    QByteArray bytes(stride * h, char(0xAA));
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            const Rgb &p = pixels[size_t(y * w + x)];
+            uchar *dst = reinterpret_cast<uchar *>(bytes.data()) + y * stride + x * 4;
+            dst[0] = p.r;
+            dst[1] = p.g;
+            dst[2] = p.b;
+            dst[3] = 255;
+        }
+    }
+    return bytes;
+}
+
+struct Planes {
+    QByteArray y, u, v;
+};
+
+Planes split(const QByteArray &frame, int w, int h)
+{
+    const int tag = 6;      // "FRAME\n"
+    const int cw = (w + 1) / 2, ch = (h + 1) / 2;
+    return { frame.mid(tag, w * h), frame.mid(tag + w * h, cw * ch), frame.mid(tag + w * h + cw * ch, cw * ch) };
+}
+
+uchar at(const QByteArray &plane, int i) { return uchar(plane.at(i)); }
+
+const Rgb kWhite { 255, 255, 255 };
+const Rgb kBlack { 0, 0, 0 };
+const Rgb kRed { 255, 0, 0 };
+const Rgb kBlue { 0, 0, 255 };
+
+} // namespace
+
+class tst_Y4mConversion : public QObject {
+    Q_OBJECT
+
+private slots:
+    void colors_data()
+    {
+        QTest::addColumn<int>("r");
+        QTest::addColumn<int>("g");
+        QTest::addColumn<int>("b");
+        QTest::addColumn<int>("y");
+        QTest::addColumn<int>("u");
+        QTest::addColumn<int>("v");
+
+        // Y = 16 + 219 (0.2126 R + 0.7152 G + 0.0722 B)，U/V = 128 + 224 (...)
+        QTest::newRow("black") << 0 << 0 << 0 << 16 << 128 << 128;
+        QTest::newRow("white") << 255 << 255 << 255 << 235 << 128 << 128;
+        QTest::newRow("red") << 255 << 0 << 0 << 63 << 102 << 240;
+        QTest::newRow("green") << 0 << 255 << 0 << 173 << 42 << 26;
+        QTest::newRow("blue") << 0 << 0 << 255 << 32 << 240 << 118;
+    }
+
+    void colors()
+    {
+        QFETCH(int, r);
+        QFETCH(int, g);
+        QFETCH(int, b);
+        QFETCH(int, y);
+        QFETCH(int, u);
+        QFETCH(int, v);
+
+        const Rgb c { uchar(r), uchar(g), uchar(b) };
+        const QByteArray frame = FrameExporter::toY4mFrame(image(2, 2, 0, { c, c, c, c }), QSize(2, 2), 8, false);
+        QVERIFY(frame.startsWith("FRAME\n"));
+        QCOMPARE(frame.size(), 6 + 4 + 1 + 1);
+        const Planes p = split(frame, 2, 2);
+        for (int i = 0; i < 4; ++i) QCOMPARE(int(at(p.y, i)), y);
+        QCOMPARE(int(at(p.u, 0)), u);
+        QCOMPARE(int(at(p.v, 0)), v);
+    }
+
+    void oddSizeAndStride()
+    {
+        // 3x3 带行尾填充: 色度平面为 2x2，最后一列/行复制边缘像素，填充字节不参与计算
+        std::vector<Rgb> pixels(9, kRed);
+        const QByteArray frame = FrameExporter::toY4mFrame(image(3, 3, 4, pixels), QSize(3, 3), 16, false);
+        QCOMPARE(frame.size(), 6 + 9 + 4 + 4);
+        const Planes p = split(frame, 3, 3);
+        for (int i = 0; i < 9; ++i) QCOMPARE(int(at(p.y, i)), 63);
+        for (int i = 0; i < 4; ++i) {
+            QCOMPARE(int(at(p.u, i)), 102);
+            QCOMPARE(int(at(p.v, i)), 240);
+        }
+    }
+
+    void chromaAveraging()
+    {
+        // 3x1: 第一个色度样本是两个白色像素的平均，第二个只覆盖最右侧的红色像素
+        const QByteArray frame = FrameExporter::toY4mFrame(image(3, 1, 0, { kWhite, kWhite, kRed }), QSize(3, 1), 12, false);
+        const Planes p = split(frame, 3, 1);
+        QCOMPARE(int(at(p.u, 0)), 128);
+        QCOMPARE(int(at(p.v, 0)), 128);
+        QCOMPARE(int(at(p.u, 1)), 102);
+        QCOMPARE(int(at(p.v, 1)), 240);
+
+        // 2x2 中黑白各半: 色度仍为中性，不受亮度影响
+        const QByteArray gray = FrameExporter::toY4mFrame(image(2, 2, 0, { kWhite, kBlack, kBlack, kWhite }), QSize(2, 2), 8, false);
+        QCOMPARE(int(at(split(gray, 2, 2).u, 0)), 128);
+        QCOMPARE(int(at(split(gray, 2, 2).v, 0)), 128);
+    }
+
+    void flipY()
+    {
+        // 读回为左下角原点时翻转: 输出的第一行是输入的最后一行
+        const QByteArray rgba = image(1, 2, 0, { kRed, kBlue });
+        const Planes upright = split(FrameExporter::toY4mFrame(rgba, QSize(1, 2), 4, false), 1, 2);
+        const Planes flipped = split(FrameExporter::toY4mFrame(rgba, QSize(1, 2), 4, true), 1, 2);
+        QCOMPARE(int(at(upright.y, 0)), 63);
+        QCOMPARE(int(at(upright.y, 1)), 32);
+        QCOMPARE(int(at(flipped.y, 0)), 32);
+        QCOMPARE(int(at(flipped.y, 1)), 63);
+    }
+};
+
+QTEST_GUILESS_MAIN(tst_Y4mConversion)
+#include "tst_y4mconversion.moc"